@@ -1,5 +1,8 @@
 #include "INMP441.h"
 #include "esp_log.h"
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "esp_timer.h"
 
 static const char *TAG = "INMP441";
 
@@ -8,26 +11,98 @@ i2s_chan_handle_t rx_handle;
 //? 当前噪声门限值
 static int32_t g_noise_gate_threshold = INMP441_NOISE_GATE_THRESHOLD;
 
-void i2s_rx_init(void)
+//? 当前采集采样率（标称值与按时钟分频估算的实际值）
+static uint32_t g_sample_rate = INMP441_SAMPLE_RATE;
+static double g_actual_rate = INMP441_SAMPLE_RATE;
+
+//? 当前DMA配置
+static uint32_t g_dma_desc_num = INMP441_DMA_DESC_NUM;
+static uint32_t g_dma_frame_num = INMP441_DMA_FRAME_NUM;
+
+//? 各延迟档位的DMA参数 {desc_num, frame_num}
+static const uint32_t s_latency_profiles[INMP441_LATENCY_PROFILE_COUNT][2] = {
+    [INMP441_LATENCY_LOW]        = {4, 64},
+    [INMP441_LATENCY_BALANCED]   = {INMP441_DMA_DESC_NUM, INMP441_DMA_FRAME_NUM},
+    [INMP441_LATENCY_POWER_SAVE] = {8, INMP441_DMA_FRAME_NUM_MAX},
+};
+
+//? 淡入进度：切换采样率后前 g_fade_in_total 个样本按 pos/total 线性放大
+static size_t g_fade_in_total = 0;
+static size_t g_fade_in_pos = 0;
+
+//? 高通滤波器（截止频率为0时不处理）
+static float g_hpf_cutoff = INMP441_HPF_CUTOFF_HZ;
+static audio_dsp_biquad_cascade_t g_hpf;
+
+//? 采集引擎状态
+static QueueHandle_t g_capture_queue = NULL;
+static volatile uint32_t g_capture_seq = 0;
+static volatile uint32_t g_capture_overruns = 0;
+static volatile uint32_t g_capture_peak = 0;
+static uint32_t g_capture_stale = 0;
+
+//? DMA块接收完成（ISR上下文）：零拷贝交付块指针
+//? 注：未调用 i2s_channel_read() 时驱动内部消息队列始终是满的，on_recv_q_ovf 每块都会触发，
+//? 不能用来判断溢出；这里以自有队列溢出和序号判断丢块
+static bool IRAM_ATTR rx_on_recv(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx)
 {
-    i2s_chan_config_t chan_cfg = I2S_CHANNEL_DEFAULT_CONFIG(I2S_NUM_0, I2S_ROLE_MASTER);
+    //? 先取周期计数，尽量贴近中断发生时刻
+    uint32_t cycles = esp_cpu_get_cycle_count();
+    inmp441_block_t blk = {
+        .data = (const int32_t *)event->dma_buf,
+        .len = event->size,
+        .seq = g_capture_seq,
+        .timestamp_us = esp_timer_get_time(),
+        .cycles = cycles,
+    };
+    g_capture_seq = blk.seq + 1;
     
-    //? 优化：减小dma frame num，降低延迟，提高实时性
-    //? 从511改为256，在保持音质的同时减少缓冲延迟
-    chan_cfg.dma_frame_num = INMP441_DMA_FRAME_NUM;
-    chan_cfg.auto_clear = true;     //? 自动清除DMA缓冲区
-    i2s_new_channel(&chan_cfg, NULL, &rx_handle);
- 
+    BaseType_t woken = pdFALSE;
+    if (xQueueSendFromISR(g_capture_queue, &blk, &woken) != pdTRUE) {
+        //? 队列满：丢弃最旧的块（其缓冲区即将被DMA覆写），保留最新数据
+        inmp441_block_t dropped;
+        xQueueReceiveFromISR(g_capture_queue, &dropped, &woken);
+        xQueueSendFromISR(g_capture_queue, &blk, &woken);
+        g_capture_overruns++;
+    }
+    UBaseType_t waiting = uxQueueMessagesWaitingFromISR(g_capture_queue);
+    if (waiting > g_capture_peak) {
+        g_capture_peak = waiting;
+    }
+    return woken == pdTRUE;
+}
+
+//? 全双工模式：通道由外部创建（与功放共用控制器和BCLK/WS），本驱动只负责配置和使用
+static bool g_attached = false;
+static gpio_num_t g_pin_bclk = INMP_SCK;
+static gpio_num_t g_pin_ws = INMP_WS;
+
+//? 生成指定采样率的时钟配置，同时更新实际采样率
+static void make_clk_cfg(uint32_t sample_rate, i2s_std_clk_config_t *clk_cfg)
+{
+    i2s_std_clk_config_t def = I2S_STD_CLK_DEFAULT_CONFIG(sample_rate);
+    *clk_cfg = def;
+    g_actual_rate = sample_rate;
+#if INMP441_CLK_AUTO
+    i2s_clock_info_t info;
+    if (i2s_clock_select(sample_rate, 32, clk_cfg, &info) == ESP_OK) {
+        g_actual_rate = info.actual_rate;
+        i2s_clock_log(TAG, &info);
+    }
+#endif
+}
+
+//? 在 rx_handle 上初始化标准模式、注册回调并启用
+static esp_err_t rx_channel_setup(void)
+{
     i2s_std_config_t std_cfg = {
-        .clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(INMP441_SAMPLE_RATE),
-        
         //? 虽然inmp441采集数据为24bit，但是仍可使用32bit来接收，中间存储过程不需考虑，只要让声音怎么进来就怎么出去即可
         .slot_cfg = I2S_STD_MSB_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_32BIT, INMP441_CHANNEL_MODE),
         .gpio_cfg = {
             .mclk = I2S_GPIO_UNUSED,
             .dout = I2S_GPIO_UNUSED,
-            .bclk = INMP_SCK,
-            .ws = INMP_WS,
+            .bclk = g_pin_bclk,
+            .ws = g_pin_ws,
             .din = INMP_SD,
             .invert_flags = {
                 .mclk_inv = false,
@@ -37,9 +112,246 @@ void i2s_rx_init(void)
         },
     };
  
-    i2s_channel_init_std_mode(rx_handle, &std_cfg);
+    make_clk_cfg(g_sample_rate, &std_cfg.clk_cfg);
+    esp_err_t ret = i2s_channel_init_std_mode(rx_handle, &std_cfg);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    //? 采集引擎运行中重建通道时重新注册回调（只能在通道未启用时注册）
+    if (g_capture_queue != NULL) {
+        i2s_event_callbacks_t cbs = { .on_recv = rx_on_recv };
+        i2s_channel_register_event_callback(rx_handle, &cbs, NULL);
+    }
  
-    i2s_channel_enable(rx_handle);
+    return i2s_channel_enable(rx_handle);
+}
+
+//? 按当前DMA配置和采样率创建并启用RX通道
+static esp_err_t rx_channel_create(void)
+{
+    i2s_chan_config_t chan_cfg = I2S_CHANNEL_DEFAULT_CONFIG(I2S_NUM_0, I2S_ROLE_MASTER);
+    
+    //? 优化：减小dma frame num，降低延迟，提高实时性
+    //? 从511改为256，在保持音质的同时减少缓冲延迟；可用 inmp441_set_latency_profile() 运行时调整
+    chan_cfg.dma_frame_num = g_dma_frame_num;
+    chan_cfg.dma_desc_num = g_dma_desc_num;
+    chan_cfg.auto_clear = true;     //? 自动清除DMA缓冲区
+    esp_err_t ret = i2s_new_channel(&chan_cfg, NULL, &rx_handle);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    return rx_channel_setup();
+}
+
+//? 接管外部创建的RX通道（全双工模式）
+esp_err_t inmp441_attach(i2s_chan_handle_t handle, uint32_t desc_num, uint32_t frame_num, gpio_num_t bclk, gpio_num_t ws)
+{
+    if (handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    rx_handle = handle;
+    g_attached = true;
+    g_dma_desc_num = desc_num;
+    g_dma_frame_num = frame_num;
+    g_pin_bclk = bclk;
+    g_pin_ws = ws;
+    inmp441_set_highpass(g_hpf_cutoff);
+    return rx_channel_setup();
+}
+
+void i2s_rx_init(void)
+{
+    inmp441_set_highpass(g_hpf_cutoff);
+    rx_channel_create();
+}
+
+//? 选择延迟档位
+esp_err_t inmp441_set_latency_profile(inmp441_latency_profile_t profile)
+{
+    if (profile >= INMP441_LATENCY_PROFILE_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return inmp441_set_dma_config(s_latency_profiles[profile][0], s_latency_profiles[profile][1]);
+}
+
+//? 修改DMA配置：删除并重建通道
+esp_err_t inmp441_set_dma_config(uint32_t desc_num, uint32_t frame_num)
+{
+    if (desc_num < 2 || desc_num > INMP441_DMA_DESC_NUM_MAX ||
+        frame_num < 8 || frame_num > INMP441_DMA_FRAME_NUM_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (desc_num == g_dma_desc_num && frame_num == g_dma_frame_num) {
+        return ESP_OK;
+    }
+    //? 全双工通道与功放同时创建，不能单独重建
+    if (g_attached) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    
+    if (rx_handle != NULL) {
+        i2s_channel_disable(rx_handle);
+        i2s_del_channel(rx_handle);
+        rx_handle = NULL;
+    }
+    //? 队列中的块指向即将释放的DMA缓冲区，一并清空
+    if (g_capture_queue != NULL) {
+        xQueueReset(g_capture_queue);
+    }
+    g_dma_desc_num = desc_num;
+    g_dma_frame_num = frame_num;
+    
+    esp_err_t ret = rx_channel_create();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Recreate RX channel (%lu x %lu) failed: %s",
+                 (unsigned long)desc_num, (unsigned long)frame_num, esp_err_to_name(ret));
+        return ret;
+    }
+    ESP_LOGI(TAG, "DMA config: %lu desc x %lu frames (%.1f ms per block)",
+             (unsigned long)desc_num, (unsigned long)frame_num, 1000.0f * frame_num / g_sample_rate);
+    return ESP_OK;
+}
+
+//? 获取当前每个DMA块的帧数
+uint32_t inmp441_get_dma_frame_num(void)
+{
+    return g_dma_frame_num;
+}
+
+//? 运行时切换采样率
+esp_err_t inmp441_set_sample_rate(uint32_t sample_rate)
+{
+    if (sample_rate < INMP441_MIN_SAMPLE_RATE || sample_rate > INMP441_MAX_SAMPLE_RATE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (sample_rate == g_sample_rate) {
+        return ESP_OK;
+    }
+    
+    //? 时钟只能在通道禁用时重配，DMA描述符和GPIO保持不变
+    i2s_channel_disable(rx_handle);
+    i2s_std_clk_config_t clk_cfg;
+    make_clk_cfg(sample_rate, &clk_cfg);
+    esp_err_t ret = i2s_channel_reconfig_std_clock(rx_handle, &clk_cfg);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Reconfig clock to %lu Hz failed: %s", (unsigned long)sample_rate, esp_err_to_name(ret));
+        make_clk_cfg(g_sample_rate, &clk_cfg);
+        i2s_channel_reconfig_std_clock(rx_handle, &clk_cfg);
+        i2s_channel_enable(rx_handle);
+        return ret;
+    }
+    ret = i2s_channel_enable(rx_handle);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    ESP_LOGI(TAG, "Sample rate: %lu -> %lu Hz", (unsigned long)g_sample_rate, (unsigned long)sample_rate);
+    g_sample_rate = sample_rate;
+    g_fade_in_total = (size_t)sample_rate * INMP441_FADE_MS / 1000;
+    g_fade_in_pos = 0;
+    inmp441_set_highpass(g_hpf_cutoff);
+    return ESP_OK;
+}
+
+//? 获取当前采集采样率
+uint32_t inmp441_get_sample_rate(void)
+{
+    return g_sample_rate;
+}
+
+//? 获取实际采集采样率
+double inmp441_get_actual_sample_rate(void)
+{
+    return g_actual_rate;
+}
+
+//? 启动采集引擎
+esp_err_t inmp441_capture_start(size_t queue_len)
+{
+    if (rx_handle == NULL || g_capture_queue != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (queue_len == 0) {
+        queue_len = INMP441_CAPTURE_QUEUE_LEN ? INMP441_CAPTURE_QUEUE_LEN : g_dma_desc_num - 1;
+    }
+    
+    g_capture_queue = xQueueCreate(queue_len, sizeof(inmp441_block_t));
+    if (g_capture_queue == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    g_capture_seq = 0;
+    g_capture_overruns = 0;
+    g_capture_peak = 0;
+    g_capture_stale = 0;
+    
+    //? 回调只能在通道禁用时注册
+    i2s_channel_disable(rx_handle);
+    i2s_event_callbacks_t cbs = { .on_recv = rx_on_recv };
+    esp_err_t ret = i2s_channel_register_event_callback(rx_handle, &cbs, NULL);
+    if (ret != ESP_OK) {
+        vQueueDelete(g_capture_queue);
+        g_capture_queue = NULL;
+        i2s_channel_enable(rx_handle);
+        return ret;
+    }
+    ESP_LOGI(TAG, "Capture engine started (queue %u blocks)", (unsigned)queue_len);
+    return i2s_channel_enable(rx_handle);
+}
+
+//? 停止采集引擎
+esp_err_t inmp441_capture_stop(void)
+{
+    if (g_capture_queue == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    i2s_channel_disable(rx_handle);
+    i2s_event_callbacks_t cbs = { 0 };
+    i2s_channel_register_event_callback(rx_handle, &cbs, NULL);
+    vQueueDelete(g_capture_queue);
+    g_capture_queue = NULL;
+    esp_err_t ret = i2s_channel_enable(rx_handle);
+    
+    //? 引擎运行期间驱动消息队列里积压的是旧块，读空后 i2s_channel_read() 才返回新数据
+    int32_t flush[64];
+    size_t bytes_read = 0;
+    while (i2s_channel_read(rx_handle, flush, sizeof(flush), &bytes_read, 0) == ESP_OK) {
+    }
+    ESP_LOGI(TAG, "Capture engine stopped");
+    return ret;
+}
+
+//? 取出下一个DMA块
+bool inmp441_capture_receive(inmp441_block_t *blk, TickType_t timeout)
+{
+    if (g_capture_queue == NULL || blk == NULL) {
+        return false;
+    }
+    return xQueueReceive(g_capture_queue, blk, timeout) == pdTRUE;
+}
+
+//? 检查块数据是否仍有效
+bool inmp441_capture_block_valid(const inmp441_block_t *blk)
+{
+    //? 序号为k的块完成后DMA依次写入后续缓冲区，再收到 desc_num-1 个块时开始覆写k所在的缓冲区
+    if (g_capture_seq - blk->seq < g_dma_desc_num) {
+        return true;
+    }
+    g_capture_stale++;
+    return false;
+}
+
+//? 获取采集引擎统计
+void inmp441_capture_get_stats(inmp441_capture_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    stats->blocks = g_capture_seq;
+    stats->overruns = g_capture_overruns;
+    stats->stale = g_capture_stale;
+    stats->queue_peak = g_capture_peak;
 }
 
 //? 设置噪声门限
@@ -62,16 +374,61 @@ int32_t inmp441_get_noise_gate(void)
     return g_noise_gate_threshold;
 }
 
+//? 设置高通截止频率
+void inmp441_set_highpass(float cutoff_hz)
+{
+    //? 截止频率须低于奈奎斯特频率，否则系数无意义
+    if (cutoff_hz < 0.0f || cutoff_hz >= g_sample_rate / 2) {
+        cutoff_hz = 0.0f;
+    }
+    audio_dsp_cascade_init(&g_hpf, cutoff_hz > 0.0f ? 1 : 0);
+    if (cutoff_hz > 0.0f) {
+        audio_dsp_design_highpass(&g_hpf.coef[0], cutoff_hz, 0.7071f, g_sample_rate);
+    }
+    g_hpf_cutoff = cutoff_hz;
+}
+
+//? 获取当前高通截止频率
+float inmp441_get_highpass(void)
+{
+    return g_hpf_cutoff;
+}
+
+//? 高通滤波
+void inmp441_highpass(void *data, size_t len)
+{
+    if (data == NULL || g_hpf.stages == 0) {
+        return;
+    }
+    audio_dsp_cascade_process(&g_hpf, (int32_t *)data, len / sizeof(int32_t));
+}
+
 //? 过滤音频数据中的噪声
-void inmp441_filter_noise(void *data, size_t len)
+void AUDIO_DSP_IRAM_ATTR inmp441_filter_noise(void *data, size_t len)
 {
-    if (data == NULL || len == 0 || g_noise_gate_threshold == 0) {
+    if (data == NULL || len == 0) {
         return;
     }
     
     int32_t *samples = (int32_t *)data;
     size_t sample_count = len / sizeof(int32_t);
     
+    //? 先去除直流偏置，否则偏置会抬高小信号的幅度，使噪声门限失效
+    //? 直接调用级联内核（同在IRAM中），不经 inmp441_highpass()
+    if (g_hpf.stages != 0) {
+        audio_dsp_cascade_process(&g_hpf, samples, sample_count);
+    }
+    
+    //? 采样率切换后淡入（Q15系数）
+    for (size_t i = 0; i < sample_count && g_fade_in_pos < g_fade_in_total; i++, g_fade_in_pos++) {
+        int32_t k = (int32_t)(((uint64_t)g_fade_in_pos << 15) / g_fade_in_total);
+        samples[i] = (int32_t)(((int64_t)samples[i] * k) >> 15);
+    }
+    
+    if (g_noise_gate_threshold == 0) {
+        return;
+    }
+    
     for (size_t i = 0; i < sample_count; i++) {
         int32_t sample = samples[i];
         
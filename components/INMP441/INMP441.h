@@ -3,8 +3,11 @@
 #include <stdio.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
 #include "driver/i2s_std.h"
 #include "driver/gpio.h"
+#include "i2s_clock.h"
+#include "audio_dsp.h"
 
 //? INMP441引脚配置，根据自己连线修改
 //? 注意：如需修改引脚配置，请直接修改此文件
@@ -14,11 +17,37 @@
 
 //? I2S配置参数
 //? 注意：音频配置在此组件头文件中管理
-#define INMP441_SAMPLE_RATE     44100  //? 采样率
-#define INMP441_DMA_FRAME_NUM   256     //? DMA缓冲帧数
+#define INMP441_SAMPLE_RATE     44100  //? 初始采样率，运行时可用 inmp441_set_sample_rate() 切换
+#define INMP441_DMA_FRAME_NUM   256     //? 默认DMA缓冲帧数（BALANCED档位）
+#define INMP441_DMA_FRAME_NUM_MAX 511   //? 运行时可选的最大DMA帧数
+#define INMP441_DMA_DESC_NUM    6       //? 默认DMA描述符数量
+#define INMP441_DMA_DESC_NUM_MAX 16     //? 运行时可选的最大描述符数量
 #define INMP441_BIT_WIDTH       32      //? 位宽
 #define INMP441_CHANNEL_MODE    I2S_SLOT_MODE_MONO  //? 声道模式
 
+//? 延迟档位：DMA描述符数量 x 每个描述符帧数，与 MAX98367A 的档位一致
+//? 采集延迟约为 frame_num / 采样率（一个块填满才能读到），描述符数量决定可容忍的读取抖动
+typedef enum {
+    INMP441_LATENCY_LOW = 0,        //? 4 x 64帧
+    INMP441_LATENCY_BALANCED,       //? 6 x 256帧（默认）
+    INMP441_LATENCY_POWER_SAVE,     //? 8 x 511帧
+    INMP441_LATENCY_PROFILE_COUNT,
+} inmp441_latency_profile_t;
+
+//? 1=按采样率自动选择误差和抖动最小的时钟源与MCLK倍数（i2s_clock），0=使用 I2S_STD_CLK_DEFAULT_CONFIG
+#ifndef INMP441_CLK_AUTO
+#define INMP441_CLK_AUTO        1
+#endif
+
+//? 运行时切换采样率的允许范围
+#define INMP441_MIN_SAMPLE_RATE 8000
+#define INMP441_MAX_SAMPLE_RATE 96000
+
+//? 切换采样率后的淡入时长（毫秒），掩盖麦克风时钟恢复期间的瞬态
+#ifndef INMP441_FADE_MS
+#define INMP441_FADE_MS         5
+#endif
+
 //? 噪声门限配置（用于过滤麦克风小信号杂音）
 //? 低于此阈值的音频信号将被静音
 //? 范围: 0 ~ INT32_MAX，建议值: 100000 ~ 10000000
@@ -27,10 +56,97 @@
 #define INMP441_NOISE_GATE_THRESHOLD    500000
 #endif
 
+//? 高通滤波截止频率（Hz），0 = 禁用
+//? MEMS麦克风输出带有直流偏置和低频隆隆声，既浪费编码位数，也会让基于幅度的噪声门限和VAD误判；
+//? 二阶巴特沃斯高通在直流处增益为0，可同时去除直流和风噪/振动等低频干扰，语音应用建议60~100Hz
+#ifndef INMP441_HPF_CUTOFF_HZ
+#define INMP441_HPF_CUTOFF_HZ   80
+#endif
+
+//? 采集引擎队列默认长度（0表示按 DMA描述符数量-1，即DMA覆写前最多能积压的块数）
+#ifndef INMP441_CAPTURE_QUEUE_LEN
+#define INMP441_CAPTURE_QUEUE_LEN   0
+#endif
+
+//? 采集引擎交付的DMA块
+//? data 直接指向DMA缓冲区（零拷贝），DMA转一圈后会被覆写：
+//? 处理完成后用 inmp441_capture_block_valid() 再确认一次，返回false说明处理期间数据已被覆盖
+typedef struct {
+    const int32_t *data;    //? DMA缓冲区（只读）
+    size_t len;             //? 字节数
+    uint32_t seq;           //? 块序号，连续递增；跳号说明队列溢出丢块
+    int64_t timestamp_us;   //? 块最后一个样本到达的时间（esp_timer，on_recv中断中记录）
+    uint32_t cycles;        //? 同一时刻的CPU周期计数（中断所在核），用于AEC等精确对齐
+} inmp441_block_t;
+
+//? 采集引擎统计
+typedef struct {
+    uint32_t blocks;        //? on_recv 收到的块数
+    uint32_t overruns;      //? 队列满时丢弃的最旧块数（消费者跟不上）
+    uint32_t stale;         //? inmp441_capture_block_valid() 检出的已被DMA覆写的块数
+    uint32_t queue_peak;    //? 队列最高积压块数
+} inmp441_capture_stats_t;
+
 extern i2s_chan_handle_t rx_handle;
 
+//? 初始化I2S接收（独立模式：使用 I2S_NUM_0 和 INMP_SCK / INMP_WS）
 void i2s_rx_init(void);
 
+//? 接管外部创建的RX通道（全双工模式，见 i2s_duplex 组件），代替 i2s_rx_init()
+//? 此模式下 inmp441_set_dma_config() 返回 ESP_ERR_NOT_SUPPORTED，采样率应通过 i2s_duplex_set_sample_rate() 切换
+//? @param handle 已创建、尚未初始化的RX通道
+//? @param desc_num / frame_num 创建通道时使用的DMA参数
+//? @param bclk / ws 共用的时钟引脚
+esp_err_t inmp441_attach(i2s_chan_handle_t handle, uint32_t desc_num, uint32_t frame_num, gpio_num_t bclk, gpio_num_t ws);
+
+//? 选择延迟档位，等同于 inmp441_set_dma_config() 使用档位对应的参数
+esp_err_t inmp441_set_latency_profile(inmp441_latency_profile_t profile);
+
+//? 运行时修改DMA描述符数量和帧数
+//? DMA缓冲区只能在创建通道时分配，因此会删除并重建RX通道（保留当前采样率），须先停止读取
+//? @param desc_num 描述符数量（2 ~ INMP441_DMA_DESC_NUM_MAX）
+//? @param frame_num 每个描述符帧数（8 ~ INMP441_DMA_FRAME_NUM_MAX）
+//? @return ESP_OK 成功, ESP_ERR_INVALID_ARG 参数超出范围, 其他值为I2S驱动错误
+esp_err_t inmp441_set_dma_config(uint32_t desc_num, uint32_t frame_num);
+
+//? 获取当前每个DMA块的帧数（读取时按此大小分块可使每次读取对应一次DMA中断）
+uint32_t inmp441_get_dma_frame_num(void);
+
+//? 运行时切换采集采样率（禁用通道 -> 重配时钟 -> 启用通道，不删除通道）
+//? 切换期间 i2s_channel_read() 会返回错误，须在采集任务中调用或先暂停读取
+//? @param sample_rate 新采样率（INMP441_MIN_SAMPLE_RATE ~ INMP441_MAX_SAMPLE_RATE）
+//? @return ESP_OK 成功, ESP_ERR_INVALID_ARG 采样率超出范围, 其他值为I2S驱动错误
+esp_err_t inmp441_set_sample_rate(uint32_t sample_rate);
+
+//? 获取当前采集采样率（标称值）
+uint32_t inmp441_get_sample_rate(void);
+
+//? 获取实际采集采样率（按时钟分频估算）
+double inmp441_get_actual_sample_rate(void);
+
+//? ==================== 采集引擎（on_recv 中断驱动） ====================
+//? 启动后不要再调用 i2s_channel_read()，数据只通过 inmp441_capture_receive() 交付
+
+//? 启动采集引擎：注册 on_recv 回调，每个DMA块完成时把块指针、时间戳和序号送入队列
+//? @param queue_len 队列长度，0表示使用 INMP441_CAPTURE_QUEUE_LEN / 默认值
+//? @return ESP_OK 成功, ESP_ERR_INVALID_STATE 未初始化或已启动, ESP_ERR_NO_MEM 队列创建失败
+esp_err_t inmp441_capture_start(size_t queue_len);
+
+//? 停止采集引擎并注销回调，之后可恢复使用 i2s_channel_read()
+esp_err_t inmp441_capture_stop(void);
+
+//? 取出下一个DMA块
+//? @param blk 输出块描述
+//? @param timeout 等待超时（tick）
+//? @return true 取到数据, false 超时或引擎未启动
+bool inmp441_capture_receive(inmp441_block_t *blk, TickType_t timeout);
+
+//? 检查块数据是否仍有效（DMA尚未覆写该缓冲区）
+bool inmp441_capture_block_valid(const inmp441_block_t *blk);
+
+//? 获取采集引擎统计
+void inmp441_capture_get_stats(inmp441_capture_stats_t *stats);
+
 //? 设置噪声门限
 //? @param threshold 噪声门限值，0表示禁用
 void inmp441_set_noise_gate(int32_t threshold);
@@ -39,9 +155,25 @@ void inmp441_set_noise_gate(int32_t threshold);
 //? @return 当前噪声门限值
 int32_t inmp441_get_noise_gate(void);
 
-//? 过滤音频数据中的噪声
+//? 设置高通滤波截止频率，切换采样率时自动按新采样率重新计算系数
+//? @param cutoff_hz 截止频率（Hz），0表示禁用
+void inmp441_set_highpass(float cutoff_hz);
+
+//? 获取当前高通截止频率（0表示禁用）
+float inmp441_get_highpass(void);
+
+//? 高通滤波（原地处理整块，滤波器状态跨块保持，须按采集顺序逐块调用）
+//? @param data 音频数据缓冲区（int32_t数组）
+//? @param len 数据长度（字节数）
+void inmp441_highpass(void *data, size_t len);
+
+//? 过滤音频数据中的噪声：先高通去除直流和低频，再做噪声门限；
+//? 采样率切换后的前 INMP441_FADE_MS 毫秒同时做淡入
 //? @param data 音频数据缓冲区（int32_t数组）
 //? @param len 数据长度（字节数）
 void inmp441_filter_noise(void *data, size_t len);
 
+//? 打包性能测试：按当前DMA块大小测量24位/16位打包与解包的CPU周期数（见 audio_pack 组件）
+void inmp441_pack_benchmark(void);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,67 @@
+#include "INMP441.h"
+#include "audio_pack.h"
+#include "esp_log.h"
+#include "esp_cpu.h"
+#include "sdkconfig.h"
+#include <string.h>
+
+static const char *TAG = "INMP441_BENCH";
+
+//? 每项测试重复次数
+#define BENCH_ITERATIONS    64
+
+//? 测试缓冲区：按最大DMA块分配，打包输出按字对齐
+static int32_t s_src[INMP441_DMA_FRAME_NUM_MAX];
+static int32_t s_dst[INMP441_DMA_FRAME_NUM_MAX];
+static uint32_t s_packed[INMP441_DMA_FRAME_NUM_MAX];
+
+//? 填充INMP441格式的伪随机数据（高24位有效，固定种子）
+static void bench_fill(size_t n)
+{
+    uint32_t seed = 0x12345678;
+    for (size_t i = 0; i < n; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        s_src[i] = (int32_t)(seed & 0xFFFFFF00u);
+    }
+}
+
+//? 打印一项结果：每块周期数及占实时处理预算的百分比
+static void bench_report(const char *name, uint32_t total_cycles, size_t n)
+{
+    uint32_t cycles = total_cycles / BENCH_ITERATIONS;
+    uint32_t budget = (uint32_t)((uint64_t)CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * 1000000ULL * n / inmp441_get_sample_rate());
+    ESP_LOGI(TAG, "%-20s %7lu cycles/block  %5.2f cycles/sample  %5.2f%% CPU",
+             name, (unsigned long)cycles, (float)cycles / n, 100.0f * cycles / budget);
+}
+
+#define BENCH_RUN(name, stmt) do {                                  \
+    uint32_t start = esp_cpu_get_cycle_count();                     \
+    for (int it = 0; it < BENCH_ITERATIONS; it++) {                 \
+        stmt;                                                       \
+    }                                                               \
+    bench_report(name, esp_cpu_get_cycle_count() - start, n);       \
+} while (0)
+
+void inmp441_pack_benchmark(void)
+{
+    const size_t n = inmp441_get_dma_frame_num();
+    audio_pack_dither_t dither;
+    audio_pack_dither_init(&dither, 1);
+    bench_fill(n);
+
+    ESP_LOGI(TAG, "Block: %u samples @ %lu Hz, CPU %d MHz, %d iterations",
+             (unsigned)n, (unsigned long)inmp441_get_sample_rate(), CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ, BENCH_ITERATIONS);
+
+    BENCH_RUN("pack s24", audio_pack_s32_to_s24(s_src, (uint8_t *)s_packed, n));
+    BENCH_RUN("unpack s24", audio_unpack_s24_to_s32((const uint8_t *)s_packed, s_dst, n));
+    //? 顺带校验往返结果，确认目标平台上的打包与主机测试一致
+    bool exact = memcmp(s_src, s_dst, n * sizeof(int32_t)) == 0;
+    BENCH_RUN("pack s16", audio_pack_s32_to_s16(s_src, (int16_t *)s_packed, n, NULL));
+    BENCH_RUN("pack s16 + dither", audio_pack_s32_to_s16(s_src, (int16_t *)s_packed, n, &dither));
+    BENCH_RUN("unpack s16", audio_unpack_s16_to_s32((const int16_t *)s_packed, s_dst, n));
+    BENCH_RUN("copy s32", memcpy(s_dst, s_src, n * sizeof(int32_t)));
+
+    ESP_LOGI(TAG, "Payload per block: s32 %u B, s24 %u B, s16 %u B; s24 round trip %s",
+             (unsigned)audio_pack_bytes(AUDIO_PACK_S32, n), (unsigned)audio_pack_bytes(AUDIO_PACK_S24, n),
+             (unsigned)audio_pack_bytes(AUDIO_PACK_S16, n), exact ? "exact" : "MISMATCH");
+}
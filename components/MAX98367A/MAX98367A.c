@@ -1,6 +1,9 @@
 #include "MAX98367A.h"
 #include "esp_log.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
 #include <math.h>
+#include <string.h>
 
 static const char *TAG = "MAX98367A";
 
@@ -9,24 +12,182 @@ i2s_chan_handle_t tx_handle;
 //? 当前音量增益值
 static float g_volume_gain = MAX98367A_DEFAULT_GAIN;
 
+//? 片段处理缓冲区（一个DMA块大小）：增益、声道混合、位宽转换在此完成
+static max98367a_sample_t g_play_buffer[MAX98367A_BLOCK_SAMPLES_MAX];
 
-void i2s_tx_init(void)
+//? 当前DMA配置
+static uint32_t g_dma_desc_num = MAX98367A_DMA_DESC_NUM;
+static uint32_t g_dma_frame_num = MAX98367A_DMA_FRAME_NUM;
+
+//? 各延迟档位的DMA参数 {desc_num, frame_num}
+static const uint32_t s_latency_profiles[MAX98367A_LATENCY_PROFILE_COUNT][2] = {
+    [MAX98367A_LATENCY_LOW]        = {4, 64},
+    [MAX98367A_LATENCY_BALANCED]   = {MAX98367A_DMA_DESC_NUM, MAX98367A_DMA_FRAME_NUM},
+    [MAX98367A_LATENCY_POWER_SAVE] = {8, MAX98367A_DMA_FRAME_NUM_MAX},
+};
+
+//? ISR统计
+static volatile uint32_t g_sent_blocks = 0;
+static volatile uint32_t g_underruns = 0;
+
+//? DMA余量统计：已写入与已发送字节数（32位回绕，差值即DMA中待发送的数据量）
+static volatile uint32_t g_written_bytes = 0;
+static volatile uint32_t g_sent_bytes = 0;
+static volatile uint32_t g_headroom_min = UINT32_MAX;
+
+//? 播放流状态：只有流进行中的欠载才计数，空闲时DMA输出静音不算欠载
+//? g_stream_open 由 begin/end 控制；g_streaming 在流中第一次写入数据后才置位，避免把开头的空DMA计为欠载
+static bool g_stream_open = false;
+static volatile bool g_streaming = false;
+static bool g_preroll_pending = false;
+static uint32_t g_preroll_blocks = MAX98367A_PREROLL_BLOCKS;
+static int64_t g_stream_start_us = 0;
+static uint64_t g_stream_time_us = 0;
+
+//? 低水位回调
+static uint32_t g_low_watermark = 0;
+static max98367a_low_watermark_cb_t g_low_watermark_cb = NULL;
+static void *g_low_watermark_arg = NULL;
+static volatile bool g_low_watermark_armed = true;
+
+//? 延迟探针
+static volatile max98367a_sample_t g_probe_marker = 0;
+static volatile int64_t g_probe_time_us = 0;
+
+//? 当前输出采样率（标称值与按时钟分频估算的实际值）
+static uint32_t g_sample_rate = MAX98367A_SAMPLE_RATE;
+static double g_actual_rate = MAX98367A_SAMPLE_RATE;
+
+//? 最近写入DMA的一帧样本，切换采样率时从这里淡出到静音
+static max98367a_sample_t g_last_frame[MAX98367A_CHANNEL_NUM];
+
+//? 动态范围压缩：参数与音量修改后置位 g_comp_dirty，输出路径在下一块开头换算
+static audio_dsp_comp_t g_comp;
+static audio_dsp_comp_config_t g_comp_cfg = AUDIO_DSP_COMP_CONFIG_DEFAULT();
+static bool g_comp_enabled = MAX98367A_COMP_ENABLE;
+static bool g_comp_ready = false;
+static volatile bool g_comp_dirty = true;
+static portMUX_TYPE g_comp_lock = portMUX_INITIALIZER_UNLOCKED;
+
+//? 参数均衡：当前生效的级联（每声道一份状态）与待切换的新系数
+//? 设置接口只写 g_eq_next 并置位 g_eq_pending，输出路径在下一块开头交叉淡化切换
+static max98367a_eq_band_t g_eq_bands[MAX98367A_EQ_MAX_BANDS];
+static size_t g_eq_band_count = 0;
+static audio_dsp_biquad_cascade_t g_eq[MAX98367A_CHANNEL_NUM];
+static audio_dsp_biquad_cascade_t g_eq_next;
+static volatile bool g_eq_pending = false;
+static portMUX_TYPE g_eq_lock = portMUX_INITIALIZER_UNLOCKED;
+//? 交叉淡化时保存旧系数的输出
+static max98367a_sample_t g_eq_old[MAX98367A_BLOCK_SAMPLES_MAX];
+#if MAX98367A_CHANNEL_NUM == 2
+//? 立体声按声道解交织后分别滤波
+static max98367a_sample_t g_eq_ch[2][MAX98367A_DMA_FRAME_NUM_MAX];
+#endif
+
+//? 淡入进度：切换采样率后前 g_fade_in_total 帧按 pos/total 线性放大
+static size_t g_fade_in_total = 0;
+static size_t g_fade_in_pos = 0;
+
+
+//? DMA块发送完成（ISR上下文）
+static bool IRAM_ATTR tx_on_sent(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx)
 {
-    i2s_chan_config_t chan_cfg = I2S_CHANNEL_DEFAULT_CONFIG(I2S_NUM_1, I2S_ROLE_MASTER);
+    bool woken = false;
     
-    //? 优化：减小dma frame num，降低延迟，提高实时性
-    chan_cfg.dma_frame_num = MAX98367A_DMA_FRAME_NUM;
-    chan_cfg.auto_clear = true;     //? 自动清除DMA缓冲区
-    i2s_new_channel(&chan_cfg, &tx_handle, NULL);
- 
+    g_sent_blocks++;
+    if (g_probe_marker != 0 && *(const max98367a_sample_t *)event->dma_buf == g_probe_marker) {
+        g_probe_time_us = esp_timer_get_time();
+        g_probe_marker = 0;
+    }
+    
+    //? 更新余量：本块最多消耗待发送的数据量，不足部分是auto_clear的静音
+    uint32_t pending = g_written_bytes - g_sent_bytes;
+    uint32_t consumed = event->size < pending ? event->size : pending;
+    g_sent_bytes += consumed;
+    pending -= consumed;
+    
+    if (g_streaming) {
+        uint32_t blocks = pending / event->size;
+        if (blocks < g_headroom_min) {
+            g_headroom_min = blocks;
+        }
+        //? 余量降到水位以下时唤醒供数任务（边沿触发，回升后重新武装）
+        if (blocks <= g_low_watermark) {
+            if (g_low_watermark_armed && g_low_watermark_cb != NULL) {
+                g_low_watermark_armed = false;
+                woken = g_low_watermark_cb(g_low_watermark_arg);
+            }
+        } else {
+            g_low_watermark_armed = true;
+        }
+    }
+    return woken;
+}
+
+//? 发送队列溢出：DMA已发完所有数据而应用未及时写入，即欠载（ISR上下文）
+static bool IRAM_ATTR tx_on_send_q_ovf(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx)
+{
+    if (g_streaming) {
+        g_underruns++;
+    }
+    return false;
+}
+
+//? DMA被重置（禁用/重建通道）后清零余量记录
+static void reset_headroom(void)
+{
+    g_written_bytes = 0;
+    g_sent_bytes = 0;
+}
+
+//? 写入输出格式数据并累计已写入字节数
+static esp_err_t tx_write(const void *src, size_t size, size_t *bytes_written, TickType_t timeout)
+{
+    size_t written = 0;
+    esp_err_t ret = i2s_channel_write(tx_handle, src, size, &written, timeout);
+    g_written_bytes += written;
+    if (written > 0 && g_stream_open) {
+        g_streaming = true;
+    }
+    if (bytes_written) {
+        *bytes_written = written;
+    }
+    return ret;
+}
+
+//? 全双工模式：通道由外部创建（与麦克风共用控制器和BCLK/WS），本驱动只负责配置和使用
+static bool g_attached = false;
+static gpio_num_t g_pin_bclk = MAX_BCLK;
+static gpio_num_t g_pin_ws = MAX_LRC;
+static uint32_t g_slot_bits = MAX98367A_BIT_WIDTH;
+static max98367a_rate_hook_t g_rate_hook = NULL;
+static void *g_rate_hook_arg = NULL;
+
+//? 生成指定采样率的时钟配置，同时更新实际采样率
+static void make_clk_cfg(uint32_t sample_rate, i2s_std_clk_config_t *clk_cfg)
+{
+    i2s_std_clk_config_t def = I2S_STD_CLK_DEFAULT_CONFIG(sample_rate);
+    *clk_cfg = def;
+    g_actual_rate = sample_rate;
+#if MAX98367A_CLK_AUTO
+    i2s_clock_info_t info;
+    if (i2s_clock_select(sample_rate, g_slot_bits, clk_cfg, &info) == ESP_OK) {
+        g_actual_rate = info.actual_rate;
+        i2s_clock_log(TAG, &info);
+    }
+#endif
+}
+
+//? 在 tx_handle 上初始化标准模式、注册回调并启用
+static esp_err_t tx_channel_setup(void)
+{
     i2s_std_config_t std_cfg = {
-        .clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(MAX98367A_SAMPLE_RATE),
-        .slot_cfg = I2S_STD_MSB_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_32BIT, MAX98367A_CHANNEL_MODE),
+        .slot_cfg = I2S_STD_MSB_SLOT_DEFAULT_CONFIG(MAX98367A_DATA_BIT_WIDTH, MAX98367A_CHANNEL_MODE),
         .gpio_cfg = {
             .mclk = I2S_GPIO_UNUSED,
             .din = I2S_GPIO_UNUSED,
-            .bclk = MAX_BCLK,
-            .ws = MAX_LRC,
+            .bclk = g_pin_bclk,
+            .ws = g_pin_ws,
             .dout = MAX_DIN,
             .invert_flags = {
                 .mclk_inv = false,
@@ -36,9 +197,325 @@ void i2s_tx_init(void)
         },
     };
  
-    i2s_channel_init_std_mode(tx_handle, &std_cfg);
+    //? 单声道模式下左右slot都发送同一样本（MAX98367A按SD_MODE选择声道）
+    std_cfg.slot_cfg.slot_mask = I2S_STD_SLOT_BOTH;
+    //? slot宽度与BCLK绑定，全双工时需与麦克风一致（32位）
+    std_cfg.slot_cfg.slot_bit_width = (i2s_slot_bit_width_t)g_slot_bits;
+    make_clk_cfg(g_sample_rate, &std_cfg.clk_cfg);
+ 
+    esp_err_t ret = i2s_channel_init_std_mode(tx_handle, &std_cfg);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    i2s_event_callbacks_t cbs = {
+        .on_sent = tx_on_sent,
+        .on_send_q_ovf = tx_on_send_q_ovf,
+    };
+    i2s_channel_register_event_callback(tx_handle, &cbs, NULL);
  
-    i2s_channel_enable(tx_handle);
+    return i2s_channel_enable(tx_handle);
+}
+
+//? 按当前DMA配置和采样率创建并启用TX通道
+static esp_err_t tx_channel_create(void)
+{
+    i2s_chan_config_t chan_cfg = I2S_CHANNEL_DEFAULT_CONFIG(I2S_NUM_1, I2S_ROLE_MASTER);
+    
+    //? 优化：减小dma frame num，降低延迟，提高实时性
+    chan_cfg.dma_frame_num = g_dma_frame_num;
+    chan_cfg.dma_desc_num = g_dma_desc_num;
+    chan_cfg.auto_clear = true;     //? 自动清除DMA缓冲区
+    esp_err_t ret = i2s_new_channel(&chan_cfg, &tx_handle, NULL);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    return tx_channel_setup();
+}
+
+//? 接管外部创建的TX通道（全双工模式）
+esp_err_t max98367a_attach(i2s_chan_handle_t handle, uint32_t desc_num, uint32_t frame_num,
+                           gpio_num_t bclk, gpio_num_t ws, max98367a_rate_hook_t hook, void *arg)
+{
+    if (handle == NULL || frame_num > MAX98367A_DMA_FRAME_NUM_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    tx_handle = handle;
+    g_attached = true;
+    g_dma_desc_num = desc_num;
+    g_dma_frame_num = frame_num;
+    g_pin_bclk = bclk;
+    g_pin_ws = ws;
+    g_slot_bits = 32;
+    g_rate_hook = hook;
+    g_rate_hook_arg = arg;
+    reset_headroom();
+    return tx_channel_setup();
+}
+
+void i2s_tx_init(void)
+{
+    tx_channel_create();
+}
+
+//? 选择延迟档位
+esp_err_t max98367a_set_latency_profile(max98367a_latency_profile_t profile)
+{
+    if (profile >= MAX98367A_LATENCY_PROFILE_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return max98367a_set_dma_config(s_latency_profiles[profile][0], s_latency_profiles[profile][1]);
+}
+
+//? 修改DMA配置：删除并重建通道
+esp_err_t max98367a_set_dma_config(uint32_t desc_num, uint32_t frame_num)
+{
+    if (desc_num < 2 || desc_num > MAX98367A_DMA_DESC_NUM_MAX ||
+        frame_num < 8 || frame_num > MAX98367A_DMA_FRAME_NUM_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (desc_num == g_dma_desc_num && frame_num == g_dma_frame_num) {
+        return ESP_OK;
+    }
+    //? 全双工通道与麦克风同时创建，不能单独重建
+    if (g_attached) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    
+    if (tx_handle != NULL) {
+        i2s_channel_disable(tx_handle);
+        i2s_del_channel(tx_handle);
+        tx_handle = NULL;
+    }
+    reset_headroom();
+    g_dma_desc_num = desc_num;
+    g_dma_frame_num = frame_num;
+    memset(g_last_frame, 0, sizeof(g_last_frame));
+    
+    esp_err_t ret = tx_channel_create();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Recreate TX channel (%lu x %lu) failed: %s",
+                 (unsigned long)desc_num, (unsigned long)frame_num, esp_err_to_name(ret));
+        return ret;
+    }
+    ESP_LOGI(TAG, "DMA config: %lu desc x %lu frames (%.1f ms buffered)",
+             (unsigned long)desc_num, (unsigned long)frame_num, 1000.0f * desc_num * frame_num / g_sample_rate);
+    return ESP_OK;
+}
+
+//? 获取DMA统计
+void max98367a_get_dma_stats(max98367a_dma_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    stats->dma_desc_num = g_dma_desc_num;
+    stats->dma_frame_num = g_dma_frame_num;
+    stats->sent_blocks = g_sent_blocks;
+    stats->underruns = g_underruns;
+    
+    uint32_t block_bytes = g_dma_frame_num * MAX98367A_CHANNEL_NUM * sizeof(max98367a_sample_t);
+    stats->headroom_blocks = (g_written_bytes - g_sent_bytes) / block_bytes;
+    stats->headroom_min_blocks = g_headroom_min == UINT32_MAX ? 0 : g_headroom_min;
+    
+    uint64_t stream_us = g_stream_time_us;
+    if (g_stream_open) {
+        stream_us += esp_timer_get_time() - g_stream_start_us;
+    }
+    stats->stream_time_us = stream_us;
+    stats->underruns_per_min = stream_us ? g_underruns * 60e6f / stream_us : 0.0f;
+}
+
+//? 清零DMA统计
+void max98367a_reset_dma_stats(void)
+{
+    g_sent_blocks = 0;
+    g_underruns = 0;
+    g_headroom_min = UINT32_MAX;
+    g_stream_time_us = 0;
+    if (g_stream_open) {
+        g_stream_start_us = esp_timer_get_time();
+    }
+}
+
+//? 设置预填充块数
+void max98367a_set_preroll(uint32_t blocks)
+{
+    g_preroll_blocks = blocks;
+}
+
+//? 设置低水位回调
+void max98367a_set_low_watermark(uint32_t blocks, max98367a_low_watermark_cb_t cb, void *arg)
+{
+    //? 先清回调再改参数，避免ISR看到不一致的组合
+    g_low_watermark_cb = NULL;
+    g_low_watermark = blocks;
+    g_low_watermark_arg = arg;
+    g_low_watermark_armed = true;
+    g_low_watermark_cb = cb;
+}
+
+//? 开始播放流
+void max98367a_stream_begin(void)
+{
+    if (g_stream_open) {
+        return;
+    }
+    g_preroll_pending = true;
+    g_low_watermark_armed = true;
+    g_stream_start_us = esp_timer_get_time();
+    g_stream_open = true;
+}
+
+//? 结束播放流
+void max98367a_stream_end(void)
+{
+    if (!g_stream_open) {
+        return;
+    }
+    g_stream_open = false;
+    g_streaming = false;
+    g_preroll_pending = false;
+    g_stream_time_us += esp_timer_get_time() - g_stream_start_us;
+}
+
+//? 以预处理好的输出格式数据写入DMA（计入余量统计）
+esp_err_t max98367a_write(const void *data, size_t len, size_t *bytes_written, TickType_t timeout)
+{
+    return tx_write(data, len, bytes_written, timeout);
+}
+
+//? 设置延迟探针
+void max98367a_probe_arm(max98367a_sample_t marker)
+{
+    g_probe_time_us = 0;
+    g_probe_marker = marker;
+}
+
+//? 获取探针触发时间
+int64_t max98367a_probe_time_us(void)
+{
+    return g_probe_time_us;
+}
+
+//? 淡入/淡出帧数
+static size_t fade_frames(uint32_t sample_rate)
+{
+    return (size_t)sample_rate * MAX98367A_FADE_MS / 1000;
+}
+
+//? 对缓冲区开头应用淡入（切换采样率后尚未完成淡入时）
+static void AUDIO_DSP_IRAM_ATTR apply_fade_in(max98367a_sample_t *buf, size_t frames)
+{
+    for (size_t f = 0; f < frames && g_fade_in_pos < g_fade_in_total; f++, g_fade_in_pos++) {
+        //? Q15系数，避免逐样本浮点运算
+        int32_t k = (int32_t)(((uint64_t)g_fade_in_pos << 15) / g_fade_in_total);
+        for (int c = 0; c < MAX98367A_CHANNEL_NUM; c++) {
+            buf[f * MAX98367A_CHANNEL_NUM + c] = (max98367a_sample_t)(((int64_t)buf[f * MAX98367A_CHANNEL_NUM + c] * k) >> 15);
+        }
+    }
+}
+
+//? 从最后一帧淡出到静音，再写入与描述符数量相同的静音块把淡出数据推出DMA
+static esp_err_t fade_out_and_drain(void)
+{
+    size_t total = fade_frames(g_sample_rate);
+    size_t pos = 0;
+    size_t bytes_written = 0;
+    esp_err_t ret;
+    
+    while (pos < total) {
+        size_t frames = (total - pos) > g_dma_frame_num ? g_dma_frame_num : (total - pos);
+        for (size_t f = 0; f < frames; f++) {
+            int32_t k = (int32_t)(((uint64_t)(total - pos - f) << 15) / total);
+            for (int c = 0; c < MAX98367A_CHANNEL_NUM; c++) {
+                g_play_buffer[f * MAX98367A_CHANNEL_NUM + c] = (max98367a_sample_t)(((int64_t)g_last_frame[c] * k) >> 15);
+            }
+        }
+        ret = tx_write(g_play_buffer, frames * MAX98367A_CHANNEL_NUM * sizeof(max98367a_sample_t),
+                       &bytes_written, portMAX_DELAY);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        pos += frames;
+    }
+    
+    memset(g_play_buffer, 0, sizeof(g_play_buffer));
+    memset(g_last_frame, 0, sizeof(g_last_frame));
+    for (uint32_t i = 0; i < g_dma_desc_num; i++) {
+        ret = tx_write(g_play_buffer, g_dma_frame_num * MAX98367A_CHANNEL_NUM * sizeof(max98367a_sample_t),
+                       &bytes_written, portMAX_DELAY);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    return ESP_OK;
+}
+
+//? 运行时切换采样率
+esp_err_t max98367a_set_sample_rate(uint32_t sample_rate)
+{
+    if (sample_rate < MAX98367A_MIN_SAMPLE_RATE || sample_rate > MAX98367A_MAX_SAMPLE_RATE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (sample_rate == g_sample_rate) {
+        return ESP_OK;
+    }
+    
+    esp_err_t ret = fade_out_and_drain();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    //? 时钟只能在通道禁用时重配，DMA描述符和GPIO保持不变
+    //? 重新启用后到下一次写入之间DMA为空，暂停欠载计数
+    g_streaming = false;
+    i2s_channel_disable(tx_handle);
+    reset_headroom();
+    i2s_std_clk_config_t clk_cfg;
+    make_clk_cfg(sample_rate, &clk_cfg);
+    ret = i2s_channel_reconfig_std_clock(tx_handle, &clk_cfg);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Reconfig clock to %lu Hz failed: %s", (unsigned long)sample_rate, esp_err_to_name(ret));
+        make_clk_cfg(g_sample_rate, &clk_cfg);
+        i2s_channel_reconfig_std_clock(tx_handle, &clk_cfg);
+        i2s_channel_enable(tx_handle);
+        return ret;
+    }
+    ret = i2s_channel_enable(tx_handle);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    ESP_LOGI(TAG, "Sample rate: %lu -> %lu Hz", (unsigned long)g_sample_rate, (unsigned long)sample_rate);
+    g_sample_rate = sample_rate;
+    g_fade_in_total = fade_frames(sample_rate);
+    g_fade_in_pos = 0;
+    
+    //? 均衡系数与采样率相关，按新采样率重新计算（切换后正在淡入，交叉淡化不可闻）
+    if (g_eq_band_count > 0) {
+        max98367a_set_eq(g_eq_bands, g_eq_band_count);
+    }
+    //? 压缩器时间常数按块数换算，同样与采样率相关
+    g_comp_dirty = true;
+    
+    //? 全双工时BCLK/WS与麦克风共用，通知另一方同步切换
+    if (g_rate_hook != NULL) {
+        g_rate_hook(sample_rate, g_rate_hook_arg);
+    }
+    return ESP_OK;
+}
+
+//? 获取当前输出采样率
+uint32_t max98367a_get_sample_rate(void)
+{
+    return g_sample_rate;
+}
+
+//? 获取实际输出采样率
+double max98367a_get_actual_sample_rate(void)
+{
+    return g_actual_rate;
 }
 
 //? 设置音量增益
@@ -50,6 +527,7 @@ void max98367a_set_gain(float gain)
         gain = MAX98367A_MAX_GAIN;
     }
     g_volume_gain = gain;
+    g_comp_dirty = true;
     ESP_LOGI(TAG, "Volume gain set to: %.2f", g_volume_gain);
 }
 
@@ -66,26 +544,599 @@ void max98367a_apply_gain(void *data, size_t len)
         return;
     }
     
+    if (g_comp_enabled) {
+        //? 参数或音量有变化：换算到压缩器（保留增益状态）
+        if (g_comp_dirty) {
+            portENTER_CRITICAL(&g_comp_lock);
+            audio_dsp_comp_config_t cfg = g_comp_cfg;
+            g_comp_dirty = false;
+            portEXIT_CRITICAL(&g_comp_lock);
+            if (!g_comp_ready) {
+                audio_dsp_comp_init(&g_comp, &cfg, g_sample_rate, MAX98367A_CHANNEL_NUM);
+                g_comp_ready = true;
+            } else {
+                audio_dsp_comp_set_config(&g_comp, &cfg, g_sample_rate);
+            }
+            audio_dsp_comp_set_input_gain(&g_comp, g_volume_gain);
+        }
+        size_t frames = len / sizeof(max98367a_sample_t) / MAX98367A_CHANNEL_NUM;
+#if MAX98367A_BIT_WIDTH == 16
+        audio_dsp_comp_process_s16(&g_comp, (int16_t *)data, frames);
+#else
+        audio_dsp_comp_process_s32(&g_comp, (int32_t *)data, frames);
+#endif
+        return;
+    }
+    
     //? 如果增益为1.0，无需处理
     if (fabsf(g_volume_gain - 1.0f) < 0.01f) {
         return;
     }
     
-    int32_t *samples = (int32_t *)data;
-    size_t sample_count = len / sizeof(int32_t);
+    //? 增益转为Q8定点，整块只计算一次
+    int32_t gain_q8 = (int32_t)(g_volume_gain * 256.0f);
     
-    for (size_t i = 0; i < sample_count; i++) {
-        //? 应用增益
-        int64_t temp = (int64_t)samples[i] * (int64_t)(g_volume_gain * 256.0f);
-        temp = temp >> 8;  //? 除以256恢复
-        
-        //? 防止溢出
-        if (temp > INT32_MAX) {
-            temp = INT32_MAX;
-        } else if (temp < INT32_MIN) {
-            temp = INT32_MIN;
+#if MAX98367A_BIT_WIDTH == 16
+    max98367a_gain_s16((int16_t *)data, len / sizeof(int16_t), gain_q8);
+#else
+    max98367a_gain_s32((int32_t *)data, len / sizeof(int32_t), gain_q8);
+#endif
+}
+
+//? 设置动态范围压缩参数
+void max98367a_set_compressor(const audio_dsp_comp_config_t *cfg)
+{
+    portENTER_CRITICAL(&g_comp_lock);
+    if (cfg != NULL) {
+        g_comp_cfg = *cfg;
+    }
+    //? 从关闭切换到启用时从无衰减状态开始
+    if (cfg != NULL && !g_comp_enabled) {
+        g_comp_ready = false;
+    }
+    g_comp_enabled = (cfg != NULL);
+    g_comp_dirty = true;
+    portEXIT_CRITICAL(&g_comp_lock);
+    
+    if (cfg != NULL) {
+        ESP_LOGI(TAG, "Compressor: %s, threshold %.1f dBFS, ratio %.1f:1, knee %.1f dB, attack %.1f ms, release %.1f ms, makeup %.1f dB",
+                 cfg->detect == AUDIO_DSP_DETECT_RMS ? "RMS" : "peak", cfg->threshold_db, cfg->ratio,
+                 cfg->knee_db, cfg->attack_ms, cfg->release_ms, cfg->makeup_db);
+    } else {
+        ESP_LOGI(TAG, "Compressor disabled");
+    }
+}
+
+//? 获取当前压缩参数
+bool max98367a_get_compressor(audio_dsp_comp_config_t *cfg)
+{
+    portENTER_CRITICAL(&g_comp_lock);
+    if (cfg != NULL) {
+        *cfg = g_comp_cfg;
+    }
+    bool enabled = g_comp_enabled;
+    portEXIT_CRITICAL(&g_comp_lock);
+    return enabled;
+}
+
+//? 当前压缩增益衰减
+float max98367a_get_gain_reduction_db(void)
+{
+    return (g_comp_enabled && g_comp_ready) ? audio_dsp_comp_get_reduction_db(&g_comp) : 0.0f;
+}
+
+//? ==================== 参数均衡 ====================
+
+//? 按段参数计算一个二阶节的系数
+static esp_err_t eq_design(const max98367a_eq_band_t *b, uint32_t fs, audio_dsp_biquad_coef_t *c)
+{
+    if (b->freq_hz <= 0.0f || b->freq_hz >= 0.5f * fs || b->q <= 0.0f) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    switch (b->type) {
+    case MAX98367A_EQ_PEAKING:
+        audio_dsp_design_peaking(c, b->freq_hz, b->gain_db, b->q, fs);
+        break;
+    case MAX98367A_EQ_LOW_SHELF:
+        audio_dsp_design_low_shelf(c, b->freq_hz, b->gain_db, b->q, fs);
+        break;
+    case MAX98367A_EQ_HIGH_SHELF:
+        audio_dsp_design_high_shelf(c, b->freq_hz, b->gain_db, b->q, fs);
+        break;
+    case MAX98367A_EQ_HIGHPASS:
+        audio_dsp_design_highpass(c, b->freq_hz, b->q, fs);
+        break;
+    case MAX98367A_EQ_LOWPASS:
+        audio_dsp_design_lowpass(c, b->freq_hz, b->q, fs);
+        break;
+    default:
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ESP_OK;
+}
+
+//? 设置参数均衡
+esp_err_t max98367a_set_eq(const max98367a_eq_band_t *bands, size_t count)
+{
+    if (count > MAX98367A_EQ_MAX_BANDS || (count > 0 && bands == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    //? 先在局部计算，参数全部有效才提交
+    audio_dsp_biquad_cascade_t next;
+    audio_dsp_cascade_init(&next, (uint8_t)count);
+    for (size_t i = 0; i < count; i++) {
+        esp_err_t ret = eq_design(&bands[i], g_sample_rate, &next.coef[i]);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "EQ band %u invalid (type %d, %.1f Hz, Q %.2f)",
+                     (unsigned)i, bands[i].type, bands[i].freq_hz, bands[i].q);
+            return ret;
+        }
+    }
+    
+    portENTER_CRITICAL(&g_eq_lock);
+    //? bands 可能就是 g_eq_bands（切换采样率时），memmove 安全
+    memmove(g_eq_bands, bands, count * sizeof(max98367a_eq_band_t));
+    g_eq_band_count = count;
+    g_eq_next = next;
+    g_eq_pending = true;
+    portEXIT_CRITICAL(&g_eq_lock);
+    
+    ESP_LOGI(TAG, "EQ: %u band(s) @ %lu Hz", (unsigned)count, (unsigned long)g_sample_rate);
+    return ESP_OK;
+}
+
+//? 获取当前均衡设置
+size_t max98367a_get_eq(max98367a_eq_band_t *bands, size_t max_count)
+{
+    portENTER_CRITICAL(&g_eq_lock);
+    size_t count = g_eq_band_count < max_count ? g_eq_band_count : max_count;
+    if (bands != NULL) {
+        memcpy(bands, g_eq_bands, count * sizeof(max98367a_eq_band_t));
+    }
+    portEXIT_CRITICAL(&g_eq_lock);
+    return count;
+}
+
+//? 单声道数据经过一组级联
+static inline void eq_cascade(audio_dsp_biquad_cascade_t *f, max98367a_sample_t *data, size_t count)
+{
+#if MAX98367A_BIT_WIDTH == 16
+    audio_dsp_cascade_process_s16(f, data, count);
+#else
+    audio_dsp_cascade_process(f, data, count);
+#endif
+}
+
+//? 交织数据逐声道经过各自的级联
+static void eq_run(audio_dsp_biquad_cascade_t *eq, max98367a_sample_t *data, size_t frames)
+{
+#if MAX98367A_CHANNEL_NUM == 2
+#if MAX98367A_BIT_WIDTH == 16
+    audio_dsp_deinterleave_s16(data, g_eq_ch[0], g_eq_ch[1], frames);
+    eq_cascade(&eq[0], g_eq_ch[0], frames);
+    eq_cascade(&eq[1], g_eq_ch[1], frames);
+    audio_dsp_interleave_s16(g_eq_ch[0], g_eq_ch[1], data, frames);
+#else
+    audio_dsp_deinterleave_s32(data, g_eq_ch[0], g_eq_ch[1], frames);
+    eq_cascade(&eq[0], g_eq_ch[0], frames);
+    eq_cascade(&eq[1], g_eq_ch[1], frames);
+    audio_dsp_interleave_s32(g_eq_ch[0], g_eq_ch[1], data, frames);
+#endif
+#else
+    eq_cascade(&eq[0], data, frames);
+#endif
+}
+
+//? 左移并饱和到int32
+static inline int32_t eq_shl_sat(int32_t v, int d)
+{
+    int64_t x = (int64_t)v * (1 << d);
+    return x > INT32_MAX ? INT32_MAX : (x < INT32_MIN ? INT32_MIN : (int32_t)x);
+}
+
+//? 切换到新系数：沿用旧级联的输入/输出历史，避免新滤波器从零状态起振
+//? 内部输出按 2^shift 缩小存储，系数缩放不同时按比例换算
+static void eq_adopt(audio_dsp_biquad_cascade_t *dst, const audio_dsp_biquad_cascade_t *next,
+                     const audio_dsp_biquad_cascade_t *prev)
+{
+    *dst = *next;
+    for (uint8_t k = 0; k < dst->stages && k < prev->stages; k++) {
+        audio_dsp_biquad_state_t st = prev->state[k];
+        int d = (int)prev->coef[k].shift - (int)dst->coef[k].shift;
+        if (d > 0) {
+            st.y1 = eq_shl_sat(st.y1, d);
+            st.y2 = eq_shl_sat(st.y2, d);
+        } else if (d < 0) {
+            st.y1 >>= -d;
+            st.y2 >>= -d;
+        }
+        st.err = 0;
+        dst->state[k] = st;
+    }
+}
+
+//? 应用参数均衡
+void max98367a_apply_eq(void *data, size_t len)
+{
+    //? 旁路快速路径
+    if (data == NULL || len == 0 || (g_eq[0].stages == 0 && !g_eq_pending)) {
+        return;
+    }
+    
+    max98367a_sample_t *samples = (max98367a_sample_t *)data;
+    size_t count = len / sizeof(max98367a_sample_t);
+    size_t frames = count / MAX98367A_CHANNEL_NUM;
+    if (count > MAX98367A_BLOCK_SAMPLES_MAX) {
+        count = MAX98367A_BLOCK_SAMPLES_MAX;
+        frames = count / MAX98367A_CHANNEL_NUM;
+    }
+    
+    if (!g_eq_pending) {
+        eq_run(g_eq, samples, frames);
+        return;
+    }
+    
+    //? 有新系数：本块分别用旧、新系数处理，在块内从旧输出线性过渡到新输出
+    audio_dsp_biquad_cascade_t next[MAX98367A_CHANNEL_NUM];
+    portENTER_CRITICAL(&g_eq_lock);
+    for (int c = 0; c < MAX98367A_CHANNEL_NUM; c++) {
+        eq_adopt(&next[c], &g_eq_next, &g_eq[c]);
+    }
+    g_eq_pending = false;
+    portEXIT_CRITICAL(&g_eq_lock);
+    
+    memcpy(g_eq_old, samples, frames * MAX98367A_CHANNEL_NUM * sizeof(max98367a_sample_t));
+    eq_run(g_eq, g_eq_old, frames);
+    eq_run(next, samples, frames);
+    for (size_t f = 0; f < frames; f++) {
+        //? Q15淡化系数，k 从0（全旧）到接近1（全新）
+        int32_t k = (int32_t)(((uint64_t)f << 15) / frames);
+        for (int c = 0; c < MAX98367A_CHANNEL_NUM; c++) {
+            size_t i = f * MAX98367A_CHANNEL_NUM + c;
+            int64_t old = g_eq_old[i];
+            samples[i] = (max98367a_sample_t)(old + (((samples[i] - old) * k) >> 15));
+        }
+    }
+    memcpy(g_eq, next, sizeof(g_eq));
+}
+
+//? 32位增益
+void AUDIO_DSP_IRAM_ATTR max98367a_gain_s32(int32_t *samples, size_t count, int32_t gain_q8)
+{
+    audio_dsp_scale_s32(samples, count, gain_q8, 8);
+}
+
+//? 16位增益
+void AUDIO_DSP_IRAM_ATTR max98367a_gain_s16(int16_t *samples, size_t count, int32_t gain_q8)
+{
+    audio_dsp_scale_s16(samples, count, gain_q8, 8);
+}
+
+//? 32位饱和混音
+void AUDIO_DSP_IRAM_ATTR max98367a_mix_s32(int32_t *dst, const int32_t *src, size_t count)
+{
+    audio_dsp_add_sat_s32(dst, src, count);
+}
+
+//? 16位饱和混音
+void AUDIO_DSP_IRAM_ATTR max98367a_mix_s16(int16_t *dst, const int16_t *src, size_t count)
+{
+    audio_dsp_add_sat_s16(dst, src, count);
+}
+
+//? 32位转16位：取高16位
+void AUDIO_DSP_IRAM_ATTR max98367a_s32_to_s16(const int32_t *src, int16_t *dst, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = (int16_t)(src[i] >> 16);
+    }
+}
+
+//? 16位转32位：放到高16位
+void AUDIO_DSP_IRAM_ATTR max98367a_s16_to_s32(const int16_t *src, int32_t *dst, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = (int32_t)((uint32_t)(uint16_t)src[i] << 16);
+    }
+}
+
+//? 立体声混为单声道
+void AUDIO_DSP_IRAM_ATTR max98367a_downmix_stereo(const int32_t *src, int32_t *dst, size_t frames)
+{
+    //? 先各自右移一位再相加，避免int32溢出
+    for (size_t i = 0; i < frames; i++) {
+        dst[i] = (src[2 * i] >> 1) + (src[2 * i + 1] >> 1);
+    }
+}
+
+void AUDIO_DSP_IRAM_ATTR max98367a_downmix_stereo_s16(const int16_t *src, int16_t *dst, size_t frames)
+{
+    for (size_t i = 0; i < frames; i++) {
+        dst[i] = (int16_t)(((int32_t)src[2 * i] + src[2 * i + 1]) >> 1);
+    }
+}
+
+//? 读取片段中第i个样本并转换到输出位宽
+static inline max98367a_sample_t AUDIO_DSP_IRAM_ATTR load_sample(const void *src, size_t i, uint8_t bits)
+{
+#if MAX98367A_BIT_WIDTH == 16
+    return (bits == 16) ? ((const int16_t *)src)[i] : (int16_t)(((const int32_t *)src)[i] >> 16);
+#else
+    return (bits == 32) ? ((const int32_t *)src)[i] : (int32_t)((uint32_t)(uint16_t)((const int16_t *)src)[i] << 16);
+#endif
+}
+
+//? 把一块片段数据转换为输出格式，写入dst，返回输出字节数
+static size_t AUDIO_DSP_IRAM_ATTR convert_block(const void *src, size_t frames, uint8_t channels, uint8_t bits, max98367a_sample_t *dst)
+{
+    bool downmix = (channels == 2 && MAX98367A_CHANNEL_NUM == 1);
+    
+    if (bits == MAX98367A_BIT_WIDTH) {
+        if (!downmix) {
+            memcpy(dst, src, frames * MAX98367A_CHANNEL_NUM * sizeof(max98367a_sample_t));
+        } else {
+#if MAX98367A_BIT_WIDTH == 16
+            max98367a_downmix_stereo_s16((const int16_t *)src, dst, frames);
+#else
+            max98367a_downmix_stereo((const int32_t *)src, dst, frames);
+#endif
+        }
+    } else if (downmix) {
+        for (size_t f = 0; f < frames; f++) {
+            dst[f] = (load_sample(src, 2 * f, bits) >> 1) + (load_sample(src, 2 * f + 1, bits) >> 1);
         }
-        
-        samples[i] = (int32_t)temp;
+    } else {
+        for (size_t i = 0; i < frames * MAX98367A_CHANNEL_NUM; i++) {
+            dst[i] = load_sample(src, i, bits);
+        }
+    }
+    
+    return frames * MAX98367A_CHANNEL_NUM * sizeof(max98367a_sample_t);
+}
+
+//? 记录已写入数据的最后一帧（转换为输出格式），供淡出使用
+static void save_last_frame(const void *src, size_t frames, uint8_t channels, uint8_t bits)
+{
+    if (frames == 0) {
+        return;
+    }
+    size_t base = (frames - 1) * channels;
+    if (channels == 2 && MAX98367A_CHANNEL_NUM == 1) {
+        g_last_frame[0] = (load_sample(src, base, bits) >> 1) + (load_sample(src, base + 1, bits) >> 1);
+    } else {
+        for (int c = 0; c < MAX98367A_CHANNEL_NUM; c++) {
+            g_last_frame[c] = load_sample(src, base + c, bits);
+        }
+    }
+}
+
+//? 对 g_play_buffer 中已是输出格式的一块数据做输出处理（均衡、运行时增益、淡入），返回字节数
+static size_t process_block(size_t frames, uint32_t flags)
+{
+    size_t out_bytes = frames * MAX98367A_CHANNEL_NUM * sizeof(max98367a_sample_t);
+    max98367a_apply_eq(g_play_buffer, out_bytes);
+    if (!(flags & MAX98367A_CLIP_PRESCALED)) {
+        max98367a_apply_gain(g_play_buffer, out_bytes);
+    }
+    apply_fade_in(g_play_buffer, frames);
+    memcpy(g_last_frame, &g_play_buffer[(frames - 1) * MAX98367A_CHANNEL_NUM], sizeof(g_last_frame));
+    return out_bytes;
+}
+
+//? 把一块片段数据处理为输出格式（格式转换、运行时增益、淡入），结果在 g_play_buffer 中，返回字节数
+static size_t prepare_block(const void *src, size_t frames, uint8_t channels, uint8_t bits, uint32_t flags)
+{
+    convert_block(src, frames, channels, bits, g_play_buffer);
+    return process_block(frames, flags);
+}
+
+//? 块生产者：把下一块数据处理到 g_play_buffer 中，返回字节数，0表示没有更多数据
+typedef size_t (*block_fill_t)(void *ctx);
+
+//? 片段的读取位置
+typedef struct {
+    const uint8_t *src;
+    size_t frames_left;
+    size_t frame_bytes;
+    uint8_t channels;
+    uint8_t bits;
+    uint32_t flags;
+} clip_cursor_t;
+
+static size_t clip_fill(void *ctx)
+{
+    clip_cursor_t *c = (clip_cursor_t *)ctx;
+    if (c->frames_left == 0) {
+        return 0;
     }
-}
\ No newline at end of file
+    size_t frames = c->frames_left > g_dma_frame_num ? g_dma_frame_num : c->frames_left;
+    size_t out_bytes = prepare_block(c->src, frames, c->channels, c->bits, c->flags);
+    c->src += frames * c->frame_bytes;
+    c->frames_left -= frames;
+    return out_bytes;
+}
+
+//? 拉模式音源；g_source_flags 由音源在回调中通过 max98367a_source_set_flags() 设置，每块开始时清零
+static uint32_t g_source_flags = 0;
+
+typedef struct {
+    max98367a_source_fn_t fn;
+    void *arg;
+} source_cursor_t;
+
+static size_t source_fill(void *ctx)
+{
+    source_cursor_t *c = (source_cursor_t *)ctx;
+    g_source_flags = 0;
+    size_t frames = c->fn(g_play_buffer, g_dma_frame_num, c->arg);
+    if (frames == 0) {
+        return 0;
+    }
+    return process_block(frames > g_dma_frame_num ? g_dma_frame_num : frames, g_source_flags);
+}
+
+//? 设置当前块的片段标志
+void max98367a_source_set_flags(uint32_t flags)
+{
+    g_source_flags = flags;
+}
+
+//? 预填充：通道保持运行（不停时钟、不重置DMA），DMA中待发送的数据不足N块时先补静音块，
+//? 使生产者在第一块数据之前就有N块的余量；上一段流的尾部仍在DMA中时新数据直接接在其后
+static esp_err_t preroll(TickType_t timeout)
+{
+    uint32_t blocks = g_preroll_blocks < g_dma_desc_num ? g_preroll_blocks : g_dma_desc_num;
+    size_t block_bytes = g_dma_frame_num * MAX98367A_CHANNEL_NUM * sizeof(max98367a_sample_t);
+    uint32_t queued = (g_written_bytes - g_sent_bytes) / block_bytes;
+    if (queued >= blocks) {
+        return ESP_OK;
+    }
+    
+    memset(g_play_buffer, 0, block_bytes);
+    esp_err_t ret = ESP_OK;
+    for (uint32_t i = queued; i < blocks && ret == ESP_OK; i++) {
+        size_t bytes_written = 0;
+        ret = tx_write(g_play_buffer, block_bytes, &bytes_written, timeout);
+    }
+    return ret;
+}
+
+//? 逐块生产并写入，流的第一段数据先按设置预填充DMA
+//? @param direct 非NULL时每块之前调用，返回true表示剩余数据已由它直接写完
+static esp_err_t play_blocks(block_fill_t fill, void *ctx, bool (*direct)(void *ctx, esp_err_t *ret, TickType_t timeout),
+                             TickType_t timeout)
+{
+    size_t bytes_written = 0;
+    esp_err_t ret = ESP_OK;
+    
+    if (g_preroll_pending) {
+        g_preroll_pending = false;
+        ret = preroll(timeout);
+    }
+    
+    while (ret == ESP_OK) {
+        if (direct != NULL && direct(ctx, &ret, timeout)) {
+            break;
+        }
+        size_t out_bytes = fill(ctx);
+        if (out_bytes == 0) {
+            break;
+        }
+        ret = tx_write(g_play_buffer, out_bytes, &bytes_written, timeout);
+    }
+    return ret;
+}
+
+//? 预缩放且格式一致的片段：增益已烘焙，淡入完成且均衡旁路时剩余数据直接交给DMA
+static bool clip_direct(void *ctx, esp_err_t *ret, TickType_t timeout)
+{
+    clip_cursor_t *c = (clip_cursor_t *)ctx;
+    if (g_fade_in_pos < g_fade_in_total || g_eq[0].stages != 0 || g_eq_pending) {
+        return false;
+    }
+    size_t bytes_written = 0;
+    *ret = tx_write(c->src, c->frames_left * c->frame_bytes, &bytes_written, timeout);
+    if (*ret == ESP_OK) {
+        save_last_frame(c->src, c->frames_left, c->channels, c->bits);
+    }
+    c->frames_left = 0;
+    return true;
+}
+
+//? 读取片段的一段并转换为输出格式
+size_t max98367a_clip_read(const max98367a_clip_t *clip, size_t frame, max98367a_sample_t *dst, size_t frames)
+{
+    if (clip == NULL || clip->data == NULL || dst == NULL) {
+        return 0;
+    }
+    uint8_t channels = clip->channels ? clip->channels : MAX98367A_CHANNEL_NUM;
+    uint8_t bits = clip->bits ? clip->bits : MAX98367A_BIT_WIDTH;
+    bool downmix = (channels == 2 && MAX98367A_CHANNEL_NUM == 1);
+    if ((channels != MAX98367A_CHANNEL_NUM && !downmix) || (bits != 16 && bits != 32)) {
+        return 0;
+    }
+    
+    size_t frame_bytes = channels * bits / 8;
+    size_t total = clip->len / frame_bytes;
+    if (frame >= total) {
+        return 0;
+    }
+    if (frames > total - frame) {
+        frames = total - frame;
+    }
+    convert_block((const uint8_t *)clip->data + frame * frame_bytes, frames, channels, bits, dst);
+    return frames;
+}
+
+//? 播放音频片段
+esp_err_t max98367a_play_clip(const max98367a_clip_t *clip, TickType_t timeout)
+{
+    if (clip == NULL || clip->data == NULL || clip->len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    uint8_t channels = clip->channels ? clip->channels : MAX98367A_CHANNEL_NUM;
+    uint8_t bits = clip->bits ? clip->bits : MAX98367A_BIT_WIDTH;
+    bool downmix = (channels == 2 && MAX98367A_CHANNEL_NUM == 1);
+    if ((channels != MAX98367A_CHANNEL_NUM && !downmix) || (bits != 16 && bits != 32)) {
+        ESP_LOGE(TAG, "Unsupported clip format: %d ch / %d bit (output %d ch / %d bit)",
+                 channels, bits, MAX98367A_CHANNEL_NUM, MAX98367A_BIT_WIDTH);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    
+    //? 按片段原生采样率输出，省去重采样
+    esp_err_t ret;
+    if (clip->sample_rate != 0 && clip->sample_rate != g_sample_rate) {
+        ret = max98367a_set_sample_rate(clip->sample_rate);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    
+    //? 调用者未显式开始流时，单个片段即一段流
+    bool own_stream = !g_stream_open;
+    if (own_stream) {
+        max98367a_stream_begin();
+    }
+    
+    clip_cursor_t cur = {
+        .src = (const uint8_t *)clip->data,
+        .frame_bytes = channels * bits / 8,
+        .channels = channels,
+        .bits = bits,
+        .flags = clip->flags,
+    };
+    cur.frames_left = clip->len / cur.frame_bytes;
+    bool direct = (clip->flags & MAX98367A_CLIP_PRESCALED) && !downmix && bits == MAX98367A_BIT_WIDTH;
+    
+    //? 逐块处理：格式转换、应用运行时增益和淡入后写入
+    ret = play_blocks(clip_fill, &cur, direct ? clip_direct : NULL, timeout);
+    
+    if (own_stream) {
+        max98367a_stream_end();
+    }
+    return ret;
+}
+
+//? 播放拉模式音源
+esp_err_t max98367a_play_source(max98367a_source_fn_t fn, void *arg, TickType_t timeout)
+{
+    if (fn == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    bool own_stream = !g_stream_open;
+    if (own_stream) {
+        max98367a_stream_begin();
+    }
+    
+    //? 音源直接生成到块缓冲区，省去中间拷贝和格式转换
+    source_cursor_t cur = {.fn = fn, .arg = arg};
+    esp_err_t ret = play_blocks(source_fill, &cur, NULL, timeout);
+    
+    if (own_stream) {
+        max98367a_stream_end();
+    }
+    return ret;
+}
@@ -7,6 +7,8 @@
 #include "freertos/task.h"
 #include "driver/i2s_std.h"
 #include "driver/gpio.h"
+#include "i2s_clock.h"
+#include "audio_dsp.h"
 
 //? MAX98357A引脚，根据自己连线修改
 //? 注意：如需修改引脚配置，请直接修改此文件
@@ -16,17 +18,104 @@
 
 //? I2S配置参数
 //? 注意：音频配置在此组件头文件中管理
-#define MAX98367A_SAMPLE_RATE     44100                 //? 采样率
-#define MAX98367A_DMA_FRAME_NUM   256                   //? DMA缓冲帧数
+#define MAX98367A_SAMPLE_RATE     44100                 //? 初始采样率，运行时可用 max98367a_set_sample_rate() 切换
+#define MAX98367A_DMA_FRAME_NUM   256                   //? 默认DMA缓冲帧数（BALANCED档位）
+#define MAX98367A_DMA_FRAME_NUM_MAX 511                 //? 运行时可选的最大DMA帧数（决定内部缓冲区大小）
+
+//? 输出位宽：32（默认）或 16
+//? 16位模式下I2S BCLK、DMA内存（BUF_SIZE）和每次增益/混音处理的数据量都减半，
+//? MAX98357/MAX98367类功放原生支持16位数据
+#ifndef MAX98367A_BIT_WIDTH
 #define MAX98367A_BIT_WIDTH       32                    //? 位宽
-#define MAX98367A_CHANNEL_NUM     2                     //? 声道数
+#endif
+
+#if MAX98367A_BIT_WIDTH == 16
+typedef int16_t max98367a_sample_t;                     //? 输出样本类型
+#define MAX98367A_DATA_BIT_WIDTH  I2S_DATA_BIT_WIDTH_16BIT
+#elif MAX98367A_BIT_WIDTH == 32
+typedef int32_t max98367a_sample_t;                     //? 输出样本类型
+#define MAX98367A_DATA_BIT_WIDTH  I2S_DATA_BIT_WIDTH_32BIT
+#else
+#error "MAX98367A_BIT_WIDTH must be 16 or 32"
+#endif
+
+//? MAX98367A是单声道功放：默认以单声道模式输出，内存中每帧只存一个样本
+//? 单声道模式下 slot_mask 为 BOTH，I2S硬件把同一样本同时发到左右两个slot，
+//? 无论功放SD_MODE选择左声道、右声道还是(L+R)/2都能得到完整信号，
+//? 片段、下行音频帧和DMA缓冲区都只占立体声的一半空间
+#ifndef MAX98367A_CHANNEL_NUM
+#define MAX98367A_CHANNEL_NUM     1                     //? 声道数
+#endif
+
+#if MAX98367A_CHANNEL_NUM == 1
+#define MAX98367A_CHANNEL_MODE    I2S_SLOT_MODE_MONO    //? 声道模式
+#else
 #define MAX98367A_CHANNEL_MODE    I2S_SLOT_MODE_STEREO  //? 声道模式
+#endif
 
 //? buf size计算方法：根据esp32官方文档，buf size = dma frame num * 声道数 * 数据位宽 / 8
 //? 优化：减小缓冲区，降低延迟，提高实时性（从511改为256帧）
+//? 位宽改变时DMA缓冲区随之重新计算；单个DMA缓冲区不能超过4092字节
 #define BUF_SIZE    (MAX98367A_DMA_FRAME_NUM * MAX98367A_CHANNEL_NUM * MAX98367A_BIT_WIDTH / 8)
+#define MAX98367A_BLOCK_SAMPLES   (MAX98367A_DMA_FRAME_NUM * MAX98367A_CHANNEL_NUM)   //? 每个DMA块的样本数
+#define MAX98367A_BLOCK_SAMPLES_MAX (MAX98367A_DMA_FRAME_NUM_MAX * MAX98367A_CHANNEL_NUM)
+_Static_assert(MAX98367A_DMA_FRAME_NUM_MAX * MAX98367A_CHANNEL_NUM * MAX98367A_BIT_WIDTH / 8 <= 4092,
+               "I2S DMA buffer must not exceed 4092 bytes");
 #define SAMPLE_RATE MAX98367A_SAMPLE_RATE  //? 保留旧定义用于兼容
 
+//? 1=按采样率自动选择误差和抖动最小的时钟源与MCLK倍数（i2s_clock），0=使用 I2S_STD_CLK_DEFAULT_CONFIG
+#ifndef MAX98367A_CLK_AUTO
+#define MAX98367A_CLK_AUTO        1
+#endif
+
+//? 运行时切换采样率的允许范围
+#define MAX98367A_MIN_SAMPLE_RATE 8000
+#define MAX98367A_MAX_SAMPLE_RATE 96000
+
+//? 切换采样率时的淡出/淡入时长（毫秒），避免时钟切换瞬间的爆音
+#ifndef MAX98367A_FADE_MS
+#define MAX98367A_FADE_MS         5
+#endif
+
+//? 默认I2S DMA描述符数量（切换采样率前写入同样数量的静音块，确保淡出数据已全部发出）
+#ifndef MAX98367A_DMA_DESC_NUM
+#define MAX98367A_DMA_DESC_NUM    6
+#endif
+#define MAX98367A_DMA_DESC_NUM_MAX 16                   //? 运行时可选的最大描述符数量
+
+//? 延迟档位：DMA描述符数量 x 每个描述符帧数
+//? 缓冲延迟约为 desc_num * frame_num / 采样率，中断频率为 采样率 / frame_num
+typedef enum {
+    MAX98367A_LATENCY_LOW = 0,          //? 4 x 64帧：44.1kHz下约5.8ms缓冲，约690次中断/秒
+    MAX98367A_LATENCY_BALANCED,         //? 6 x 256帧（默认）：约35ms缓冲，约172次中断/秒
+    MAX98367A_LATENCY_POWER_SAVE,       //? 8 x 511帧：约93ms缓冲，约86次中断/秒
+    MAX98367A_LATENCY_PROFILE_COUNT,
+} max98367a_latency_profile_t;
+
+//? 预填充块数：流开始时DMA中待发送的数据不足N块则先补静音，给生产者留出N块余量，0表示不预填充（不超过描述符数量）
+#ifndef MAX98367A_PREROLL_BLOCKS
+#define MAX98367A_PREROLL_BLOCKS  2
+#endif
+
+//? DMA运行统计（ISR中累加）
+typedef struct {
+    uint32_t dma_desc_num;      //? 当前描述符数量
+    uint32_t dma_frame_num;     //? 当前每个描述符帧数
+    uint32_t sent_blocks;       //? on_sent 次数（每次对应一次DMA中断）
+    uint32_t underruns;         //? 播放流进行中 on_send_q_ovf 次数：DMA取不到新数据，输出auto_clear的静音
+    float underruns_per_min;    //? 按累计播放时长折算的每分钟欠载次数
+    uint32_t headroom_blocks;   //? 当前DMA中尚未发送的块数
+    uint32_t headroom_min_blocks; //? 播放流中观察到的最小余量（0表示曾经几乎耗尽）
+    uint64_t stream_time_us;    //? 累计播放时长
+} max98367a_dma_stats_t;
+
+//? 全双工模式下采样率切换后的通知回调（任务上下文），用于同步切换共用时钟的RX通道
+typedef void (*max98367a_rate_hook_t)(uint32_t sample_rate, void *arg);
+
+//? 低水位回调（ISR上下文，须放在IRAM中且不能阻塞），返回true表示唤醒了更高优先级任务
+//? 典型用法：在回调中 vTaskNotifyGiveFromISR() 唤醒供数任务
+typedef bool (*max98367a_low_watermark_cb_t)(void *arg);
+
 //? 音量增益配置
 //? 增益范围: 0.0 ~ 5.0 (0.0=静音, 1.0=原音量, 5.0=5倍音量)
 #ifndef MAX98367A_DEFAULT_GAIN
@@ -38,11 +127,114 @@
 #define MAX98367A_MAX_GAIN        5.0f
 #endif
 
+//? 动态范围压缩：1=默认启用（参数见 AUDIO_DSP_COMP_CONFIG_DEFAULT），运行时可用 max98367a_set_compressor() 修改或关闭
+//? 启用后音量增益并入压缩器，电平检测在音量之后进行，削波前先被压缩
+#ifndef MAX98367A_COMP_ENABLE
+#define MAX98367A_COMP_ENABLE     1
+#endif
+
+//? 参数均衡最大段数
+#ifndef MAX98367A_EQ_MAX_BANDS
+#define MAX98367A_EQ_MAX_BANDS    8
+#endif
+_Static_assert(MAX98367A_EQ_MAX_BANDS <= AUDIO_DSP_BIQUAD_MAX_STAGES, "EQ bands exceed audio_dsp cascade size");
+
+//? 均衡段类型
+typedef enum {
+    MAX98367A_EQ_PEAKING = 0,       //? 峰值（钟形）：提升/衰减 freq_hz 附近，q 决定带宽
+    MAX98367A_EQ_LOW_SHELF,         //? 低频搁架：freq_hz 以下整体提升/衰减
+    MAX98367A_EQ_HIGH_SHELF,        //? 高频搁架：freq_hz 以上整体提升/衰减
+    MAX98367A_EQ_HIGHPASS,          //? 二阶高通：切除小喇叭无法重放的低频（gain_db 不使用）
+    MAX98367A_EQ_LOWPASS,           //? 二阶低通（gain_db 不使用）
+} max98367a_eq_type_t;
+
+//? 均衡段参数
+typedef struct {
+    max98367a_eq_type_t type;
+    float freq_hz;                  //? 中心/转折频率
+    float gain_db;                  //? 增益（dB）
+    float q;                        //? 品质因数，0.7071为巴特沃斯
+} max98367a_eq_band_t;
+
+//? 音频片段标志
+#define MAX98367A_CLIP_PRESCALED  (1u << 0)     //? 增益已在构建时烘焙进数据，播放时跳过 max98367a_apply_gain()
+
+//? 音频片段描述（16或32位，多声道时交错存放）
+typedef struct {
+    const void *data;       //? PCM数据（可直接指向Flash中的资源）
+    size_t len;             //? 数据长度（字节数）
+    uint32_t flags;         //? MAX98367A_CLIP_* 标志组合
+    uint8_t channels;       //? 片段声道数，0表示与输出一致；单声道输出时立体声片段会实时混为单声道
+    uint8_t bits;           //? 片段位宽（16/32），0表示与输出一致；不一致时逐块转换
+    uint32_t sample_rate;   //? 片段原生采样率，0表示沿用当前采样率；不同时播放前切换I2S时钟，无需重采样
+} max98367a_clip_t;
+
 extern i2s_chan_handle_t tx_handle;
 
-//? 初始化I2S发送
+//? 初始化I2S发送（独立模式：使用 I2S_NUM_1 和 MAX_BCLK / MAX_LRC）
 void i2s_tx_init(void);
 
+//? 接管外部创建的TX通道（全双工模式，见 i2s_duplex 组件），代替 i2s_tx_init()
+//? slot固定为32位以与麦克风共用BCLK；此模式下 max98367a_set_dma_config() 返回 ESP_ERR_NOT_SUPPORTED
+//? @param handle 已创建、尚未初始化的TX通道
+//? @param desc_num / frame_num 创建通道时使用的DMA参数
+//? @param bclk / ws 共用的时钟引脚
+//? @param hook 采样率切换后的通知回调，可为NULL
+esp_err_t max98367a_attach(i2s_chan_handle_t handle, uint32_t desc_num, uint32_t frame_num,
+                           gpio_num_t bclk, gpio_num_t ws, max98367a_rate_hook_t hook, void *arg);
+
+//? 选择延迟档位，等同于 max98367a_set_dma_config() 使用档位对应的参数
+esp_err_t max98367a_set_latency_profile(max98367a_latency_profile_t profile);
+
+//? 运行时修改DMA描述符数量和帧数
+//? DMA缓冲区只能在创建通道时分配，因此会删除并重建TX通道（保留当前采样率），未播放完的数据被丢弃
+//? 须与 max98367a_play_clip() 在同一任务中调用
+//? @param desc_num 描述符数量（2 ~ MAX98367A_DMA_DESC_NUM_MAX）
+//? @param frame_num 每个描述符帧数（8 ~ MAX98367A_DMA_FRAME_NUM_MAX）
+//? @return ESP_OK 成功, ESP_ERR_INVALID_ARG 参数超出范围, 其他值为I2S驱动错误
+esp_err_t max98367a_set_dma_config(uint32_t desc_num, uint32_t frame_num);
+
+//? 获取DMA配置、中断/欠载计数和余量
+void max98367a_get_dma_stats(max98367a_dma_stats_t *stats);
+
+//? 清零DMA统计（中断、欠载、最小余量和播放时长）
+void max98367a_reset_dma_stats(void);
+
+//? 设置预填充块数（默认 MAX98367A_PREROLL_BLOCKS），下一段流开始时生效
+void max98367a_set_preroll(uint32_t blocks);
+
+//? 设置低水位回调：播放流中DMA余量降到 blocks 块及以下时调用一次，余量回升后重新武装
+//? @param cb 回调函数，NULL表示关闭
+void max98367a_set_low_watermark(uint32_t blocks, max98367a_low_watermark_cb_t cb, void *arg);
+
+//? 开始/结束一段连续播放流（如网络语音），流内的欠载才会计数，流开始时执行预填充
+//? max98367a_play_clip() 在流外调用时自动把单个片段当作一段流
+void max98367a_stream_begin(void);
+void max98367a_stream_end(void);
+
+//? 写入已是输出格式的数据（不做转换和增益），计入余量统计
+esp_err_t max98367a_write(const void *data, size_t len, size_t *bytes_written, TickType_t timeout);
+
+//? 延迟探针（用于测量）：首样本等于 marker 的DMA块发送完成时记录时间戳
+//? @param marker 非零标记值，0表示关闭探针
+void max98367a_probe_arm(max98367a_sample_t marker);
+
+//? 获取探针触发时间（esp_timer微秒），尚未触发返回0
+int64_t max98367a_probe_time_us(void);
+
+//? 运行时切换输出采样率（不删除通道）
+//? 依次：淡出到静音 -> 等待DMA排空 -> 禁用通道 -> 重配时钟 -> 启用通道，下一次播放时自动淡入
+//? 须与 max98367a_play_clip() 在同一任务中调用
+//? @param sample_rate 新采样率（MAX98367A_MIN_SAMPLE_RATE ~ MAX98367A_MAX_SAMPLE_RATE）
+//? @return ESP_OK 成功, ESP_ERR_INVALID_ARG 采样率超出范围, 其他值为I2S驱动错误
+esp_err_t max98367a_set_sample_rate(uint32_t sample_rate);
+
+//? 获取当前输出采样率（标称值）
+uint32_t max98367a_get_sample_rate(void);
+
+//? 获取实际输出采样率（按时钟分频估算），供抖动缓冲和重采样使用
+double max98367a_get_actual_sample_rate(void);
+
 //? 设置音量增益
 //? @param gain 增益值 (0.0 ~ 5.0)，1.0为原音量
 void max98367a_set_gain(float gain);
@@ -51,9 +243,104 @@ void max98367a_set_gain(float gain);
 //? @return 当前增益值
 float max98367a_get_gain(void);
 
-//? 应用增益到音频数据
-//? @param data 音频数据缓冲区（int32_t数组）
+//? 应用增益到音频数据（按 MAX98367A_BIT_WIDTH 选择 int32 或 int16 内核）
+//? 压缩器启用时，音量、压缩增益和补偿增益合并为一次饱和乘法；饱和只作为最后的保护
+//? 压缩器状态跨块保持，须按播放顺序逐块调用
+//? @param data 音频数据缓冲区（max98367a_sample_t数组）
 //? @param len 数据长度（字节数）
 void max98367a_apply_gain(void *data, size_t len);
 
+//? 设置动态范围压缩参数，参数在此换算，输出路径只做定点运算；运行中修改保留当前增益状态，不产生跳变
+//? @param cfg 压缩参数，NULL表示关闭（恢复为单纯的音量增益）
+void max98367a_set_compressor(const audio_dsp_comp_config_t *cfg);
+
+//? 获取当前压缩参数
+//? @return true 压缩器已启用
+bool max98367a_get_compressor(audio_dsp_comp_config_t *cfg);
+
+//? 当前压缩增益衰减（dB，<= 0），用于电平表或调参
+float max98367a_get_gain_reduction_db(void);
+
+//? 设置参数均衡（扬声器校正），系数在此计算，输出路径逐块应用
+//? 运行中修改时，下一块同时用新旧系数处理并在块内线性交叉淡化，不产生爆音；切换采样率时自动重新计算系数
+//? @param bands 各段参数，按顺序级联
+//? @param count 段数（0 ~ MAX98367A_EQ_MAX_BANDS），0表示旁路
+//? @return ESP_OK 成功, ESP_ERR_INVALID_ARG 段数或频率/Q超出范围
+esp_err_t max98367a_set_eq(const max98367a_eq_band_t *bands, size_t count);
+
+//? 获取当前均衡设置
+//? @return 段数
+size_t max98367a_get_eq(max98367a_eq_band_t *bands, size_t max_count);
+
+//? 应用参数均衡到音频数据（旁路时直接返回）；max98367a_play_clip() 在增益之前自动调用
+//? 滤波器状态跨块保持，须按播放顺序逐块调用
+//? @param data 音频数据缓冲区（max98367a_sample_t数组）
+//? @param len 数据长度（字节数）
+void max98367a_apply_eq(void *data, size_t len);
+
+//? ==================== 样本处理内核（int32 / int16） ====================
+//? 两种位宽的内核都始终编译，可用于格式转换和性能对比
+
+//? 增益：samples[i] = sat(samples[i] * gain)，gain为Q8定点（256 = 1.0）
+void max98367a_gain_s32(int32_t *samples, size_t count, int32_t gain_q8);
+void max98367a_gain_s16(int16_t *samples, size_t count, int32_t gain_q8);
+
+//? 饱和混音：dst[i] = sat(dst[i] + src[i])
+void max98367a_mix_s32(int32_t *dst, const int32_t *src, size_t count);
+void max98367a_mix_s16(int16_t *dst, const int16_t *src, size_t count);
+
+//? 格式转换：32位取高16位 / 16位扩展到32位高位
+void max98367a_s32_to_s16(const int32_t *src, int16_t *dst, size_t count);
+void max98367a_s16_to_s32(const int16_t *src, int32_t *dst, size_t count);
+
+//? 立体声混为单声道：dst[i] = (L + R) / 2
+//? @param src 交错立体声数据
+//? @param dst 单声道输出（可与src相同，原地处理）
+//? @param frames 帧数
+void max98367a_downmix_stereo(const int32_t *src, int32_t *dst, size_t frames);
+void max98367a_downmix_stereo_s16(const int16_t *src, int16_t *dst, size_t frames);
+
+//? 性能测试：对比32位与16位内核每个DMA块的CPU周期数，以及两种模式的DMA内存占用
+void max98367a_benchmark(void);
+
+//? 均衡性能测试：旁路及1、4、8段峰值均衡处理一个DMA块的CPU周期数，结束后恢复原设置
+void max98367a_eq_benchmark(void);
+
+//? 延迟扫描：依次使用一组 desc_num x frame_num 配置输出静音，
+//? 报告中断频率、CPU占用、欠载次数和写入到DMA发送完成的延迟，结束后恢复原配置
+//? 须在优先级高于0的任务中调用（用空闲优先级的空转任务测量CPU占用）
+//? @param duration_ms 每组配置的测量时长
+void max98367a_latency_sweep(uint32_t duration_ms);
+
+//? 播放音频片段（阻塞直到全部数据写入DMA）
+//? 片段指定了 sample_rate 且与当前不同时，先调用 max98367a_set_sample_rate() 切换时钟
+//? 预缩放片段（MAX98367A_CLIP_PRESCALED）直接交给I2S驱动，不经过中间缓冲区和增益计算；
+//? 其余片段按 BUF_SIZE 分块拷贝到内部缓冲区、应用当前增益后写入，同一时间只允许一个任务调用
+//? @param clip 音频片段
+//? @param timeout 每次写入的超时时间（tick）
+//? @return ESP_OK 成功, 其他值表示失败
+esp_err_t max98367a_play_clip(const max98367a_clip_t *clip, TickType_t timeout);
+
+//? 把片段从第 frame 帧起的最多 frames 帧转换为输出格式（位宽转换、立体声混为单声道），不做均衡和增益
+//? 供调度器等在拉模式音源中读取片段；不切换采样率，片段的 sample_rate 由调用者处理
+//? @return 实际转换的帧数，0表示已到片段末尾或格式不支持
+size_t max98367a_clip_read(const max98367a_clip_t *clip, size_t frame, max98367a_sample_t *dst, size_t frames);
+
+//? 拉模式音源回调：向 buf 写入最多 frames 帧输出格式样本（max98367a_sample_t，MAX98367A_CHANNEL_NUM 声道交织）
+//? @return 实际写入的帧数，0表示音源结束
+typedef size_t (*max98367a_source_fn_t)(max98367a_sample_t *buf, size_t frames, void *arg);
+
+//? 在音源回调中调用，标记当前块的片段标志（每块开始时清零）
+//? MAX98367A_CLIP_PRESCALED：本块已含音量，输出时跳过 max98367a_apply_gain()（增益与压缩），均衡和淡入照常
+void max98367a_source_set_flags(uint32_t flags);
+
+//? 播放拉模式音源（如 audio_synth 合成器），阻塞直到音源结束
+//? 每次向音源请求一个DMA块，样本直接生成在内部块缓冲区中，经均衡、增益/压缩和淡入后写入；
+//? 流的第一段同样执行预填充。同一时间只允许一个任务调用（与 max98367a_play_clip() 共用块缓冲区）
+//? @param fn 音源回调
+//? @param arg 回调参数
+//? @param timeout 每次写入的超时时间（tick）
+//? @return ESP_OK 成功, ESP_ERR_INVALID_ARG fn为NULL, 其他值表示写入失败
+esp_err_t max98367a_play_source(max98367a_source_fn_t fn, void *arg, TickType_t timeout);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,297 @@
+#include "MAX98367A.h"
+#include "esp_log.h"
+#include "esp_cpu.h"
+#include "esp_timer.h"
+#include "esp_memory_utils.h"
+#include "sdkconfig.h"
+#include <stdio.h>
+#include <string.h>
+
+#if CONFIG_IDF_TARGET_ESP32S3
+#include "esp32s3/rom/cache.h"
+#define BENCH_HAS_COLD      1
+#else
+#define BENCH_HAS_COLD      0
+#endif
+
+//? 编译优化级别（随 sdkconfig 档位变化）
+#if CONFIG_COMPILER_OPTIMIZATION_PERF
+#define BENCH_OPT_LEVEL     "-O2"
+#elif CONFIG_COMPILER_OPTIMIZATION_SIZE
+#define BENCH_OPT_LEVEL     "-Os"
+#elif CONFIG_COMPILER_OPTIMIZATION_NONE
+#define BENCH_OPT_LEVEL     "-O0"
+#else
+#define BENCH_OPT_LEVEL     "-Og"
+#endif
+
+static const char *TAG = "MAX98367A_BENCH";
+
+//? 每项测试重复次数
+#define BENCH_ITERATIONS    64
+
+//? I2S_CHANNEL_DEFAULT_CONFIG 的默认DMA描述符数量
+#define BENCH_DMA_DESC_NUM  6
+
+//? 测试缓冲区：按一个DMA块的样本数分配
+static int32_t s_buf32[MAX98367A_BLOCK_SAMPLES];
+static int32_t s_src32[MAX98367A_BLOCK_SAMPLES];
+static int16_t s_buf16[MAX98367A_BLOCK_SAMPLES];
+static int16_t s_src16[MAX98367A_BLOCK_SAMPLES];
+
+//? 填充伪随机测试数据（固定种子，结果可复现）
+static void bench_fill(void)
+{
+    uint32_t seed = 0x12345678;
+    for (size_t i = 0; i < MAX98367A_BLOCK_SAMPLES; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        s_buf32[i] = (int32_t)seed >> 2;
+        s_src32[i] = (int32_t)(seed ^ 0x5A5A5A5A) >> 2;
+        s_buf16[i] = (int16_t)(s_buf32[i] >> 16);
+        s_src16[i] = (int16_t)(s_src32[i] >> 16);
+    }
+}
+
+//? 使指令缓存失效：之后第一次调用时Flash中的代码须重新取指，模拟WiFi等占用缓存后的最坏情况
+//? IRAM中的代码不经缓存，不受影响（数据缓存可能有未写回的PSRAM数据，不能失效）
+static void bench_cache_flush(void)
+{
+#if BENCH_HAS_COLD
+    Cache_Invalidate_ICache_All();
+#endif
+}
+
+//? 打印一项结果：稳态每块周期数、占实时处理预算的百分比，以及冷缓存下首块的周期数
+static void bench_report(const char *name, uint32_t total_cycles, uint32_t cold_cycles)
+{
+    uint32_t cycles = total_cycles / BENCH_ITERATIONS;
+    //? 一个DMA块的实时预算 = CPU频率 * 块时长
+    uint32_t budget = (uint32_t)((uint64_t)CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * 1000000ULL * MAX98367A_DMA_FRAME_NUM / MAX98367A_SAMPLE_RATE);
+    ESP_LOGI(TAG, "%-22s %7lu cycles/block  %5.2f%% CPU  cold %7lu", name, (unsigned long)cycles,
+             100.0f * cycles / budget, (unsigned long)cold_cycles);
+}
+
+#define BENCH_RUN(name, stmt) do {                                  \
+    bench_fill();                                                   \
+    bench_cache_flush();                                            \
+    uint32_t start = esp_cpu_get_cycle_count();                     \
+    stmt;                                                           \
+    uint32_t cold = esp_cpu_get_cycle_count() - start;              \
+    start = esp_cpu_get_cycle_count();                              \
+    for (int it = 0; it < BENCH_ITERATIONS; it++) {                 \
+        stmt;                                                       \
+    }                                                               \
+    bench_report(name, esp_cpu_get_cycle_count() - start, cold);    \
+} while (0)
+
+void max98367a_benchmark(void)
+{
+    const size_t n = MAX98367A_BLOCK_SAMPLES;
+    const int32_t gain_q8 = (int32_t)(MAX98367A_DEFAULT_GAIN * 256.0f);
+
+    ESP_LOGI(TAG, "Block: %d frames x %d ch @ %d Hz, CPU %d MHz, %d iterations",
+             MAX98367A_DMA_FRAME_NUM, MAX98367A_CHANNEL_NUM, MAX98367A_SAMPLE_RATE,
+             CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ, BENCH_ITERATIONS);
+    //? "cold" 列为使指令缓存失效后的首块周期数，内核在Flash中时明显高于稳态值
+    ESP_LOGI(TAG, "Build %s, kernels in %s%s", BENCH_OPT_LEVEL,
+             esp_ptr_in_iram((const void *)max98367a_gain_s32) ? "IRAM" : "flash",
+             BENCH_HAS_COLD ? "" : " (cold column not supported on this target)");
+
+    BENCH_RUN("gain s32", max98367a_gain_s32(s_buf32, n, gain_q8));
+    BENCH_RUN("gain s16", max98367a_gain_s16(s_buf16, n, gain_q8));
+    BENCH_RUN("mix s32", max98367a_mix_s32(s_buf32, s_src32, n));
+    BENCH_RUN("mix s16", max98367a_mix_s16(s_buf16, s_src16, n));
+    BENCH_RUN("convert s32->s16", max98367a_s32_to_s16(s_src32, s_buf16, n));
+    BENCH_RUN("convert s16->s32", max98367a_s16_to_s32(s_src16, s_buf32, n));
+    BENCH_RUN("copy s32", memcpy(s_buf32, s_src32, n * sizeof(int32_t)));
+    BENCH_RUN("copy s16", memcpy(s_buf16, s_src16, n * sizeof(int16_t)));
+    
+    //? 压缩器（音量并入压缩增益）与单纯增益对比
+    audio_dsp_comp_config_t comp_cfg = AUDIO_DSP_COMP_CONFIG_DEFAULT();
+    audio_dsp_comp_t comp;
+    const size_t frames = MAX98367A_DMA_FRAME_NUM;
+    audio_dsp_comp_init(&comp, &comp_cfg, MAX98367A_SAMPLE_RATE, MAX98367A_CHANNEL_NUM);
+    audio_dsp_comp_set_input_gain(&comp, MAX98367A_DEFAULT_GAIN);
+    BENCH_RUN("compressor rms s32", audio_dsp_comp_process_s32(&comp, s_buf32, frames));
+    BENCH_RUN("compressor rms s16", audio_dsp_comp_process_s16(&comp, s_buf16, frames));
+    comp_cfg.detect = AUDIO_DSP_DETECT_PEAK;
+    audio_dsp_comp_init(&comp, &comp_cfg, MAX98367A_SAMPLE_RATE, MAX98367A_CHANNEL_NUM);
+    audio_dsp_comp_set_input_gain(&comp, MAX98367A_DEFAULT_GAIN);
+    BENCH_RUN("compressor peak s32", audio_dsp_comp_process_s32(&comp, s_buf32, frames));
+    BENCH_RUN("compressor peak s16", audio_dsp_comp_process_s16(&comp, s_buf16, frames));
+
+    //? 内存与总线对比
+    size_t buf32 = MAX98367A_DMA_FRAME_NUM * MAX98367A_CHANNEL_NUM * 4;
+    size_t buf16 = MAX98367A_DMA_FRAME_NUM * MAX98367A_CHANNEL_NUM * 2;
+    ESP_LOGI(TAG, "32-bit mode: DMA %u x %u B = %u B, BCLK %lu Hz, %lu B/s",
+             BENCH_DMA_DESC_NUM, (unsigned)buf32, (unsigned)(BENCH_DMA_DESC_NUM * buf32),
+             (unsigned long)MAX98367A_SAMPLE_RATE * 2 * 32, (unsigned long)MAX98367A_SAMPLE_RATE * MAX98367A_CHANNEL_NUM * 4);
+    ESP_LOGI(TAG, "16-bit mode: DMA %u x %u B = %u B, BCLK %lu Hz, %lu B/s",
+             BENCH_DMA_DESC_NUM, (unsigned)buf16, (unsigned)(BENCH_DMA_DESC_NUM * buf16),
+             (unsigned long)MAX98367A_SAMPLE_RATE * 2 * 16, (unsigned long)MAX98367A_SAMPLE_RATE * MAX98367A_CHANNEL_NUM * 2);
+    ESP_LOGI(TAG, "Active output mode: %d-bit (BUF_SIZE %d B)", MAX98367A_BIT_WIDTH, BUF_SIZE);
+}
+
+//? ==================== 延迟扫描 ====================
+
+//? 扫描的DMA配置 {desc_num, frame_num}
+static const uint32_t s_sweep_cfgs[][2] = {
+    {2, 64}, {4, 64}, {2, 128}, {4, 128}, {3, 256}, {6, 256}, {4, 511}, {8, 511},
+};
+
+//? 探针标记值：远小于可闻幅度，静音流中不会出现
+#define SWEEP_PROBE_MARKER  0x5A5
+//? 每隔多少块发送一次探针
+#define SWEEP_PROBE_EVERY   8
+
+static max98367a_sample_t s_sweep_buf[MAX98367A_BLOCK_SAMPLES_MAX];
+static volatile bool s_spin_run;
+static volatile uint32_t s_spin_count;
+
+//? 最低优先级空转任务：计数越少说明其他任务占用CPU越多
+static void spin_task(void *arg)
+{
+    while (s_spin_run) {
+        s_spin_count++;
+    }
+    vTaskDelete(NULL);
+}
+
+//? 在当前核上空转 duration_ms，返回计数
+static uint32_t spin_measure(uint32_t duration_ms, void (*work)(uint32_t), uint32_t work_arg)
+{
+    s_spin_count = 0;
+    s_spin_run = true;
+    xTaskCreatePinnedToCore(spin_task, "bench_spin", 2048, NULL, tskIDLE_PRIORITY, NULL, xPortGetCoreID());
+    if (work) {
+        work(work_arg);
+    } else {
+        vTaskDelay(pdMS_TO_TICKS(duration_ms));
+    }
+    uint32_t count = s_spin_count;
+    s_spin_run = false;
+    vTaskDelay(pdMS_TO_TICKS(10));
+    return count;
+}
+
+//? 一轮测量的延迟统计
+static int64_t s_lat_sum_us;
+static int64_t s_lat_max_us;
+static uint32_t s_lat_count;
+
+//? 以静音流持续写入 duration_ms，周期性插入探针块测量写入到发送完成的时间
+static void sweep_feed(uint32_t duration_ms)
+{
+    max98367a_dma_stats_t st;
+    max98367a_get_dma_stats(&st);
+    size_t block_bytes = st.dma_frame_num * MAX98367A_CHANNEL_NUM * sizeof(max98367a_sample_t);
+    size_t bytes_written = 0;
+    int64_t probe_start = 0;
+    int64_t end = esp_timer_get_time() + (int64_t)duration_ms * 1000;
+    
+    s_lat_sum_us = 0;
+    s_lat_max_us = 0;
+    s_lat_count = 0;
+    memset(s_sweep_buf, 0, sizeof(s_sweep_buf));
+    
+    for (uint32_t blk = 0; esp_timer_get_time() < end; blk++) {
+        //? 收集上一个探针结果
+        int64_t done = max98367a_probe_time_us();
+        if (probe_start != 0 && done != 0) {
+            int64_t lat = done - probe_start;
+            s_lat_sum_us += lat;
+            s_lat_max_us = lat > s_lat_max_us ? lat : s_lat_max_us;
+            s_lat_count++;
+            probe_start = 0;
+        }
+        
+        //? 模拟真实播放路径的逐块处理（在写入探针标记之前，避免标记被增益改变）
+        max98367a_apply_gain(s_sweep_buf, block_bytes);
+        bool probe = (probe_start == 0) && (blk % SWEEP_PROBE_EVERY == 0);
+        s_sweep_buf[0] = probe ? SWEEP_PROBE_MARKER : 0;
+        if (probe) {
+            max98367a_probe_arm(SWEEP_PROBE_MARKER);
+            probe_start = esp_timer_get_time();
+        }
+        max98367a_write(s_sweep_buf, block_bytes, &bytes_written, portMAX_DELAY);
+    }
+    max98367a_probe_arm(0);
+}
+
+void max98367a_latency_sweep(uint32_t duration_ms)
+{
+    max98367a_dma_stats_t orig, before, after;
+    max98367a_get_dma_stats(&orig);
+    
+    //? 无负载时的空转计数作为100%空闲基准
+    uint32_t idle_ref = spin_measure(duration_ms, NULL, 0);
+    if (idle_ref == 0) {
+        ESP_LOGE(TAG, "Spin task did not run, call from a task with priority > 0");
+        return;
+    }
+    
+    ESP_LOGI(TAG, "Latency sweep @ %lu Hz, %lu ms per config",
+             (unsigned long)max98367a_get_sample_rate(), (unsigned long)duration_ms);
+    ESP_LOGI(TAG, "desc x frames | buffered ms | IRQ/s | CPU %% | underruns | latency avg/max ms");
+    
+    for (size_t i = 0; i < sizeof(s_sweep_cfgs) / sizeof(s_sweep_cfgs[0]); i++) {
+        if (max98367a_set_dma_config(s_sweep_cfgs[i][0], s_sweep_cfgs[i][1]) != ESP_OK) {
+            continue;
+        }
+        max98367a_get_dma_stats(&before);
+        int64_t t0 = esp_timer_get_time();
+        max98367a_stream_begin();
+        uint32_t spins = spin_measure(duration_ms, sweep_feed, duration_ms);
+        max98367a_stream_end();
+        int64_t elapsed_us = esp_timer_get_time() - t0;
+        max98367a_get_dma_stats(&after);
+        
+        float buffered_ms = 1000.0f * s_sweep_cfgs[i][0] * s_sweep_cfgs[i][1] / max98367a_get_sample_rate();
+        float irq_rate = (after.sent_blocks - before.sent_blocks) * 1e6f / elapsed_us;
+        float cpu = 100.0f * (1.0f - (float)spins / idle_ref);
+        float lat_avg = s_lat_count ? (float)s_lat_sum_us / s_lat_count / 1000.0f : 0.0f;
+        ESP_LOGI(TAG, "%4lu x %-6lu | %11.1f | %5.0f | %5.1f | %9lu | %6.2f / %6.2f",
+                 (unsigned long)s_sweep_cfgs[i][0], (unsigned long)s_sweep_cfgs[i][1], buffered_ms, irq_rate,
+                 cpu < 0.0f ? 0.0f : cpu, (unsigned long)(after.underruns - before.underruns),
+                 lat_avg, s_lat_max_us / 1000.0f);
+    }
+    
+    max98367a_set_dma_config(orig.dma_desc_num, orig.dma_frame_num);
+}
+
+//? ==================== 均衡开销 ====================
+
+void max98367a_eq_benchmark(void)
+{
+    //? 0段即旁路快速路径
+    static const size_t band_counts[] = {0, 1, 4, 8};
+    max98367a_eq_band_t saved[MAX98367A_EQ_MAX_BANDS];
+    size_t saved_count = max98367a_get_eq(saved, MAX98367A_EQ_MAX_BANDS);
+    max98367a_eq_band_t bands[MAX98367A_EQ_MAX_BANDS];
+    const size_t len = MAX98367A_BLOCK_SAMPLES * sizeof(max98367a_sample_t);
+    max98367a_sample_t *buf = (MAX98367A_BIT_WIDTH == 16) ? (max98367a_sample_t *)s_buf16 : (max98367a_sample_t *)s_buf32;
+    
+    ESP_LOGI(TAG, "EQ: %d frames x %d ch, %d-bit", MAX98367A_DMA_FRAME_NUM, MAX98367A_CHANNEL_NUM, MAX98367A_BIT_WIDTH);
+    
+    for (size_t i = 0; i < sizeof(band_counts) / sizeof(band_counts[0]); i++) {
+        size_t n = band_counts[i];
+        //? 峰值段按倍频程分布在 63Hz ~ 8kHz
+        for (size_t b = 0; b < n; b++) {
+            bands[b].type = MAX98367A_EQ_PEAKING;
+            bands[b].freq_hz = 63.0f * (float)(1 << b);
+            bands[b].gain_db = (b & 1) ? -3.0f : 3.0f;
+            bands[b].q = 1.0f;
+        }
+        max98367a_set_eq(bands, n);
+        //? 先处理一块完成交叉淡化，之后测的是稳态开销
+        bench_fill();
+        max98367a_apply_eq(buf, len);
+        
+        char name[24];
+        snprintf(name, sizeof(name), "eq %u band(s)", (unsigned)n);
+        BENCH_RUN(name, max98367a_apply_eq(buf, len));
+    }
+    
+    max98367a_set_eq(saved, saved_count);
+    max98367a_apply_eq(buf, len);
+}
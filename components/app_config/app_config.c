@@ -0,0 +1,473 @@
+#include "app_config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "nvs_flash.h"
+#include "nvs.h"
+
+#include "wifi_sta.h"
+#include "wss_client.h"
+#include "MAX98367A.h"
+#include "INMP441.h"
+
+static const char *TAG = "APP_CONFIG";
+
+//? 默认值：各组件的编译期宏
+static const app_config_t s_defaults = {
+    .wifi_ssid = WIFI_SSID,
+    .wifi_pass = WIFI_PASS,
+    .wifi_max_retry = WIFI_MAX_RETRY,
+    .wss_uri = WSS_URI,
+    .wss_retry_ms = WSS_HANDSHAKE_RETRY_INTERVAL_MS,
+    .wss_reconnect_ms = WSS_RECONNECT_DELAY_MS,
+    .dma_desc_num = MAX98367A_DMA_DESC_NUM,
+    .dma_frame_num = MAX98367A_DMA_FRAME_NUM,
+    .gain = MAX98367A_DEFAULT_GAIN,
+    .noise_gate = INMP441_NOISE_GATE_THRESHOLD,
+};
+
+typedef enum {
+    KEY_INT = 0,
+    KEY_FLOAT,
+    KEY_STR,
+} key_type_t;
+
+//? 键描述：键名同时作为NVS键（不超过15个字符）
+typedef struct {
+    const char *key;
+    key_type_t type;
+    uint16_t offset;
+    uint16_t size;
+    uint32_t group;
+    bool secret;
+    double min;         //? 数值范围；字符串为最小长度
+    double max;
+} key_desc_t;
+
+#define FIELD(f)  offsetof(app_config_t, f), sizeof(((app_config_t *)0)->f)
+
+static const key_desc_t s_keys[] = {
+    {"wifi_ssid",     KEY_STR,   FIELD(wifi_ssid),        APP_CONFIG_WIFI,   false, 1, 0},
+    {"wifi_pass",     KEY_STR,   FIELD(wifi_pass),        APP_CONFIG_WIFI,   true,  0, 0},
+    {"wifi_retry",    KEY_INT,   FIELD(wifi_max_retry),   APP_CONFIG_WIFI,   false, 0, 255},
+    {"wss_uri",       KEY_STR,   FIELD(wss_uri),          APP_CONFIG_WSS,    false, 6, 0},
+    {"wss_retry_ms",  KEY_INT,   FIELD(wss_retry_ms),     APP_CONFIG_WSS,    false, 100, 600000},
+    {"wss_reconn_ms", KEY_INT,   FIELD(wss_reconnect_ms), APP_CONFIG_WSS,    false, 100, 600000},
+    {"dma_desc",      KEY_INT,   FIELD(dma_desc_num),     APP_CONFIG_DMA,    false, 2, MAX98367A_DMA_DESC_NUM_MAX},
+    {"dma_frames",    KEY_INT,   FIELD(dma_frame_num),    APP_CONFIG_DMA,    false, 8, MAX98367A_DMA_FRAME_NUM_MAX},
+    {"gain",          KEY_FLOAT, FIELD(gain),             APP_CONFIG_OUTPUT, false, 0.0, MAX98367A_MAX_GAIN},
+    {"gate",          KEY_INT,   FIELD(noise_gate),       APP_CONFIG_INPUT,  false, 0, INT32_MAX},
+};
+
+#define KEY_COUNT  (sizeof(s_keys) / sizeof(s_keys[0]))
+_Static_assert(KEY_COUNT <= 32, "dirty mask is 32 bits");
+
+typedef struct {
+    app_config_cb_t cb;
+    void *arg;
+    uint32_t groups;
+} subscriber_t;
+
+//? 快照环：写者总是写入当前之后的一格，读者持有的旧快照在环绕之前不会被覆盖
+static app_config_t g_snapshots[APP_CONFIG_SNAPSHOTS];
+static int g_snapshot_index = 0;
+static _Atomic(const app_config_t *) g_current = &s_defaults;
+static atomic_uint_fast32_t g_generation = 0;
+
+static SemaphoreHandle_t g_lock = NULL;        //? 串行化所有写操作和通知
+static uint32_t g_dirty = 0;                    //? 修改后尚未保存的键（按 s_keys 下标）
+static subscriber_t g_subscribers[APP_CONFIG_MAX_SUBSCRIBERS];
+static int g_subscriber_count = 0;
+
+static inline void *field_ptr(app_config_t *cfg, const key_desc_t *k)
+{
+    return (uint8_t *)cfg + k->offset;
+}
+
+static inline const void *field_cptr(const app_config_t *cfg, const key_desc_t *k)
+{
+    return (const uint8_t *)cfg + k->offset;
+}
+
+static const key_desc_t *find_key(const char *key)
+{
+    for (size_t i = 0; i < KEY_COUNT; i++) {
+        if (strcmp(s_keys[i].key, key) == 0) {
+            return &s_keys[i];
+        }
+    }
+    return NULL;
+}
+
+//? 校验值（数值为 int32_t / float，字符串为以0结尾的文本）
+static esp_err_t check_value(const key_desc_t *k, const void *value)
+{
+    switch (k->type) {
+    case KEY_INT: {
+        int32_t v = *(const int32_t *)value;
+        return (v < k->min || v > k->max) ? ESP_ERR_INVALID_ARG : ESP_OK;
+    }
+    case KEY_FLOAT: {
+        float v = *(const float *)value;
+        return (!(v >= k->min) || !(v <= k->max)) ? ESP_ERR_INVALID_ARG : ESP_OK;
+    }
+    case KEY_STR: {
+        size_t len = strnlen((const char *)value, k->size);
+        if (len >= k->size) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        return len < k->min ? ESP_ERR_INVALID_ARG : ESP_OK;
+    }
+    }
+    return ESP_ERR_INVALID_ARG;
+}
+
+//? 按字段格式写入 dst（k->size 字节）
+static void store_field(void *dst, const key_desc_t *k, const void *value)
+{
+    if (k->type == KEY_STR) {
+        //? 长度已由 check_value() 校验，剩余部分清零使快照可按字节比较
+        size_t len = strnlen((const char *)value, k->size - 1);
+        memcpy(dst, value, len);
+        memset((char *)dst + len, 0, k->size - len);
+    } else {
+        memcpy(dst, value, k->size);
+    }
+}
+
+static void write_field(app_config_t *cfg, const key_desc_t *k, const void *value)
+{
+    store_field(field_ptr(cfg, k), k, value);
+}
+
+//? 两个快照之间发生变化的分组
+static uint32_t changed_groups(const app_config_t *a, const app_config_t *b)
+{
+    uint32_t changed = 0;
+    for (size_t i = 0; i < KEY_COUNT; i++) {
+        if (memcmp(field_cptr(a, &s_keys[i]), field_cptr(b, &s_keys[i]), s_keys[i].size) != 0) {
+            changed |= s_keys[i].group;
+        }
+    }
+    return changed;
+}
+
+//? 取下一格快照缓冲（持锁调用）
+static app_config_t *next_snapshot(void)
+{
+    g_snapshot_index = (g_snapshot_index + 1) % APP_CONFIG_SNAPSHOTS;
+    return &g_snapshots[g_snapshot_index];
+}
+
+//? 发布新快照并通知订阅者（持锁调用）
+static void publish(const app_config_t *cfg, uint32_t changed)
+{
+    atomic_store_explicit(&g_current, cfg, memory_order_release);
+    atomic_fetch_add_explicit(&g_generation, 1, memory_order_relaxed);
+    for (int i = 0; i < g_subscriber_count; i++) {
+        uint32_t mask = changed & g_subscribers[i].groups;
+        if (mask) {
+            g_subscribers[i].cb(cfg, mask, g_subscribers[i].arg);
+        }
+    }
+}
+
+//? 修改一个键（value 已是该键的类型）
+static esp_err_t set_value(const char *key, key_type_t type, const void *value)
+{
+    if (g_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    const key_desc_t *k = find_key(key);
+    if (k == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (k->type != type) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t ret = check_value(k, value);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    //? 先在局部变量中生成新值，与当前相同时不占用快照缓冲
+    //? （否则连续的无变化修改会让环转回当前快照，下一次修改将原地改写读者正在使用的快照）
+    union {
+        int32_t i;
+        float f;
+        char s[sizeof(((app_config_t *)0)->wss_uri)];
+    } field;
+    store_field(&field, k, value);
+
+    xSemaphoreTake(g_lock, portMAX_DELAY);
+    const app_config_t *cur = atomic_load_explicit(&g_current, memory_order_relaxed);
+    if (memcmp(field_cptr(cur, k), &field, k->size) != 0) {
+        app_config_t *next = next_snapshot();
+        *next = *cur;
+        memcpy(field_ptr(next, k), &field, k->size);
+        g_dirty |= 1u << (k - s_keys);
+        publish(next, k->group);
+    }
+    xSemaphoreGive(g_lock);
+    return ESP_OK;
+}
+
+esp_err_t app_config_set_int(const char *key, int32_t value)
+{
+    return set_value(key, KEY_INT, &value);
+}
+
+esp_err_t app_config_set_float(const char *key, float value)
+{
+    return set_value(key, KEY_FLOAT, &value);
+}
+
+esp_err_t app_config_set_str(const char *key, const char *value)
+{
+    return set_value(key, KEY_STR, value);
+}
+
+esp_err_t app_config_set_text(const char *key, const char *text)
+{
+    const key_desc_t *k = find_key(key);
+    if (k == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    char *end = NULL;
+    switch (k->type) {
+    case KEY_INT: {
+        long long v = strtoll(text, &end, 10);
+        if (end == text || *end != '\0' || v < INT32_MIN || v > INT32_MAX) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        return app_config_set_int(key, (int32_t)v);
+    }
+    case KEY_FLOAT: {
+        float v = strtof(text, &end);
+        if (end == text || *end != '\0') {
+            return ESP_ERR_INVALID_ARG;
+        }
+        return app_config_set_float(key, v);
+    }
+    case KEY_STR:
+        return app_config_set_str(key, text);
+    }
+    return ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t app_config_get_text(const char *key, char *buf, size_t size)
+{
+    const key_desc_t *k = find_key(key);
+    if (k == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    const app_config_t *cfg = app_config_get();
+    const void *p = field_cptr(cfg, k);
+    int n;
+    if (k->secret) {
+        n = snprintf(buf, size, "***");
+    } else if (k->type == KEY_INT) {
+        n = snprintf(buf, size, "%ld", (long)*(const int32_t *)p);
+    } else if (k->type == KEY_FLOAT) {
+        n = snprintf(buf, size, "%g", (double)*(const float *)p);
+    } else {
+        n = snprintf(buf, size, "%s", (const char *)p);
+    }
+    return (n < 0 || (size_t)n >= size) ? ESP_ERR_INVALID_SIZE : ESP_OK;
+}
+
+const app_config_t *app_config_get(void)
+{
+    return atomic_load_explicit(&g_current, memory_order_acquire);
+}
+
+uint32_t app_config_generation(void)
+{
+    return (uint32_t)atomic_load_explicit(&g_generation, memory_order_relaxed);
+}
+
+//? ==================== NVS ====================
+
+//? 读取一项，不存在或无效时保持默认值
+static bool load_key(nvs_handle_t nvs, const key_desc_t *k, app_config_t *cfg)
+{
+    esp_err_t ret;
+    union {
+        int32_t i;
+        uint32_t u;
+        float f;
+        char s[128];
+    } v;
+    _Static_assert(sizeof(((app_config_t *)0)->wss_uri) <= sizeof(v.s), "string buffer too small");
+
+    switch (k->type) {
+    case KEY_INT:
+        ret = nvs_get_i32(nvs, k->key, &v.i);
+        break;
+    case KEY_FLOAT:
+        //? NVS没有浮点类型，按位存为 u32
+        ret = nvs_get_u32(nvs, k->key, &v.u);
+        break;
+    case KEY_STR: {
+        size_t len = k->size;
+        ret = nvs_get_str(nvs, k->key, v.s, &len);
+        break;
+    }
+    default:
+        return false;
+    }
+    if (ret != ESP_OK) {
+        if (ret != ESP_ERR_NVS_NOT_FOUND) {
+            ESP_LOGW(TAG, "Failed to read %s: %s", k->key, esp_err_to_name(ret));
+        }
+        return false;
+    }
+    if (check_value(k, &v) != ESP_OK) {
+        ESP_LOGW(TAG, "Stored %s out of range, using default", k->key);
+        return false;
+    }
+    write_field(cfg, k, &v);
+    return true;
+}
+
+static esp_err_t save_key(nvs_handle_t nvs, const key_desc_t *k, const app_config_t *cfg)
+{
+    const void *p = field_cptr(cfg, k);
+    switch (k->type) {
+    case KEY_INT:
+        return nvs_set_i32(nvs, k->key, *(const int32_t *)p);
+    case KEY_FLOAT: {
+        uint32_t u;
+        memcpy(&u, p, sizeof(u));
+        return nvs_set_u32(nvs, k->key, u);
+    }
+    case KEY_STR:
+        return nvs_set_str(nvs, k->key, (const char *)p);
+    }
+    return ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t app_config_init(void)
+{
+    if (g_lock != NULL) {
+        return ESP_OK;
+    }
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        ret = nvs_flash_init();
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "NVS init failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    app_config_t *cfg = &g_snapshots[0];
+    *cfg = s_defaults;
+    int loaded = 0;
+    nvs_handle_t nvs;
+    ret = nvs_open(APP_CONFIG_NVS_NAMESPACE, NVS_READONLY, &nvs);
+    if (ret == ESP_OK) {
+        for (size_t i = 0; i < KEY_COUNT; i++) {
+            loaded += load_key(nvs, &s_keys[i], cfg);
+        }
+        nvs_close(nvs);
+    } else if (ret != ESP_ERR_NVS_NOT_FOUND) {
+        ESP_LOGW(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(ret));
+    }
+
+    g_lock = xSemaphoreCreateMutex();
+    if (g_lock == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    g_snapshot_index = 0;
+    atomic_store_explicit(&g_current, cfg, memory_order_release);
+    atomic_fetch_add_explicit(&g_generation, 1, memory_order_relaxed);
+    ESP_LOGI(TAG, "Loaded %d of %d keys from NVS", loaded, (int)KEY_COUNT);
+    return ESP_OK;
+}
+
+esp_err_t app_config_save(void)
+{
+    if (g_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    xSemaphoreTake(g_lock, portMAX_DELAY);
+    esp_err_t ret = ESP_OK;
+    if (g_dirty != 0) {
+        nvs_handle_t nvs;
+        ret = nvs_open(APP_CONFIG_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+        if (ret == ESP_OK) {
+            const app_config_t *cfg = atomic_load_explicit(&g_current, memory_order_relaxed);
+            for (size_t i = 0; i < KEY_COUNT && ret == ESP_OK; i++) {
+                if (g_dirty & (1u << i)) {
+                    ret = save_key(nvs, &s_keys[i], cfg);
+                }
+            }
+            if (ret == ESP_OK) {
+                ret = nvs_commit(nvs);
+            }
+            nvs_close(nvs);
+        }
+        if (ret == ESP_OK) {
+            ESP_LOGI(TAG, "Saved %d keys", __builtin_popcount(g_dirty));
+            g_dirty = 0;
+        } else {
+            ESP_LOGE(TAG, "Save failed: %s", esp_err_to_name(ret));
+        }
+    }
+    xSemaphoreGive(g_lock);
+    return ret;
+}
+
+esp_err_t app_config_reset(void)
+{
+    if (g_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    xSemaphoreTake(g_lock, portMAX_DELAY);
+    nvs_handle_t nvs;
+    esp_err_t ret = nvs_open(APP_CONFIG_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (ret == ESP_OK) {
+        ret = nvs_erase_all(nvs);
+        if (ret == ESP_OK) {
+            ret = nvs_commit(nvs);
+        }
+        nvs_close(nvs);
+    }
+    if (ret == ESP_OK) {
+        const app_config_t *cur = atomic_load_explicit(&g_current, memory_order_relaxed);
+        app_config_t *next = next_snapshot();
+        *next = s_defaults;
+        g_dirty = 0;
+        publish(next, changed_groups(cur, next));
+        ESP_LOGI(TAG, "Restored defaults");
+    } else {
+        ESP_LOGE(TAG, "Reset failed: %s", esp_err_to_name(ret));
+    }
+    xSemaphoreGive(g_lock);
+    return ret;
+}
+
+esp_err_t app_config_subscribe(uint32_t groups, app_config_cb_t cb, void *arg)
+{
+    if (g_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (cb == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    xSemaphoreTake(g_lock, portMAX_DELAY);
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    if (g_subscriber_count < APP_CONFIG_MAX_SUBSCRIBERS) {
+        g_subscribers[g_subscriber_count++] = (subscriber_t){ cb, arg, groups };
+        ret = ESP_OK;
+    }
+    xSemaphoreGive(g_lock);
+    return ret;
+}
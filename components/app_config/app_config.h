@@ -0,0 +1,94 @@
+#ifndef _APP_CONFIG_H_
+#define _APP_CONFIG_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+//? 运行时配置
+//? 各组件的编译期宏（WIFI_SSID、WSS_URI、DMA参数、增益、噪声门限等）作为默认值，
+//? 修改后的值保存在NVS中，重启后自动加载，无需为每台设备重新编译。
+//? 读取无锁：app_config_get() 原子地取当前快照指针，适合在每个DMA块中调用；
+//? 修改时复制一份新快照、校验后原子地替换指针，再按分组通知订阅者。
+
+//? NVS命名空间
+#ifndef APP_CONFIG_NVS_NAMESPACE
+#define APP_CONFIG_NVS_NAMESPACE    "app_config"
+#endif
+
+//? 快照缓冲数：读者取得的快照在此后 APP_CONFIG_SNAPSHOTS-1 次修改内保持有效
+#ifndef APP_CONFIG_SNAPSHOTS
+#define APP_CONFIG_SNAPSHOTS        4
+#endif
+
+//? 订阅者数上限
+#ifndef APP_CONFIG_MAX_SUBSCRIBERS
+#define APP_CONFIG_MAX_SUBSCRIBERS  8
+#endif
+
+//? 配置分组（订阅时按位组合）
+#define APP_CONFIG_WIFI     (1u << 0)   //? WiFi连接参数，重新连接后生效
+#define APP_CONFIG_WSS      (1u << 1)   //? WebSocket地址与重试时间，重启客户端后生效
+#define APP_CONFIG_DMA      (1u << 2)   //? 播放DMA参数，须在播放任务中应用
+#define APP_CONFIG_OUTPUT   (1u << 3)   //? 播放增益，可立即应用
+#define APP_CONFIG_INPUT    (1u << 4)   //? 采集噪声门限，可立即应用
+#define APP_CONFIG_ALL      0x1Fu
+
+//? 配置快照（只读）
+typedef struct {
+    char wifi_ssid[32];         //? "wifi_ssid"
+    char wifi_pass[64];         //? "wifi_pass"（查询时不显示）
+    int32_t wifi_max_retry;     //? "wifi_retry"
+    char wss_uri[128];          //? "wss_uri"
+    int32_t wss_retry_ms;       //? "wss_retry_ms"   握手重试间隔
+    int32_t wss_reconnect_ms;   //? "wss_reconn_ms"  断线后重连等待
+    int32_t dma_desc_num;       //? "dma_desc"
+    int32_t dma_frame_num;      //? "dma_frames"
+    float gain;                 //? "gain"
+    int32_t noise_gate;         //? "gate"
+} app_config_t;
+
+//? 变更回调（在修改配置的任务中调用，按修改顺序串行执行）
+//? 回调中不能再修改配置
+//? @param cfg 新快照
+//? @param changed 发生变化的分组（已与订阅的分组相与）
+typedef void (*app_config_cb_t)(const app_config_t *cfg, uint32_t changed, void *arg);
+
+//? 初始化NVS并加载保存的配置（NVS中没有或超出范围的项使用默认值）
+//? 初始化之前 app_config_get() 返回默认值
+//? @return ESP_OK 成功, ESP_ERR_NO_MEM 互斥锁创建失败, 其他值为NVS错误
+esp_err_t app_config_init(void);
+
+//? 当前快照（无锁）
+//? 指针应在短时间内使用完（如一个DMA块内），不要长期保存
+const app_config_t *app_config_get(void);
+
+//? 配置版本号，每次修改加1，可用于廉价地检测变化
+uint32_t app_config_generation(void);
+
+//? 按键名修改（立即生效并通知订阅者，需调用 app_config_save() 才写入NVS）
+//? 值与当前相同时不通知
+//? @return ESP_OK 成功, ESP_ERR_NOT_FOUND 键名不存在, ESP_ERR_INVALID_ARG 类型不符或超出范围,
+//?         ESP_ERR_INVALID_SIZE 字符串过长, ESP_ERR_INVALID_STATE 未初始化
+esp_err_t app_config_set_int(const char *key, int32_t value);
+esp_err_t app_config_set_float(const char *key, float value);
+esp_err_t app_config_set_str(const char *key, const char *value);
+
+//? 按键名修改，值为文本（按该键的类型解析）
+esp_err_t app_config_set_text(const char *key, const char *text);
+
+//? 按键名读取当前值的文本形式（密码显示为 "***"）
+//? @return ESP_OK 成功, ESP_ERR_NOT_FOUND 键名不存在, ESP_ERR_INVALID_SIZE 缓冲区不足
+esp_err_t app_config_get_text(const char *key, char *buf, size_t size);
+
+//? 将修改过的项写入NVS
+esp_err_t app_config_save(void);
+
+//? 清除NVS中保存的配置并恢复默认值（通知所有发生变化的分组）
+esp_err_t app_config_reset(void);
+
+//? 订阅分组变更
+//? @return ESP_OK 成功, ESP_ERR_NO_MEM 订阅者已满, ESP_ERR_INVALID_STATE 未初始化
+esp_err_t app_config_subscribe(uint32_t groups, app_config_cb_t cb, void *arg);
+
+#endif
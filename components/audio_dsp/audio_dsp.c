@@ -0,0 +1,255 @@
+#include "audio_dsp.h"
+#include <math.h>
+#include <string.h>
+
+#define COEF_ONE        ((double)(1 << AUDIO_DSP_COEF_SHIFT))
+#define FRAC_MASK       (((int64_t)1 << AUDIO_DSP_COEF_SHIFT) - 1)
+
+//? 浮点系数转Q30（饱和到int32，稳定滤波器的系数都在±2以内）
+static int32_t to_q30(double v)
+{
+    double q = v * COEF_ONE;
+    if (q >= 2147483647.0) {
+        return INT32_MAX;
+    } else if (q <= -2147483648.0) {
+        return INT32_MIN;
+    }
+    return (int32_t)lrint(q);
+}
+
+//? 累加结果（Q30）转样本：截断余数留给下一次（误差反馈），整数部分饱和到int32
+static inline int32_t AUDIO_DSP_IRAM_ATTR acc_to_sample(int64_t acc, int64_t *err)
+{
+    int64_t y = acc >> AUDIO_DSP_COEF_SHIFT;
+    *err = acc & FRAC_MASK;
+    if (y > INT32_MAX) {
+        return INT32_MAX;
+    } else if (y < INT32_MIN) {
+        return INT32_MIN;
+    }
+    return (int32_t)y;
+}
+
+//? 左移并饱和，用于补偿设计时对b系数的缩小
+static inline int32_t AUDIO_DSP_IRAM_ATTR shl_sat32(int32_t v, uint8_t shift)
+{
+    int64_t y = (int64_t)v * ((int64_t)1 << shift);
+    if (y > INT32_MAX) {
+        return INT32_MAX;
+    } else if (y < INT32_MIN) {
+        return INT32_MIN;
+    }
+    return (int32_t)y;
+}
+
+//? 按a0归一化写入系数
+//? 稳定滤波器 |a1|<2、|a2|<1，反馈项之和不超过 3*2^61；前馈项之和限制在 4*2^61 以内，
+//? 合计小于int64上限 8*2^61。|b0|+|b1|+|b2| 超过4时把b除以2^shift，输出时再左移补偿
+static void set_coef(audio_dsp_biquad_coef_t *c, double b0, double b1, double b2, double a0, double a1, double a2)
+{
+    b0 /= a0;
+    b1 /= a0;
+    b2 /= a0;
+    uint8_t shift = 0;
+    double sum = fabs(b0) + fabs(b1) + fabs(b2);
+    while (sum > 4.0 && shift < 8) {
+        sum *= 0.5;
+        shift++;
+    }
+    double k = 1.0 / (1 << shift);
+    c->b0 = to_q30(b0 * k);
+    c->b1 = to_q30(b1 * k);
+    c->b2 = to_q30(b2 * k);
+    c->a1 = to_q30(a1 / a0);
+    c->a2 = to_q30(a2 / a0);
+    c->shift = shift;
+}
+
+void audio_dsp_design_highpass(audio_dsp_biquad_coef_t *c, float fc, float q, uint32_t fs)
+{
+    double w0 = 2.0 * M_PI * fc / fs;
+    double cw = cos(w0);
+    double alpha = sin(w0) / (2.0 * q);
+    set_coef(c, (1.0 + cw) / 2.0, -(1.0 + cw), (1.0 + cw) / 2.0, 1.0 + alpha, -2.0 * cw, 1.0 - alpha);
+}
+
+void audio_dsp_design_lowpass(audio_dsp_biquad_coef_t *c, float fc, float q, uint32_t fs)
+{
+    double w0 = 2.0 * M_PI * fc / fs;
+    double cw = cos(w0);
+    double alpha = sin(w0) / (2.0 * q);
+    set_coef(c, (1.0 - cw) / 2.0, 1.0 - cw, (1.0 - cw) / 2.0, 1.0 + alpha, -2.0 * cw, 1.0 - alpha);
+}
+
+void audio_dsp_design_peaking(audio_dsp_biquad_coef_t *c, float fc, float gain_db, float q, uint32_t fs)
+{
+    double a = pow(10.0, gain_db / 40.0);
+    double w0 = 2.0 * M_PI * fc / fs;
+    double cw = cos(w0);
+    double alpha = sin(w0) / (2.0 * q);
+    set_coef(c, 1.0 + alpha * a, -2.0 * cw, 1.0 - alpha * a, 1.0 + alpha / a, -2.0 * cw, 1.0 - alpha / a);
+}
+
+void audio_dsp_design_low_shelf(audio_dsp_biquad_coef_t *c, float fc, float gain_db, float q, uint32_t fs)
+{
+    double a = pow(10.0, gain_db / 40.0);
+    double w0 = 2.0 * M_PI * fc / fs;
+    double cw = cos(w0);
+    double k = 2.0 * sqrt(a) * sin(w0) / (2.0 * q);
+    set_coef(c,
+             a * ((a + 1.0) - (a - 1.0) * cw + k),
+             2.0 * a * ((a - 1.0) - (a + 1.0) * cw),
+             a * ((a + 1.0) - (a - 1.0) * cw - k),
+             (a + 1.0) + (a - 1.0) * cw + k,
+             -2.0 * ((a - 1.0) + (a + 1.0) * cw),
+             (a + 1.0) + (a - 1.0) * cw - k);
+}
+
+void audio_dsp_design_high_shelf(audio_dsp_biquad_coef_t *c, float fc, float gain_db, float q, uint32_t fs)
+{
+    double a = pow(10.0, gain_db / 40.0);
+    double w0 = 2.0 * M_PI * fc / fs;
+    double cw = cos(w0);
+    double k = 2.0 * sqrt(a) * sin(w0) / (2.0 * q);
+    set_coef(c,
+             a * ((a + 1.0) + (a - 1.0) * cw + k),
+             -2.0 * a * ((a - 1.0) + (a + 1.0) * cw),
+             a * ((a + 1.0) + (a - 1.0) * cw - k),
+             (a + 1.0) - (a - 1.0) * cw + k,
+             2.0 * ((a - 1.0) - (a + 1.0) * cw),
+             (a + 1.0) - (a - 1.0) * cw - k);
+}
+
+void audio_dsp_design_bypass(audio_dsp_biquad_coef_t *c)
+{
+    set_coef(c, 1.0, 0.0, 0.0, 1.0, 0.0, 0.0);
+}
+
+//? |H(e^jw)| = |b0 + b1 z^-1 + b2 z^-2| / |1 + a1 z^-1 + a2 z^-2|
+float audio_dsp_biquad_magnitude(const audio_dsp_biquad_coef_t *c, float f, uint32_t fs)
+{
+    double w = 2.0 * M_PI * f / fs;
+    double c1 = cos(w), s1 = sin(w), c2 = cos(2.0 * w), s2 = sin(2.0 * w);
+    double b0 = c->b0 / COEF_ONE, b1 = c->b1 / COEF_ONE, b2 = c->b2 / COEF_ONE;
+    double a1 = c->a1 / COEF_ONE, a2 = c->a2 / COEF_ONE;
+    double nr = b0 + b1 * c1 + b2 * c2, ni = -(b1 * s1 + b2 * s2);
+    double dr = 1.0 + a1 * c1 + a2 * c2, di = -(a1 * s1 + a2 * s2);
+    return (float)(sqrt((nr * nr + ni * ni) / (dr * dr + di * di)) * (1 << c->shift));
+}
+
+void audio_dsp_biquad_reset(audio_dsp_biquad_state_t *s)
+{
+    memset(s, 0, sizeof(*s));
+}
+
+//? 直接I型 + 误差反馈
+//? 状态和系数读到局部变量，内层循环只有5次32x32->64乘加，编译器可全部放在寄存器中
+void AUDIO_DSP_IRAM_ATTR audio_dsp_biquad_process(const audio_dsp_biquad_coef_t *c, audio_dsp_biquad_state_t *s, int32_t *data, size_t count)
+{
+    const int64_t b0 = c->b0, b1 = c->b1, b2 = c->b2, a1 = c->a1, a2 = c->a2;
+    const uint8_t shift = c->shift;
+    int32_t x1 = s->x1, x2 = s->x2, y1 = s->y1, y2 = s->y2;
+    int64_t err = s->err;
+
+    for (size_t i = 0; i < count; i++) {
+        int32_t x0 = data[i];
+        int64_t acc = err + b0 * x0 + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+        int32_t y0 = acc_to_sample(acc, &err);
+        x2 = x1;
+        x1 = x0;
+        y2 = y1;
+        y1 = y0;
+        data[i] = shift ? shl_sat32(y0, shift) : y0;
+    }
+
+    s->x1 = x1;
+    s->x2 = x2;
+    s->y1 = y1;
+    s->y2 = y2;
+    s->err = err;
+}
+
+//? Q15版本：与Q31相同的系数和误差反馈，样本扩展到32位参与运算
+void AUDIO_DSP_IRAM_ATTR audio_dsp_biquad_process_s16(const audio_dsp_biquad_coef_t *c, audio_dsp_biquad_state_t *s, int16_t *data, size_t count)
+{
+    const int64_t b0 = c->b0, b1 = c->b1, b2 = c->b2, a1 = c->a1, a2 = c->a2;
+    const uint8_t shift = c->shift;
+    int32_t x1 = s->x1, x2 = s->x2, y1 = s->y1, y2 = s->y2;
+    int64_t err = s->err;
+
+    for (size_t i = 0; i < count; i++) {
+        int32_t x0 = data[i];
+        int64_t acc = err + b0 * x0 + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+        int32_t y0 = acc_to_sample(acc, &err);
+        if (y0 > INT16_MAX) {
+            y0 = INT16_MAX;
+        } else if (y0 < INT16_MIN) {
+            y0 = INT16_MIN;
+        }
+        x2 = x1;
+        x1 = x0;
+        y2 = y1;
+        y1 = y0;
+        int32_t out = y0 * (1 << shift);
+        data[i] = (int16_t)(out > INT16_MAX ? INT16_MAX : (out < INT16_MIN ? INT16_MIN : out));
+    }
+
+    s->x1 = x1;
+    s->x2 = x2;
+    s->y1 = y1;
+    s->y2 = y2;
+    s->err = err;
+}
+
+void audio_dsp_cascade_init(audio_dsp_biquad_cascade_t *f, uint8_t stages)
+{
+    memset(f, 0, sizeof(*f));
+    f->stages = stages > AUDIO_DSP_BIQUAD_MAX_STAGES ? AUDIO_DSP_BIQUAD_MAX_STAGES : stages;
+}
+
+void audio_dsp_cascade_reset(audio_dsp_biquad_cascade_t *f)
+{
+    memset(f->state, 0, sizeof(f->state));
+}
+
+//? 逐节处理整块（而非逐样本穿过所有节）：每节的系数和状态只加载一次，数据在缓存中连续访问
+void AUDIO_DSP_IRAM_ATTR audio_dsp_cascade_process(audio_dsp_biquad_cascade_t *f, int32_t *data, size_t count)
+{
+    for (uint8_t k = 0; k < f->stages; k++) {
+        audio_dsp_biquad_process(&f->coef[k], &f->state[k], data, count);
+    }
+}
+
+void AUDIO_DSP_IRAM_ATTR audio_dsp_cascade_process_s16(audio_dsp_biquad_cascade_t *f, int16_t *data, size_t count)
+{
+    for (uint8_t k = 0; k < f->stages; k++) {
+        audio_dsp_biquad_process_s16(&f->coef[k], &f->state[k], data, count);
+    }
+}
+
+void audio_dsp_dc_block_init(audio_dsp_dc_block_t *d, float fc, uint32_t fs)
+{
+    memset(d, 0, sizeof(*d));
+    d->r = to_q30(exp(-2.0 * M_PI * fc / fs));
+}
+
+void AUDIO_DSP_IRAM_ATTR audio_dsp_dc_block_process(audio_dsp_dc_block_t *d, int32_t *data, size_t count)
+{
+    const int64_t r = d->r;
+    int32_t x1 = d->x1, y1 = d->y1;
+    int64_t err = d->err;
+
+    for (size_t i = 0; i < count; i++) {
+        int32_t x0 = data[i];
+        //? x0 - x1 可能超出int32，在64位中计算
+        int64_t acc = err + ((int64_t)x0 - x1) * ((int64_t)1 << AUDIO_DSP_COEF_SHIFT) + r * y1;
+        int32_t y0 = acc_to_sample(acc, &err);
+        x1 = x0;
+        y1 = y0;
+        data[i] = y0;
+    }
+
+    d->x1 = x1;
+    d->y1 = y1;
+    d->err = err;
+}
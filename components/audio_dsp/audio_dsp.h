@@ -0,0 +1,282 @@
+#ifndef _AUDIO_DSP_H_
+#define _AUDIO_DSP_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+//? 定点音频DSP基础模块
+//? 样本为左对齐int32（Q31，与INMP441/MAX98367A一致）或int16（Q15），滤波系数为Q30定点，乘加使用64位累加器。
+//? 二阶节采用直接I型并带一阶误差反馈：低截止频率的高通极点非常靠近单位圆，
+//? 直接截断会留下直流偏置和极限环，误差反馈把截断误差推到高频，直流处为零。
+//? 便携实现为纯C，不依赖ESP-IDF，可在主机上编译测试（见 tools/audio_dsp_test.c、tools/audio_dsp_bench.c）
+
+//? 每块都要执行的内核放在IRAM、查找表放在DRAM：不经Flash缓存取指，
+//? WiFi占用缓存时耗时不抖动（播放、采集、混音组件的逐样本循环也使用这两个宏）
+//? 只用于叶子循环：被标记的函数只调用同样被标记的内核，不调用日志、锁、队列或回调；
+//? 处理的数据可能在Flash或PSRAM中，因此这些函数并不能在缓存关闭期间（如ISR中）调用
+//? 编译时定义为空（-DAUDIO_DSP_IRAM_ATTR= -DAUDIO_DSP_DRAM_ATTR=）可放回Flash，用于对比或节省IRAM；主机上为空
+#ifndef AUDIO_DSP_IRAM_ATTR
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#define AUDIO_DSP_IRAM_ATTR     IRAM_ATTR
+#else
+#define AUDIO_DSP_IRAM_ATTR
+#endif
+#endif
+#ifndef AUDIO_DSP_DRAM_ATTR
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#define AUDIO_DSP_DRAM_ATTR     DRAM_ATTR
+#else
+#define AUDIO_DSP_DRAM_ATTR
+#endif
+#endif
+
+//? 级联最大节数
+#ifndef AUDIO_DSP_BIQUAD_MAX_STAGES
+#define AUDIO_DSP_BIQUAD_MAX_STAGES 8
+#endif
+
+//? 系数小数位数
+#define AUDIO_DSP_COEF_SHIFT    30
+
+//? 二阶节系数（Q30，a0已归一化为1）：
+//? y[n] = b0*x[n] + b1*x[n-1] + b2*x[n-2] - a1*y[n-1] - a2*y[n-2]，输出为 y[n] << shift
+//? 提升增益的均衡节 |b| 可能超过Q30的±2范围，设计时把b除以2^shift，保证64位累加不溢出
+typedef struct {
+    int32_t b0, b1, b2;
+    int32_t a1, a2;
+    uint8_t shift;
+} audio_dsp_biquad_coef_t;
+
+//? 二阶节状态
+typedef struct {
+    int32_t x1, x2;
+    int32_t y1, y2;
+    int64_t err;            //? 上一次输出被截断的余数（误差反馈）
+} audio_dsp_biquad_state_t;
+
+//? 二阶节级联
+typedef struct {
+    uint8_t stages;
+    audio_dsp_biquad_coef_t coef[AUDIO_DSP_BIQUAD_MAX_STAGES];
+    audio_dsp_biquad_state_t state[AUDIO_DSP_BIQUAD_MAX_STAGES];
+} audio_dsp_biquad_cascade_t;
+
+//? 一阶直流阻断器：y[n] = x[n] - x[n-1] + R * y[n-1]
+typedef struct {
+    int32_t r;              //? 极点（Q30）
+    int32_t x1;
+    int32_t y1;
+    int64_t err;
+} audio_dsp_dc_block_t;
+
+//? ==================== 系数设计（RBJ Audio EQ Cookbook） ====================
+
+//? 二阶高通
+//? @param fc 截止频率（Hz）
+//? @param q 品质因数（0.7071为巴特沃斯）
+//? @param fs 采样率（Hz）
+void audio_dsp_design_highpass(audio_dsp_biquad_coef_t *c, float fc, float q, uint32_t fs);
+
+//? 二阶低通
+void audio_dsp_design_lowpass(audio_dsp_biquad_coef_t *c, float fc, float q, uint32_t fs);
+
+//? 峰值均衡（钟形），gain_db 为中心频率处的增益
+void audio_dsp_design_peaking(audio_dsp_biquad_coef_t *c, float fc, float gain_db, float q, uint32_t fs);
+
+//? 低频搁架 / 高频搁架，gain_db 为搁架区的增益，q 控制过渡斜率（0.7071为最陡且无过冲）
+void audio_dsp_design_low_shelf(audio_dsp_biquad_coef_t *c, float fc, float gain_db, float q, uint32_t fs);
+void audio_dsp_design_high_shelf(audio_dsp_biquad_coef_t *c, float fc, float gain_db, float q, uint32_t fs);
+
+//? 直通（b0=1），用于占位
+void audio_dsp_design_bypass(audio_dsp_biquad_coef_t *c);
+
+//? 计算二阶节在 f 处的幅度响应（线性），用于校验和打印
+float audio_dsp_biquad_magnitude(const audio_dsp_biquad_coef_t *c, float f, uint32_t fs);
+
+//? ==================== 处理 ====================
+
+//? 清零状态
+void audio_dsp_biquad_reset(audio_dsp_biquad_state_t *s);
+
+//? 单个二阶节原地处理一块数据
+void audio_dsp_biquad_process(const audio_dsp_biquad_coef_t *c, audio_dsp_biquad_state_t *s, int32_t *data, size_t count);
+
+//? 初始化级联（stages 个节，系数随后写入 coef[]），状态清零
+void audio_dsp_cascade_init(audio_dsp_biquad_cascade_t *f, uint8_t stages);
+
+//? 清零级联全部状态（系数不变）
+void audio_dsp_cascade_reset(audio_dsp_biquad_cascade_t *f);
+
+//? 级联原地处理一块数据（逐节处理整块，每节的状态在内层循环中保持在寄存器）
+void audio_dsp_cascade_process(audio_dsp_biquad_cascade_t *f, int32_t *data, size_t count);
+
+//? 初始化直流阻断器
+//? @param fc -3dB频率（Hz），通常5~20Hz
+void audio_dsp_dc_block_init(audio_dsp_dc_block_t *d, float fc, uint32_t fs);
+
+//? 直流阻断原地处理一块数据
+void audio_dsp_dc_block_process(audio_dsp_dc_block_t *d, int32_t *data, size_t count);
+
+//? Q15版本：系数与状态类型与Q31相同，数据为int16
+void audio_dsp_biquad_process_s16(const audio_dsp_biquad_coef_t *c, audio_dsp_biquad_state_t *s, int16_t *data, size_t count);
+void audio_dsp_cascade_process_s16(audio_dsp_biquad_cascade_t *f, int16_t *data, size_t count);
+
+//? ==================== FIR ====================
+
+//? 延迟线长度：每个样本写两份（pos 和 pos+taps），最近 taps 个样本总是连续的，卷积时无需取模
+#define AUDIO_DSP_FIR_DELAY_LEN(taps)   (2 * (taps))
+
+//? Q31 FIR（系数Q31，64位累加）
+//? 系数按时间倒序存放：coef[0] = h[taps-1] ... coef[taps-1] = h[0]（对称的线性相位FIR无需处理）
+typedef struct {
+    const int32_t *coef;
+    int32_t *delay;         //? 延迟线，长度 AUDIO_DSP_FIR_DELAY_LEN(taps)，由调用者分配
+    uint16_t taps;
+    uint16_t pos;
+} audio_dsp_fir_s32_t;
+
+//? Q15 FIR（系数Q15，倒序存放，64位累加，结果四舍五入并饱和）
+//? 不使用 esp-dsp 的 dsps_fird_s16：它在ESP32-S3上要求系数和延迟线16字节对齐、阶数为8的倍数，
+//? 不满足时初始化函数从堆中分配补零的副本（另有舍入缓冲区），须调用 dsps_fird_s16_aexx_free() 释放，
+//? 且系数指针非const、按其SIMD循环的顺序整理；与本模块调用者分配、只读系数、无需释放的接口不符
+typedef struct {
+    const int16_t *coef;
+    int16_t *delay;
+    uint16_t taps;
+    uint16_t pos;
+} audio_dsp_fir_s16_t;
+
+//? 初始化FIR，延迟线清零
+void audio_dsp_fir_init_s32(audio_dsp_fir_s32_t *f, const int32_t *coef, int32_t *delay, uint16_t taps);
+void audio_dsp_fir_init_s16(audio_dsp_fir_s16_t *f, const int16_t *coef, int16_t *delay, uint16_t taps);
+
+//? FIR处理一块数据（in 与 out 可以相同）
+void audio_dsp_fir_s32(audio_dsp_fir_s32_t *f, const int32_t *in, int32_t *out, size_t count);
+void audio_dsp_fir_s16(audio_dsp_fir_s16_t *f, const int16_t *in, int16_t *out, size_t count);
+
+//? ==================== 向量运算 ====================
+//? 除注明外均为饱和运算，dst/out 可与输入相同（原地处理）
+
+//? dst = sat(dst + src)
+void audio_dsp_add_sat_s32(int32_t *dst, const int32_t *src, size_t count);
+void audio_dsp_add_sat_s16(int16_t *dst, const int16_t *src, size_t count);
+
+//? data = sat((data * gain) >> shift)，例如 shift=8 时 gain 为Q8增益
+void audio_dsp_scale_s32(int32_t *data, size_t count, int32_t gain, int shift);
+void audio_dsp_scale_s16(int16_t *data, size_t count, int32_t gain, int shift);
+
+//? out = sat((a * b) >> 31) / sat((a * b) >> 15)，逐元素相乘（窗函数、增益包络）
+void audio_dsp_mul_q31(const int32_t *a, const int32_t *b, int32_t *out, size_t count);
+void audio_dsp_mul_q15(const int16_t *a, const int16_t *b, int16_t *out, size_t count);
+
+//? 点积
+//? Q31：各取高24位相乘累加，返回Q31结果（64位，不会溢出；INMP441数据低8位本就为0）
+int64_t audio_dsp_dot_q31(const int32_t *a, const int32_t *b, size_t count);
+//? Q15：返回 sat(round(sum(a*b) >> 15))，结果与数据地址和长度无关
+//? 不使用 esp-dsp 的 dsps_dotprod_s16：它按 (sum + 0x7fff) >> 15 舍入（向上取整），存入int16时不饱和，
+//? 超出Q15范围的结果会回绕甚至变号；事先判断不会溢出需要再遍历两个输入求峰值，抵消了SIMD的收益
+int16_t audio_dsp_dot_q15(const int16_t *a, const int16_t *b, size_t count);
+
+//? 最大绝对值（INT32_MIN / INT16_MIN 返回 2^31 / 2^15）
+uint32_t audio_dsp_peak_s32(const int32_t *data, size_t count);
+uint32_t audio_dsp_peak_s16(const int16_t *data, size_t count);
+
+//? 均方根（Q31按高24位计算）
+uint32_t audio_dsp_rms_s32(const int32_t *data, size_t count);
+uint32_t audio_dsp_rms_s16(const int16_t *data, size_t count);
+
+//? 交织 / 解交织立体声（frames 为帧数）
+void audio_dsp_interleave_s32(const int32_t *left, const int32_t *right, int32_t *out, size_t frames);
+void audio_dsp_deinterleave_s32(const int32_t *in, int32_t *left, int32_t *right, size_t frames);
+void audio_dsp_interleave_s16(const int16_t *left, const int16_t *right, int16_t *out, size_t frames);
+void audio_dsp_deinterleave_s16(const int16_t *in, int16_t *left, int16_t *right, size_t frames);
+
+//? ==================== 对数 / 指数近似 ====================
+//? 32段查表加线性插值，误差约0.001dB，供动态处理等需要逐块计算dB的场合使用
+
+//? log2(x)，Q16定点（65536 = 1.0）；x为0时返回 -32.0
+int32_t audio_dsp_log2_q16(uint32_t x);
+
+//? 2^(y/65536)，Q16定点；y >= 15.0 时饱和，y < -16.0 时返回0
+uint32_t audio_dsp_exp2_q16(int32_t y);
+
+//? ==================== 动态范围压缩 ====================
+
+//? 压缩器每隔多少帧检测一次电平并更新增益，帧间增益线性插值
+#ifndef AUDIO_DSP_COMP_BLOCK
+#define AUDIO_DSP_COMP_BLOCK    16
+#endif
+
+//? 电平检测方式
+typedef enum {
+    AUDIO_DSP_DETECT_PEAK = 0,      //? 峰值：对瞬态反应快，适合防削波
+    AUDIO_DSP_DETECT_RMS,           //? 均方根：接近响度感知，适合语音平衡
+} audio_dsp_detect_t;
+
+//? 压缩器参数
+typedef struct {
+    audio_dsp_detect_t detect;
+    float threshold_db;             //? 阈值（dBFS）
+    float ratio;                    //? 压缩比（>= 1）
+    float knee_db;                  //? 软拐点宽度（dB），0为硬拐点
+    float attack_ms;                //? 启动时间
+    float release_ms;               //? 释放时间
+    float makeup_db;                //? 补偿增益
+    float rms_ms;                   //? RMS检测的平均时间（仅RMS方式）
+} audio_dsp_comp_config_t;
+
+//? 语音默认值：-20dBFS以上按4:1压缩，再补偿8dB，轻音节抬高、重音峰值压低
+#define AUDIO_DSP_COMP_CONFIG_DEFAULT() {   \
+    .detect = AUDIO_DSP_DETECT_RMS,         \
+    .threshold_db = -20.0f,                 \
+    .ratio = 4.0f,                          \
+    .knee_db = 6.0f,                        \
+    .attack_ms = 5.0f,                      \
+    .release_ms = 150.0f,                   \
+    .makeup_db = 8.0f,                      \
+    .rms_ms = 10.0f,                        \
+}
+
+//? 压缩器状态：参数换算为log2域Q16，运行时只有整数运算
+typedef struct {
+    audio_dsp_detect_t detect;
+    uint8_t channels;               //? 交织声道数，各声道共用一个增益（立体声像不漂移）
+    int32_t threshold;              //? log2 Q16
+    int32_t knee;                   //? log2 Q16
+    int32_t slope;                  //? 1/ratio - 1，Q16（<= 0）
+    int32_t makeup;                 //? log2 Q16
+    int32_t input;                  //? 检测前的输入增益（音量），log2 Q16
+    int32_t attack;                 //? 每个检测块的平滑系数，Q16
+    int32_t release;
+    int32_t rms_coef;
+    int32_t reduction;              //? 平滑后的增益衰减，log2 Q16（<= 0）
+    int64_t mean_sq;                //? RMS检测的均方值（Q30满量程）
+    uint32_t gain;                  //? 上一块结束时的线性增益，Q16
+} audio_dsp_comp_t;
+
+//? 初始化压缩器，状态清零
+//? @param cfg 参数，NULL使用 AUDIO_DSP_COMP_CONFIG_DEFAULT
+//? @param channels 交织声道数
+void audio_dsp_comp_init(audio_dsp_comp_t *c, const audio_dsp_comp_config_t *cfg, uint32_t fs, uint8_t channels);
+
+//? 更新参数（采样率变化或运行中调参），保留当前增益状态，不产生跳变
+void audio_dsp_comp_set_config(audio_dsp_comp_t *c, const audio_dsp_comp_config_t *cfg, uint32_t fs);
+
+//? 设置检测前的线性输入增益（音量），与压缩增益合并为一次乘法
+void audio_dsp_comp_set_input_gain(audio_dsp_comp_t *c, float gain);
+
+//? 原地处理交织数据（frames 为帧数），输出为 sat(x * 输入增益 * 压缩增益 * 补偿增益)
+void audio_dsp_comp_process_s32(audio_dsp_comp_t *c, int32_t *data, size_t frames);
+void audio_dsp_comp_process_s16(audio_dsp_comp_t *c, int16_t *data, size_t frames);
+
+//? 当前增益衰减（dB，<= 0），用于电平表
+float audio_dsp_comp_get_reduction_db(const audio_dsp_comp_t *c);
+
+//? 设备上的性能测试：各内核每块CPU周期数，并与逐样本参考实现对比结果（仅ESP-IDF构建）
+//? @return true 结果一致, false 有内核结果不一致（错误已打印）
+bool audio_dsp_benchmark(void);
+
+#endif
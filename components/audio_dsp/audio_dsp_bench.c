@@ -0,0 +1,173 @@
+#include "audio_dsp.h"
+#include "esp_log.h"
+#include "esp_cpu.h"
+#include "esp_memory_utils.h"
+#include "sdkconfig.h"
+#include <string.h>
+
+#if CONFIG_IDF_TARGET_ESP32S3
+#include "esp32s3/rom/cache.h"
+#define BENCH_HAS_COLD      1
+#else
+#define BENCH_HAS_COLD      0
+#endif
+
+static const char *TAG = "AUDIO_DSP_BENCH";
+
+//? 每项测试重复次数
+#define BENCH_ITERATIONS    64
+
+//? 一个块的样本数（与默认DMA块一致）
+#define BENCH_BLOCK         256
+
+//? FIR阶数
+#define BENCH_FIR_TAPS      32
+
+//? 测试缓冲区：16字节对齐，与DMA缓冲一致
+static int32_t s_a32[BENCH_BLOCK] __attribute__((aligned(16)));
+static int32_t s_b32[BENCH_BLOCK] __attribute__((aligned(16)));
+static int32_t s_out32[2 * BENCH_BLOCK] __attribute__((aligned(16)));
+static int16_t s_a16[BENCH_BLOCK] __attribute__((aligned(16)));
+static int16_t s_b16[BENCH_BLOCK] __attribute__((aligned(16)));
+static int16_t s_out16[2 * BENCH_BLOCK] __attribute__((aligned(16)));
+static int32_t s_fir_coef32[BENCH_FIR_TAPS];
+static int16_t s_fir_coef16[BENCH_FIR_TAPS];
+static int32_t s_fir_delay32[AUDIO_DSP_FIR_DELAY_LEN(BENCH_FIR_TAPS)];
+static int16_t s_fir_delay16[AUDIO_DSP_FIR_DELAY_LEN(BENCH_FIR_TAPS)];
+
+//? 填充伪随机测试数据（固定种子，结果可复现）；16位数据按1/8幅度，使点积结果落在Q15范围内
+static void bench_fill(void)
+{
+    uint32_t seed = 0x12345678;
+    for (size_t i = 0; i < BENCH_BLOCK; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        s_a32[i] = (int32_t)seed >> 1;
+        s_b32[i] = (int32_t)(seed ^ 0x5A5A5A5A) >> 1;
+        s_a16[i] = (int16_t)(s_a32[i] >> 19);
+        s_b16[i] = (int16_t)(s_b32[i] >> 19);
+    }
+    for (size_t k = 0; k < BENCH_FIR_TAPS; k++) {
+        s_fir_coef32[k] = INT32_MAX / BENCH_FIR_TAPS;
+        s_fir_coef16[k] = INT16_MAX / BENCH_FIR_TAPS;
+    }
+}
+
+//? 使指令缓存失效，之后第一次调用时Flash中的代码须重新取指（IRAM中的内核不受影响）
+static void bench_cache_flush(void)
+{
+#if BENCH_HAS_COLD
+    Cache_Invalidate_ICache_All();
+#endif
+}
+
+//? 打印一项结果：每块周期数、占实时处理预算（44.1kHz）的百分比，以及冷缓存下首块的周期数
+static void bench_report(const char *name, uint32_t total_cycles, uint32_t cold_cycles)
+{
+    uint32_t cycles = total_cycles / BENCH_ITERATIONS;
+    uint32_t budget = (uint32_t)((uint64_t)CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * 1000000ULL * BENCH_BLOCK / 44100);
+    ESP_LOGI(TAG, "%-24s %7lu cycles/block  %6.2f cycles/sample  %5.2f%% CPU  cold %7lu",
+             name, (unsigned long)cycles, (float)cycles / BENCH_BLOCK, 100.0f * cycles / budget,
+             (unsigned long)cold_cycles);
+}
+
+#define BENCH_RUN(name, stmt) do {                                  \
+    bench_fill();                                                   \
+    bench_cache_flush();                                            \
+    uint32_t start = esp_cpu_get_cycle_count();                     \
+    stmt;                                                           \
+    uint32_t cold = esp_cpu_get_cycle_count() - start;              \
+    start = esp_cpu_get_cycle_count();                              \
+    for (int it = 0; it < BENCH_ITERATIONS; it++) {                 \
+        stmt;                                                       \
+    }                                                               \
+    bench_report(name, esp_cpu_get_cycle_count() - start, cold);    \
+} while (0)
+
+//? Q15点积的逐样本参考：64位累加、四舍五入、饱和
+static int16_t bench_ref_dot_q15(const int16_t *a, const int16_t *b, size_t count)
+{
+    int64_t acc = 0;
+    for (size_t i = 0; i < count; i++) {
+        acc += (int32_t)a[i] * b[i];
+    }
+    acc = (acc + (1 << 14)) >> 15;
+    return (int16_t)(acc > INT16_MAX ? INT16_MAX : (acc < INT16_MIN ? INT16_MIN : acc));
+}
+
+//? 比较一项结果，不一致时打印错误
+static bool bench_check(const char *name, int32_t got, int32_t expected)
+{
+    if (got != expected) {
+        ESP_LOGE(TAG, "%s check failed: %ld, expected %ld", name, (long)got, (long)expected);
+        return false;
+    }
+    return true;
+}
+
+bool audio_dsp_benchmark(void)
+{
+    const size_t n = BENCH_BLOCK;
+    audio_dsp_biquad_cascade_t hpf;
+    audio_dsp_fir_s32_t fir32;
+    audio_dsp_fir_s16_t fir16;
+    audio_dsp_comp_t comp_peak, comp_rms;
+    audio_dsp_comp_config_t comp_cfg = AUDIO_DSP_COMP_CONFIG_DEFAULT();
+    volatile int64_t sink64;
+    volatile int16_t sink16;
+
+    audio_dsp_cascade_init(&hpf, 2);
+    audio_dsp_design_highpass(&hpf.coef[0], 80.0f, 0.7071f, 44100);
+    audio_dsp_design_lowpass(&hpf.coef[1], 8000.0f, 0.7071f, 44100);
+    audio_dsp_fir_init_s32(&fir32, s_fir_coef32, s_fir_delay32, BENCH_FIR_TAPS);
+    audio_dsp_fir_init_s16(&fir16, s_fir_coef16, s_fir_delay16, BENCH_FIR_TAPS);
+    audio_dsp_comp_init(&comp_rms, &comp_cfg, 44100, 1);
+    comp_cfg.detect = AUDIO_DSP_DETECT_PEAK;
+    audio_dsp_comp_init(&comp_peak, &comp_cfg, 44100, 1);
+
+    ESP_LOGI(TAG, "Block: %d samples, CPU %d MHz, %d iterations",
+             BENCH_BLOCK, CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ, BENCH_ITERATIONS);
+    ESP_LOGI(TAG, "Kernels in %s%s", esp_ptr_in_iram((const void *)audio_dsp_cascade_process) ? "IRAM" : "flash",
+             BENCH_HAS_COLD ? "" : " (cold column not supported on this target)");
+
+    BENCH_RUN("biquad x2 q31", audio_dsp_cascade_process(&hpf, s_a32, n));
+    BENCH_RUN("biquad x2 q15", audio_dsp_cascade_process_s16(&hpf, s_a16, n));
+    BENCH_RUN("fir 32 taps q31", audio_dsp_fir_s32(&fir32, s_a32, s_a32, n));
+    BENCH_RUN("fir 32 taps q15", audio_dsp_fir_s16(&fir16, s_a16, s_a16, n));
+    BENCH_RUN("dot q31", sink64 = audio_dsp_dot_q31(s_a32, s_b32, n));
+    BENCH_RUN("dot q15", sink16 = audio_dsp_dot_q15(s_a16, s_b16, n));
+    BENCH_RUN("add sat s32", audio_dsp_add_sat_s32(s_a32, s_b32, n));
+    BENCH_RUN("add sat s16", audio_dsp_add_sat_s16(s_a16, s_b16, n));
+    BENCH_RUN("scale s32 (q8)", audio_dsp_scale_s32(s_a32, n, 230, 8));
+    BENCH_RUN("scale s16 (q8)", audio_dsp_scale_s16(s_a16, n, 230, 8));
+    BENCH_RUN("mul q31", audio_dsp_mul_q31(s_a32, s_b32, s_out32, n));
+    BENCH_RUN("mul q15", audio_dsp_mul_q15(s_a16, s_b16, s_out16, n));
+    BENCH_RUN("peak s32", sink64 = audio_dsp_peak_s32(s_a32, n));
+    BENCH_RUN("rms s32", sink64 = audio_dsp_rms_s32(s_a32, n));
+    BENCH_RUN("interleave s32", audio_dsp_interleave_s32(s_a32, s_b32, s_out32, n));
+    BENCH_RUN("deinterleave s16", audio_dsp_deinterleave_s16(s_out16, s_a16, s_b16, n));
+    BENCH_RUN("log2 q16 x256", for (size_t i = 0; i < n; i++) { sink64 = audio_dsp_log2_q16((uint32_t)s_a32[i]); });
+    BENCH_RUN("exp2 q16 x256", for (size_t i = 0; i < n; i++) { sink64 = audio_dsp_exp2_q16(s_a32[i] >> 12); });
+    BENCH_RUN("compressor peak s32", audio_dsp_comp_process_s32(&comp_peak, s_a32, n));
+    BENCH_RUN("compressor rms s32", audio_dsp_comp_process_s32(&comp_rms, s_a32, n));
+    BENCH_RUN("compressor peak s16", audio_dsp_comp_process_s16(&comp_peak, s_a16, n));
+    BENCH_RUN("compressor rms s16", audio_dsp_comp_process_s16(&comp_rms, s_a16, n));
+    (void)sink64;
+    (void)sink16;
+
+    //? 结果校验：对齐与非对齐地址、满幅（须饱和而不是回绕）
+    bool ok = true;
+    bench_fill();
+    ok &= bench_check("dot q15", audio_dsp_dot_q15(s_a16, s_b16, n), bench_ref_dot_q15(s_a16, s_b16, n));
+    ok &= bench_check("dot q15 unaligned", audio_dsp_dot_q15(s_a16 + 1, s_b16 + 1, n - 8),
+                      bench_ref_dot_q15(s_a16 + 1, s_b16 + 1, n - 8));
+    for (size_t i = 0; i < n; i++) {
+        s_a16[i] = INT16_MAX;
+        s_b16[i] = (i & 1) ? INT16_MIN : INT16_MAX;
+    }
+    ok &= bench_check("dot q15 full scale", audio_dsp_dot_q15(s_a16, s_a16, n), INT16_MAX);
+    ok &= bench_check("dot q15 full scale neg", audio_dsp_dot_q15(s_a16, s_b16 + 1, n - 1), INT16_MIN);
+    if (ok) {
+        ESP_LOGI(TAG, "Result checks passed");
+    }
+    return ok;
+}
@@ -0,0 +1,233 @@
+#include "audio_dsp.h"
+#include <math.h>
+#include <string.h>
+
+//? 1 dB 对应的 log2 值
+#define DB_PER_LOG2     6.0205999
+
+//? log2(1 + i/32)，Q16
+static const AUDIO_DSP_DRAM_ATTR int32_t s_log2_lut[33] = {
+    0, 2909, 5732, 8473, 11136, 13727, 16248, 18704, 21098, 23433, 25711,
+    27936, 30109, 32234, 34312, 36346, 38336, 40286, 42196, 44068, 45904, 47705,
+    49472, 51207, 52911, 54584, 56229, 57845, 59434, 60997, 62534, 64047, 65536,
+};
+
+//? 2^(i/32)，Q30
+static const AUDIO_DSP_DRAM_ATTR uint32_t s_exp2_lut[33] = {
+    1073741824, 1097253708, 1121280436, 1145833280, 1170923762, 1196563654, 1222764986,
+    1249540052, 1276901417, 1304861917, 1333434672, 1362633090, 1392470869, 1422962010,
+    1454120821, 1485961921, 1518500250, 1551751076, 1585730000, 1620452965, 1655936265,
+    1692196547, 1729250827, 1767116489, 1805811301, 1845353420, 1885761398, 1927054196,
+    1969251188, 2012372174, 2056437387, 2101467502, 2147483648u,
+};
+
+static inline int32_t AUDIO_DSP_IRAM_ATTR sat32(int64_t v)
+{
+    if (v > INT32_MAX) {
+        return INT32_MAX;
+    } else if (v < INT32_MIN) {
+        return INT32_MIN;
+    }
+    return (int32_t)v;
+}
+
+static inline int16_t AUDIO_DSP_IRAM_ATTR sat16(int64_t v)
+{
+    if (v > INT16_MAX) {
+        return INT16_MAX;
+    } else if (v < INT16_MIN) {
+        return INT16_MIN;
+    }
+    return (int16_t)v;
+}
+
+//? ==================== 对数 / 指数近似 ====================
+
+//? 整数部分由前导零计数得到，尾数高5位查表、其后21位线性插值
+int32_t AUDIO_DSP_IRAM_ATTR audio_dsp_log2_q16(uint32_t x)
+{
+    if (x == 0) {
+        return -(32 << 16);
+    }
+    int n = 31 - __builtin_clz(x);
+    uint32_t m = x << (31 - n);
+    uint32_t idx = (m >> 26) & 31;
+    uint32_t frac = (m >> 5) & 0x1FFFFF;
+    int32_t lo = s_log2_lut[idx];
+    int32_t hi = s_log2_lut[idx + 1];
+    return (n << 16) + lo + (int32_t)(((uint64_t)(hi - lo) * frac) >> 21);
+}
+
+//? 小数部分高5位查表、低11位线性插值得到 [1, 2) 的尾数，再按整数部分移位
+uint32_t AUDIO_DSP_IRAM_ATTR audio_dsp_exp2_q16(int32_t y)
+{
+    if (y >= (15 << 16)) {
+        return 0x80000000u;
+    } else if (y < -(16 << 16)) {
+        return 0;
+    }
+    int32_t n = y >> 16;
+    uint32_t f = (uint32_t)y & 0xFFFF;
+    uint32_t idx = f >> 11;
+    uint32_t fr = f & 0x7FF;
+    uint32_t m = s_exp2_lut[idx] + (uint32_t)(((uint64_t)(s_exp2_lut[idx + 1] - s_exp2_lut[idx]) * fr) >> 11);
+    //? m 为Q30，结果为Q16：右移 14-n 位并四舍五入
+    int sh = 14 - n;
+    return (m + ((1u << sh) >> 1)) >> sh;
+}
+
+//? ==================== 动态范围压缩 ====================
+
+static int32_t db_to_q16(float db)
+{
+    return (int32_t)lrint(db / DB_PER_LOG2 * 65536.0);
+}
+
+//? 一阶平滑系数：每个检测块（AUDIO_DSP_COMP_BLOCK 帧）逼近目标的比例
+static int32_t smooth_coef(float ms, uint32_t fs)
+{
+    if (ms <= 0.0f || fs == 0) {
+        return 65536;
+    }
+    double a = 1.0 - exp(-(double)AUDIO_DSP_COMP_BLOCK * 1000.0 / ((double)ms * fs));
+    return (int32_t)lrint(a * 65536.0);
+}
+
+void audio_dsp_comp_init(audio_dsp_comp_t *c, const audio_dsp_comp_config_t *cfg, uint32_t fs, uint8_t channels)
+{
+    memset(c, 0, sizeof(*c));
+    c->channels = channels ? channels : 1;
+    audio_dsp_comp_set_config(c, cfg, fs);
+    //? 从静音状态开始，起始增益即无衰减时的增益
+    c->gain = audio_dsp_exp2_q16(c->makeup + c->input);
+}
+
+void audio_dsp_comp_set_config(audio_dsp_comp_t *c, const audio_dsp_comp_config_t *cfg, uint32_t fs)
+{
+    const audio_dsp_comp_config_t def = AUDIO_DSP_COMP_CONFIG_DEFAULT();
+    if (cfg == NULL) {
+        cfg = &def;
+    }
+    float ratio = cfg->ratio < 1.0f ? 1.0f : cfg->ratio;
+
+    c->detect = cfg->detect;
+    c->threshold = db_to_q16(cfg->threshold_db);
+    c->knee = cfg->knee_db > 0.0f ? db_to_q16(cfg->knee_db) : 0;
+    c->slope = (int32_t)lrint((1.0 / ratio - 1.0) * 65536.0);
+    c->makeup = db_to_q16(cfg->makeup_db);
+    c->attack = smooth_coef(cfg->attack_ms, fs);
+    c->release = smooth_coef(cfg->release_ms, fs);
+    c->rms_coef = smooth_coef(cfg->rms_ms, fs);
+}
+
+void audio_dsp_comp_set_input_gain(audio_dsp_comp_t *c, float gain)
+{
+    c->input = gain > 0.0f ? (int32_t)lrintf(log2f(gain) * 65536.0f) : -(32 << 16);
+}
+
+float audio_dsp_comp_get_reduction_db(const audio_dsp_comp_t *c)
+{
+    return (float)(c->reduction * DB_PER_LOG2 / 65536.0);
+}
+
+//? 静态压缩曲线（软拐点）：输入电平 -> 增益衰减，均为log2 Q16
+static int32_t AUDIO_DSP_IRAM_ATTR gain_computer(const audio_dsp_comp_t *c, int32_t level)
+{
+    int64_t d = (int64_t)level - c->threshold;
+    if (2 * d <= -c->knee) {
+        return 0;
+    }
+    if (2 * d < c->knee) {
+        //? 拐点区内为二次曲线，两端与直线段相切
+        int64_t t = d + c->knee / 2;
+        return (int32_t)((t * t / (2 * c->knee)) * c->slope / 65536);
+    }
+    return (int32_t)(d * c->slope / 65536);
+}
+
+//? 由检测块电平更新平滑后的衰减，返回本块结束时的线性增益（Q16）
+static uint32_t AUDIO_DSP_IRAM_ATTR update_gain(audio_dsp_comp_t *c, int32_t level)
+{
+    int32_t target = gain_computer(c, level + c->input);
+    int32_t k = target < c->reduction ? c->attack : c->release;
+    c->reduction += (int32_t)(((int64_t)(target - c->reduction) * k) / 65536);
+    return audio_dsp_exp2_q16(c->reduction + c->makeup + c->input);
+}
+
+//? RMS检测：块均方值（Q30满量程）经一阶平滑后取对数，log2(rms) = log2(ms) / 2
+static int32_t AUDIO_DSP_IRAM_ATTR rms_level(audio_dsp_comp_t *c, uint64_t mean)
+{
+    c->mean_sq += (((int64_t)mean - c->mean_sq) * c->rms_coef) / 65536;
+    return (audio_dsp_log2_q16((uint32_t)c->mean_sq) - (30 << 16)) / 2;
+}
+
+//? 每 AUDIO_DSP_COMP_BLOCK 帧做一次对数/指数运算，逐样本只有一次乘法和饱和
+void AUDIO_DSP_IRAM_ATTR audio_dsp_comp_process_s32(audio_dsp_comp_t *c, int32_t *data, size_t frames)
+{
+    const size_t ch = c->channels;
+
+    while (frames > 0) {
+        size_t n = frames < AUDIO_DSP_COMP_BLOCK ? frames : AUDIO_DSP_COMP_BLOCK;
+        size_t count = n * ch;
+        int32_t level;
+        if (c->detect == AUDIO_DSP_DETECT_PEAK) {
+            level = audio_dsp_log2_q16(audio_dsp_peak_s32(data, count)) - (31 << 16);
+        } else {
+            //? 取高16位平方，均方值为Q30
+            uint64_t sum = 0;
+            for (size_t i = 0; i < count; i++) {
+                int32_t v = data[i] >> 16;
+                sum += (uint32_t)(v * v);
+            }
+            level = rms_level(c, sum / count);
+        }
+
+        //? 增益在块内从上一块的值线性过渡到本块的值
+        int64_t g = c->gain;
+        uint32_t g_end = update_gain(c, level);
+        int64_t step = ((int64_t)g_end - g) / (int64_t)n;
+        for (size_t f = 0; f < n; f++) {
+            g += step;
+            for (size_t k = 0; k < ch; k++) {
+                data[f * ch + k] = sat32(((int64_t)data[f * ch + k] * g) >> 16);
+            }
+        }
+        c->gain = g_end;
+        data += count;
+        frames -= n;
+    }
+}
+
+void AUDIO_DSP_IRAM_ATTR audio_dsp_comp_process_s16(audio_dsp_comp_t *c, int16_t *data, size_t frames)
+{
+    const size_t ch = c->channels;
+
+    while (frames > 0) {
+        size_t n = frames < AUDIO_DSP_COMP_BLOCK ? frames : AUDIO_DSP_COMP_BLOCK;
+        size_t count = n * ch;
+        int32_t level;
+        if (c->detect == AUDIO_DSP_DETECT_PEAK) {
+            level = audio_dsp_log2_q16(audio_dsp_peak_s16(data, count)) - (15 << 16);
+        } else {
+            uint64_t sum = 0;
+            for (size_t i = 0; i < count; i++) {
+                int32_t v = data[i];
+                sum += (uint32_t)(v * v);
+            }
+            level = rms_level(c, sum / count);
+        }
+
+        int64_t g = c->gain;
+        uint32_t g_end = update_gain(c, level);
+        int64_t step = ((int64_t)g_end - g) / (int64_t)n;
+        for (size_t f = 0; f < n; f++) {
+            g += step;
+            for (size_t k = 0; k < ch; k++) {
+                data[f * ch + k] = sat16(((int64_t)data[f * ch + k] * g) >> 16);
+            }
+        }
+        c->gain = g_end;
+        data += count;
+        frames -= n;
+    }
+}
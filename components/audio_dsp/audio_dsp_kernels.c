@@ -0,0 +1,231 @@
+#include "audio_dsp.h"
+#include <math.h>
+#include <string.h>
+
+static inline int32_t AUDIO_DSP_IRAM_ATTR sat32(int64_t v)
+{
+    if (v > INT32_MAX) {
+        return INT32_MAX;
+    } else if (v < INT32_MIN) {
+        return INT32_MIN;
+    }
+    return (int32_t)v;
+}
+
+static inline int16_t AUDIO_DSP_IRAM_ATTR sat16(int64_t v)
+{
+    if (v > INT16_MAX) {
+        return INT16_MAX;
+    } else if (v < INT16_MIN) {
+        return INT16_MIN;
+    }
+    return (int16_t)v;
+}
+
+//? ==================== FIR ====================
+
+void audio_dsp_fir_init_s32(audio_dsp_fir_s32_t *f, const int32_t *coef, int32_t *delay, uint16_t taps)
+{
+    f->coef = coef;
+    f->delay = delay;
+    f->taps = taps;
+    f->pos = 0;
+    memset(delay, 0, AUDIO_DSP_FIR_DELAY_LEN(taps) * sizeof(int32_t));
+}
+
+void audio_dsp_fir_init_s16(audio_dsp_fir_s16_t *f, const int16_t *coef, int16_t *delay, uint16_t taps)
+{
+    f->coef = coef;
+    f->delay = delay;
+    f->taps = taps;
+    f->pos = 0;
+    memset(delay, 0, AUDIO_DSP_FIR_DELAY_LEN(taps) * sizeof(int16_t));
+}
+
+//? 新样本写到 pos 和 pos+taps 两处后，delay[pos+1 .. pos+taps] 就是按时间从旧到新的最近 taps 个样本
+void audio_dsp_fir_s32(audio_dsp_fir_s32_t *f, const int32_t *in, int32_t *out, size_t count)
+{
+    const int32_t *coef = f->coef;
+    const uint16_t taps = f->taps;
+    uint16_t pos = f->pos;
+
+    for (size_t i = 0; i < count; i++) {
+        f->delay[pos] = in[i];
+        f->delay[pos + taps] = in[i];
+        pos = (pos + 1 == taps) ? 0 : pos + 1;
+        const int32_t *x = &f->delay[pos];
+        int64_t acc = (int64_t)1 << 30;
+        for (uint16_t k = 0; k < taps; k++) {
+            acc += (int64_t)coef[k] * x[k];
+        }
+        out[i] = sat32(acc >> 31);
+    }
+    f->pos = pos;
+}
+
+//? 便携实现（不用 dsps_fird_s16 的原因见 audio_dsp.h）
+void audio_dsp_fir_s16(audio_dsp_fir_s16_t *f, const int16_t *in, int16_t *out, size_t count)
+{
+    const int16_t *coef = f->coef;
+    const uint16_t taps = f->taps;
+    uint16_t pos = f->pos;
+
+    for (size_t i = 0; i < count; i++) {
+        f->delay[pos] = in[i];
+        f->delay[pos + taps] = in[i];
+        pos = (pos + 1 == taps) ? 0 : pos + 1;
+        const int16_t *x = &f->delay[pos];
+        //? 每个乘积不超过2^30，32位累加器在taps较多时可能溢出，用64位
+        int64_t acc = 1 << 14;
+        for (uint16_t k = 0; k < taps; k++) {
+            acc += (int32_t)coef[k] * x[k];
+        }
+        out[i] = sat16(acc >> 15);
+    }
+    f->pos = pos;
+}
+
+//? ==================== 向量运算 ====================
+
+void AUDIO_DSP_IRAM_ATTR audio_dsp_add_sat_s32(int32_t *dst, const int32_t *src, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        int32_t r;
+        //? 只有同号相加才会溢出，溢出方向与src同号
+        if (__builtin_add_overflow(dst[i], src[i], &r)) {
+            r = src[i] > 0 ? INT32_MAX : INT32_MIN;
+        }
+        dst[i] = r;
+    }
+}
+
+void AUDIO_DSP_IRAM_ATTR audio_dsp_add_sat_s16(int16_t *dst, const int16_t *src, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = sat16((int32_t)dst[i] + src[i]);
+    }
+}
+
+void AUDIO_DSP_IRAM_ATTR audio_dsp_scale_s32(int32_t *data, size_t count, int32_t gain, int shift)
+{
+    for (size_t i = 0; i < count; i++) {
+        data[i] = sat32(((int64_t)data[i] * gain) >> shift);
+    }
+}
+
+void AUDIO_DSP_IRAM_ATTR audio_dsp_scale_s16(int16_t *data, size_t count, int32_t gain, int shift)
+{
+    for (size_t i = 0; i < count; i++) {
+        data[i] = sat16(((int64_t)data[i] * gain) >> shift);
+    }
+}
+
+void audio_dsp_mul_q31(const int32_t *a, const int32_t *b, int32_t *out, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        out[i] = sat32(((int64_t)a[i] * b[i]) >> 31);
+    }
+}
+
+void audio_dsp_mul_q15(const int16_t *a, const int16_t *b, int16_t *out, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        out[i] = sat16(((int32_t)a[i] * b[i]) >> 15);
+    }
+}
+
+//? 取高24位后乘积不超过2^46，累加2^17个样本也不会溢出
+int64_t audio_dsp_dot_q31(const int32_t *a, const int32_t *b, size_t count)
+{
+    int64_t acc = 0;
+    for (size_t i = 0; i < count; i++) {
+        acc += (int64_t)(a[i] >> 8) * (b[i] >> 8);
+    }
+    return acc >> 15;
+}
+
+int16_t audio_dsp_dot_q15(const int16_t *a, const int16_t *b, size_t count)
+{
+    int64_t acc = 1 << 14;
+    for (size_t i = 0; i < count; i++) {
+        acc += (int32_t)a[i] * b[i];
+    }
+    return sat16(acc >> 15);
+}
+
+uint32_t AUDIO_DSP_IRAM_ATTR audio_dsp_peak_s32(const int32_t *data, size_t count)
+{
+    uint32_t peak = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t v = data[i] < 0 ? 0u - (uint32_t)data[i] : (uint32_t)data[i];
+        peak = v > peak ? v : peak;
+    }
+    return peak;
+}
+
+uint32_t AUDIO_DSP_IRAM_ATTR audio_dsp_peak_s16(const int16_t *data, size_t count)
+{
+    uint32_t peak = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t v = (uint32_t)(data[i] < 0 ? -(int32_t)data[i] : data[i]);
+        peak = v > peak ? v : peak;
+    }
+    return peak;
+}
+
+uint32_t audio_dsp_rms_s32(const int32_t *data, size_t count)
+{
+    if (count == 0) {
+        return 0;
+    }
+    uint64_t acc = 0;
+    for (size_t i = 0; i < count; i++) {
+        int32_t v = data[i] >> 8;
+        acc += (uint64_t)((int64_t)v * v);
+    }
+    return (uint32_t)(sqrt((double)acc / count) * 256.0);
+}
+
+uint32_t audio_dsp_rms_s16(const int16_t *data, size_t count)
+{
+    if (count == 0) {
+        return 0;
+    }
+    uint64_t acc = 0;
+    for (size_t i = 0; i < count; i++) {
+        acc += (uint32_t)((int32_t)data[i] * data[i]);
+    }
+    return (uint32_t)sqrt((double)acc / count);
+}
+
+void AUDIO_DSP_IRAM_ATTR audio_dsp_interleave_s32(const int32_t *left, const int32_t *right, int32_t *out, size_t frames)
+{
+    for (size_t i = 0; i < frames; i++) {
+        out[2 * i] = left[i];
+        out[2 * i + 1] = right[i];
+    }
+}
+
+void AUDIO_DSP_IRAM_ATTR audio_dsp_deinterleave_s32(const int32_t *in, int32_t *left, int32_t *right, size_t frames)
+{
+    for (size_t i = 0; i < frames; i++) {
+        left[i] = in[2 * i];
+        right[i] = in[2 * i + 1];
+    }
+}
+
+void AUDIO_DSP_IRAM_ATTR audio_dsp_interleave_s16(const int16_t *left, const int16_t *right, int16_t *out, size_t frames)
+{
+    for (size_t i = 0; i < frames; i++) {
+        out[2 * i] = left[i];
+        out[2 * i + 1] = right[i];
+    }
+}
+
+void AUDIO_DSP_IRAM_ATTR audio_dsp_deinterleave_s16(const int16_t *in, int16_t *left, int16_t *right, size_t frames)
+{
+    for (size_t i = 0; i < frames; i++) {
+        left[i] = in[2 * i];
+        right[i] = in[2 * i + 1];
+    }
+}
@@ -0,0 +1,162 @@
+#include "audio_pack.h"
+#include <string.h>
+
+//? 16位量化步长在32位样本中的大小
+#define S16_LSB     65536
+
+void audio_pack_dither_init(audio_pack_dither_t *d, uint32_t seed)
+{
+    d->seed = seed ? seed : 0x2545F491u;
+}
+
+//? xorshift32，每个样本两次调用即可得到TPDF抖动
+static inline uint32_t dither_next(audio_pack_dither_t *d)
+{
+    uint32_t x = d->seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    d->seed = x;
+    return x;
+}
+
+size_t audio_pack_bytes(audio_pack_format_t format, size_t count)
+{
+    switch (format) {
+    case AUDIO_PACK_S24:
+        return count * 3;
+    case AUDIO_PACK_S16:
+        return count * 2;
+    default:
+        return count * 4;
+    }
+}
+
+size_t audio_pack_samples(audio_pack_format_t format, size_t bytes)
+{
+    switch (format) {
+    case AUDIO_PACK_S24:
+        return bytes / 3;
+    case AUDIO_PACK_S16:
+        return bytes / 2;
+    default:
+        return bytes / 4;
+    }
+}
+
+//? 32位 -> 24位紧凑
+//? 每4个样本合成3个32位字一次写出，避免逐字节存储（Xtensa上逐字节写是主要开销）：
+//?   w0 = a0 a1 a2 b0 | w1 = b1 b2 c0 c1 | w2 = c2 d0 d1 d2（字节序从低到高，小端）
+//? dst 不保证4字节对齐：经 memcpy 写出，对齐时编译为一次字存储，且不违反严格别名规则
+size_t audio_pack_s32_to_s24(const int32_t *src, uint8_t *dst, size_t count)
+{
+    uint8_t *p = dst;
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        uint32_t a = (uint32_t)src[i] >> 8;
+        uint32_t b = (uint32_t)src[i + 1] >> 8;
+        uint32_t c = (uint32_t)src[i + 2] >> 8;
+        uint32_t d = (uint32_t)src[i + 3] >> 8;
+        uint32_t w[3] = {
+            a | (b << 24),
+            (b >> 8) | (c << 16),
+            (c >> 16) | (d << 8),
+        };
+        memcpy(p, w, sizeof(w));
+        p += sizeof(w);
+    }
+
+    //? 尾部不足4个样本逐字节写
+    for (; i < count; i++) {
+        uint32_t v = (uint32_t)src[i] >> 8;
+        *p++ = (uint8_t)v;
+        *p++ = (uint8_t)(v >> 8);
+        *p++ = (uint8_t)(v >> 16);
+    }
+    return count * 3;
+}
+
+//? 24位紧凑 -> 32位
+void audio_unpack_s24_to_s32(const uint8_t *src, int32_t *dst, size_t count)
+{
+    const uint8_t *p = src;
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        uint32_t w[3];
+        memcpy(w, p, sizeof(w));
+        dst[i] = (int32_t)(w[0] << 8);
+        dst[i + 1] = (int32_t)(((w[0] >> 24) << 8) | (w[1] << 16));
+        dst[i + 2] = (int32_t)(((w[1] >> 16) << 8) | (w[2] << 24));
+        dst[i + 3] = (int32_t)(w[2] & 0xFFFFFF00u);
+        p += sizeof(w);
+    }
+
+    for (; i < count; i++, p += 3) {
+        dst[i] = (int32_t)(((uint32_t)p[0] << 8) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 24));
+    }
+}
+
+//? 32位 -> 16位
+size_t audio_pack_s32_to_s16(const int32_t *src, int16_t *dst, size_t count, audio_pack_dither_t *dither)
+{
+    if (dither == NULL) {
+        //? 四舍五入：加上被舍去部分的最高位；只有正满幅附近会进位溢出
+        for (size_t i = 0; i < count; i++) {
+            int32_t y = (src[i] >> 16) + ((src[i] >> 15) & 1);
+            dst[i] = (int16_t)(y > INT16_MAX ? INT16_MAX : y);
+        }
+        return count * 2;
+    }
+
+    //? TPDF抖动：两个均匀分布之和，幅度±1个16位LSB，把量化误差变成与信号无关的白噪声
+    for (size_t i = 0; i < count; i++) {
+        int32_t r = (int32_t)(dither_next(dither) & (S16_LSB - 1)) - (int32_t)(dither_next(dither) & (S16_LSB - 1));
+        int32_t offset = r + S16_LSB / 2;
+        int32_t x;
+        if (__builtin_add_overflow(src[i], offset, &x)) {
+            x = offset > 0 ? INT32_MAX : INT32_MIN;
+        }
+        dst[i] = (int16_t)(x >> 16);
+    }
+    return count * 2;
+}
+
+//? 16位 -> 32位
+void audio_unpack_s16_to_s32(const int16_t *src, int32_t *dst, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = (int32_t)((uint32_t)(uint16_t)src[i] << 16);
+    }
+}
+
+size_t audio_pack(audio_pack_format_t format, const int32_t *src, void *dst, size_t count, audio_pack_dither_t *dither)
+{
+    switch (format) {
+    case AUDIO_PACK_S24:
+        return audio_pack_s32_to_s24(src, (uint8_t *)dst, count);
+    case AUDIO_PACK_S16:
+        return audio_pack_s32_to_s16(src, (int16_t *)dst, count, dither);
+    default:
+        memcpy(dst, src, count * sizeof(int32_t));
+        return count * sizeof(int32_t);
+    }
+}
+
+size_t audio_unpack(audio_pack_format_t format, const void *src, size_t bytes, int32_t *dst)
+{
+    size_t count = audio_pack_samples(format, bytes);
+    switch (format) {
+    case AUDIO_PACK_S24:
+        audio_unpack_s24_to_s32((const uint8_t *)src, dst, count);
+        break;
+    case AUDIO_PACK_S16:
+        audio_unpack_s16_to_s32((const int16_t *)src, dst, count);
+        break;
+    default:
+        memcpy(dst, src, count * sizeof(int32_t));
+        break;
+    }
+    return count;
+}
@@ -0,0 +1,61 @@
+#ifndef _AUDIO_PACK_H_
+#define _AUDIO_PACK_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+//? 采集数据紧凑打包
+//? INMP441输出24位数据，左对齐放在32位slot中（低8位为0），直接发送32位字有1/4的字节是无效的。
+//? 本模块把32位样本打包为：
+//?   - 24位紧凑格式：每4个样本3个字（小端，12字节），负载减少25%，与32位可无损互转
+//?   - 16位格式：取高16位并四舍五入，可选TPDF抖动，负载减少50%
+//? 以及播放侧的反向解包（输出左对齐的32位样本，可直接交给 MAX98367A）
+//? 纯C实现，不依赖ESP-IDF，可在主机上编译测试（见 tools/audio_pack_test.c）
+
+//? 打包格式
+typedef enum {
+    AUDIO_PACK_S32 = 0,     //? 原始32位（不打包）
+    AUDIO_PACK_S24,         //? 24位紧凑小端
+    AUDIO_PACK_S16,         //? 16位小端
+} audio_pack_format_t;
+
+//? TPDF抖动状态（由调用者分配，每路音频一个）
+typedef struct {
+    uint32_t seed;
+} audio_pack_dither_t;
+
+//? 初始化抖动状态
+void audio_pack_dither_init(audio_pack_dither_t *d, uint32_t seed);
+
+//? 计算 count 个样本按指定格式打包后的字节数
+size_t audio_pack_bytes(audio_pack_format_t format, size_t count);
+
+//? 计算 bytes 字节的打包数据包含的样本数（不足一个样本的尾部字节忽略）
+size_t audio_pack_samples(audio_pack_format_t format, size_t bytes);
+
+//? 32位 -> 24位紧凑：保留每个样本的高24位
+//? @param dst 输出缓冲区，任意对齐，容量不小于 audio_pack_bytes(AUDIO_PACK_S24, count)
+//? @return 写入的字节数
+size_t audio_pack_s32_to_s24(const int32_t *src, uint8_t *dst, size_t count);
+
+//? 24位紧凑 -> 32位（左对齐，低8位为0）
+//? @param src 输入缓冲区，任意对齐
+void audio_unpack_s24_to_s32(const uint8_t *src, int32_t *dst, size_t count);
+
+//? 32位 -> 16位：四舍五入并饱和
+//? @param dither 抖动状态，NULL表示不加抖动（此时高16位以外全为0的样本可无损往返）
+//? @return 写入的字节数
+size_t audio_pack_s32_to_s16(const int32_t *src, int16_t *dst, size_t count, audio_pack_dither_t *dither);
+
+//? 16位 -> 32位（左对齐）
+void audio_unpack_s16_to_s32(const int16_t *src, int32_t *dst, size_t count);
+
+//? 按格式打包（AUDIO_PACK_S32 时直接拷贝）
+//? @return 写入的字节数
+size_t audio_pack(audio_pack_format_t format, const int32_t *src, void *dst, size_t count, audio_pack_dither_t *dither);
+
+//? 按格式解包 bytes 字节的数据
+//? @return 输出的样本数
+size_t audio_unpack(audio_pack_format_t format, const void *src, size_t bytes, int32_t *dst);
+
+#endif
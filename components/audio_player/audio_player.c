@@ -0,0 +1,596 @@
+#include "audio_player.h"
+#include <string.h>
+#include <math.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+static const char *TAG = "AUDIO_PLAYER";
+
+#define UNITY_Q16   65536
+
+//? 命令
+typedef enum {
+    CMD_PLAY = 0,
+    CMD_STOP,
+    CMD_RATE,
+} cmd_type_t;
+
+typedef struct {
+    cmd_type_t type;
+    audio_player_mode_t mode;
+    uint8_t priority;
+    bool direct;            //? 由命令直接开始（空闲、抢占、压低），计入延迟统计
+    uint16_t id;
+    uint32_t token;         //? CMD_RATE 时为采样率
+    int64_t t_us;           //? 发出命令的时刻
+} player_cmd_t;
+
+//? 发声中的声音
+typedef struct {
+    bool active;
+    bool fading;            //? 被中断，淡出到0后结束
+    player_cmd_t cmd;
+    size_t pos;             //? 片段已读帧数
+    int32_t gain;           //? 当前增益，Q16
+    int32_t target;         //? 目标增益，Q16
+    bool prescaled;         //? 预缩放片段：数据已含音量，不再乘以当前音量
+} player_voice_t;
+
+//? 登记表
+static audio_player_sound_t g_sounds[AUDIO_PLAYER_MAX_SOUNDS];
+
+//? 命令队列与等待列表（按优先级从高到低，同优先级按到达顺序）
+static QueueHandle_t g_cmd_queue = NULL;
+static player_cmd_t g_pending[AUDIO_PLAYER_PENDING_MAX];
+static size_t g_pending_count = 0;
+
+//? 发声中的声音：g_fg 为当前声音，g_bg 为被压低的声音，其余为淡出中的声音
+static player_voice_t g_voices[AUDIO_PLAYER_VOICES];
+static int g_fg = -1;
+static int g_bg = -1;
+static int32_t g_duck_q16 = 0;
+static int32_t g_ramp_step = UNITY_Q16;     //? 每帧增益变化量，Q16
+static uint32_t g_rate_request = 0;         //? 待切换的采样率，0表示没有
+//? 当前块中普通声音的音量，Q16：块内有预缩放片段时由调度器乘上当前音量并跳过输出级增益，否则为1
+static int32_t g_block_volume = UNITY_Q16;
+static bool g_block_prescaled = false;
+
+//? 非当前声音的生成缓冲区
+static max98367a_sample_t g_mix_buffer[MAX98367A_BLOCK_SAMPLES_MAX];
+
+static audio_player_event_cb_t g_event_cb = NULL;
+static void *g_event_arg = NULL;
+static volatile bool g_busy = false;
+static uint32_t g_next_token = 0;
+static portMUX_TYPE g_token_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static audio_player_stats_t g_stats;
+static uint64_t g_latency_sum = 0;
+
+static void notify(audio_player_event_t event, const player_cmd_t *cmd)
+{
+    switch (event) {
+    case AUDIO_PLAYER_EVT_START:
+        g_stats.started++;
+        break;
+    case AUDIO_PLAYER_EVT_END:
+        g_stats.finished++;
+        break;
+    case AUDIO_PLAYER_EVT_INTERRUPTED:
+        g_stats.interrupted++;
+        break;
+    case AUDIO_PLAYER_EVT_DROPPED:
+        g_stats.dropped++;
+        break;
+    }
+    if (g_event_cb != NULL) {
+        g_event_cb(event, cmd->id, cmd->token, g_event_arg);
+    }
+}
+
+//? 声音需要的采样率与当前输出不同（只有片段指定采样率）
+static bool needs_rate_switch(const player_cmd_t *cmd)
+{
+    const max98367a_clip_t *clip = g_sounds[cmd->id].clip;
+    return clip != NULL && clip->sample_rate != 0 && clip->sample_rate != max98367a_get_sample_rate();
+}
+
+static bool any_active(void)
+{
+    for (int i = 0; i < AUDIO_PLAYER_VOICES; i++) {
+        if (g_voices[i].active) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//? ==================== 等待列表 ====================
+
+static void pending_remove(size_t idx)
+{
+    memmove(&g_pending[idx], &g_pending[idx + 1], (g_pending_count - idx - 1) * sizeof(player_cmd_t));
+    g_pending_count--;
+}
+
+//? 按优先级插入；列表已满时丢弃优先级最低（同优先级中最晚到达）的一项，可能就是新命令
+//? front 为true时插到最前（立即开始的命令）
+static void pending_insert(const player_cmd_t *cmd, bool front)
+{
+    if (g_pending_count == AUDIO_PLAYER_PENDING_MAX) {
+        player_cmd_t *last = &g_pending[g_pending_count - 1];
+        if (!front && last->priority >= cmd->priority) {
+            notify(AUDIO_PLAYER_EVT_DROPPED, cmd);
+            return;
+        }
+        notify(AUDIO_PLAYER_EVT_DROPPED, last);
+        g_pending_count--;
+    }
+
+    size_t pos = 0;
+    if (!front) {
+        while (pos < g_pending_count && g_pending[pos].priority >= cmd->priority) {
+            pos++;
+        }
+    }
+    memmove(&g_pending[pos + 1], &g_pending[pos], (g_pending_count - pos) * sizeof(player_cmd_t));
+    g_pending[pos] = *cmd;
+    g_pending_count++;
+}
+
+//? ==================== 声音 ====================
+
+//? 淡出并报告中断
+static void voice_fade_out(int idx)
+{
+    if (idx < 0) {
+        return;
+    }
+    g_voices[idx].fading = true;
+    g_voices[idx].target = 0;
+    notify(AUDIO_PLAYER_EVT_INTERRUPTED, &g_voices[idx].cmd);
+}
+
+//? 记录命令延迟：命令等待时间 + 本块中的起始位置 + 已排在DMA中的数据
+static void record_latency(const player_cmd_t *cmd, size_t offset_frames)
+{
+    max98367a_dma_stats_t st;
+    max98367a_get_dma_stats(&st);
+    uint32_t fs = max98367a_get_sample_rate();
+    uint64_t queued = (uint64_t)st.headroom_blocks * st.dma_frame_num + offset_frames;
+    uint32_t latency = (uint32_t)(esp_timer_get_time() - cmd->t_us + queued * 1000000ull / fs);
+    uint32_t bound = (uint32_t)((uint64_t)(st.dma_desc_num + 1) * st.dma_frame_num * 1000000ull / fs)
+                     + AUDIO_PLAYER_LATENCY_SLACK_MS * 1000u;
+
+    g_stats.latency_count++;
+    g_stats.latency_last_us = latency;
+    g_latency_sum += latency;
+    g_stats.latency_avg_us = (uint32_t)(g_latency_sum / g_stats.latency_count);
+    if (latency > g_stats.latency_max_us) {
+        g_stats.latency_max_us = latency;
+    }
+    g_stats.latency_bound_us = bound;
+    if (latency > bound) {
+        g_stats.over_bound++;
+        ESP_LOGD(TAG, "Sound %u started %lu us after command (bound %lu us)",
+                 cmd->id, (unsigned long)latency, (unsigned long)bound);
+    }
+}
+
+//? 开始一个声音，返回其编号
+static int voice_start(const player_cmd_t *cmd, size_t offset_frames)
+{
+    int idx = -1;
+    for (int i = 0; i < AUDIO_PLAYER_VOICES; i++) {
+        if (!g_voices[i].active) {
+            idx = i;
+            break;
+        }
+    }
+    //? 没有空闲位置时，结束电平最低的淡出中声音（已报告过中断）
+    if (idx < 0) {
+        for (int i = 0; i < AUDIO_PLAYER_VOICES; i++) {
+            if (g_voices[i].fading && (idx < 0 || g_voices[i].gain < g_voices[idx].gain)) {
+                idx = i;
+            }
+        }
+    }
+
+    const audio_player_sound_t *sound = &g_sounds[cmd->id];
+    player_voice_t *v = &g_voices[idx];
+    memset(v, 0, sizeof(*v));
+    v->active = true;
+    v->cmd = *cmd;
+    v->gain = UNITY_Q16;
+    v->target = UNITY_Q16;
+    v->prescaled = sound->clip != NULL && (sound->clip->flags & MAX98367A_CLIP_PRESCALED);
+    if (sound->open != NULL) {
+        sound->open(sound->arg);
+    }
+
+    if (cmd->direct) {
+        record_latency(cmd, offset_frames);
+    }
+    notify(AUDIO_PLAYER_EVT_START, cmd);
+    return idx;
+}
+
+static inline max98367a_sample_t AUDIO_DSP_IRAM_ATTR sat_sample(int64_t v)
+{
+#if MAX98367A_BIT_WIDTH == 16
+    return (int16_t)(v > INT16_MAX ? INT16_MAX : (v < INT16_MIN ? INT16_MIN : v));
+#else
+    return (int32_t)(v > INT32_MAX ? INT32_MAX : (v < INT32_MIN ? INT32_MIN : v));
+#endif
+}
+
+//? 对 frames 帧乘以从 g0 线性过渡到 g1 的增益（Q32，即两个Q16相乘），饱和
+static void AUDIO_DSP_IRAM_ATTR voice_gain(max98367a_sample_t *dst, size_t frames, int64_t g0, int64_t g1)
+{
+    int64_t g = g0;
+    int64_t step = (g1 - g0) / (int64_t)frames;
+    for (size_t f = 0; f < frames; f++) {
+        g += step;
+        int64_t k = g >> 16;
+        for (int c = 0; c < MAX98367A_CHANNEL_NUM; c++) {
+            dst[f * MAX98367A_CHANNEL_NUM + c] = sat_sample(((int64_t)dst[f * MAX98367A_CHANNEL_NUM + c] * k) >> 16);
+        }
+    }
+}
+
+//? 生成一个声音的下一段（覆盖写入 dst），增益在段内从当前值线性过渡到目标方向
+//? @return 生成的帧数，0表示声音已结束
+static size_t voice_render(player_voice_t *v, max98367a_sample_t *dst, size_t frames)
+{
+    const audio_player_sound_t *sound = &g_sounds[v->cmd.id];
+    size_t n;
+    if (sound->clip != NULL) {
+        n = max98367a_clip_read(sound->clip, v->pos, dst, frames);
+    } else {
+        n = sound->source(dst, frames, sound->arg);
+        n = n > frames ? frames : n;
+    }
+    v->pos += n;
+    if (n == 0) {
+        return 0;
+    }
+
+    int32_t g0 = v->gain;
+    int64_t delta = (int64_t)g_ramp_step * n;
+    int32_t g1 = v->target;
+    if (g1 > g0 && g1 - g0 > delta) {
+        g1 = g0 + (int32_t)delta;
+    } else if (g1 < g0 && g0 - g1 > delta) {
+        g1 = g0 - (int32_t)delta;
+    }
+    v->gain = g1;
+
+    //? 满增益且不需乘音量时不做乘法
+    int32_t volume = v->prescaled ? UNITY_Q16 : g_block_volume;
+    if (g0 == UNITY_Q16 && g1 == UNITY_Q16 && volume == UNITY_Q16) {
+        return n;
+    }
+    voice_gain(dst, n, (int64_t)g0 * volume, (int64_t)g1 * volume);
+    return n;
+}
+
+//? 本块含预缩放片段：输出级跳过增益，普通声音改由调度器乘以当前音量，
+//? 已按1生成的前 frames 帧补乘（与输出级一样饱和）；预缩放片段本身不经任何中间放大，不会削波
+static void block_prescale(max98367a_sample_t *buf, size_t frames)
+{
+    if (g_block_prescaled) {
+        return;
+    }
+    g_block_prescaled = true;
+    g_block_volume = (int32_t)lrintf(max98367a_get_gain() * UNITY_Q16);
+    max98367a_source_set_flags(MAX98367A_CLIP_PRESCALED);
+    for (size_t i = 0; i < frames * MAX98367A_CHANNEL_NUM; i++) {
+        buf[i] = sat_sample(((int64_t)buf[i] * g_block_volume) >> 16);
+    }
+}
+
+//? 当前声音结束后的下一个：等待列表队首（优先级不低于被压低的声音且无需切换采样率），否则恢复被压低的声音
+//? @return false 没有可以在本流中继续的声音
+static bool start_next(size_t offset_frames)
+{
+    bool pending_ok = g_rate_request == 0 && g_pending_count > 0 && !needs_rate_switch(&g_pending[0]);
+    if (g_bg >= 0 && (!pending_ok || g_pending[0].priority < g_voices[g_bg].cmd.priority)) {
+        g_fg = g_bg;
+        g_bg = -1;
+        g_voices[g_fg].target = UNITY_Q16;
+        return true;
+    }
+    if (!pending_ok) {
+        return false;
+    }
+    player_cmd_t cmd = g_pending[0];
+    pending_remove(0);
+    g_fg = voice_start(&cmd, offset_frames);
+    return true;
+}
+
+//? ==================== 命令处理 ====================
+
+static void handle_cmd(player_cmd_t *cmd)
+{
+    if (cmd->type == CMD_STOP) {
+        for (int i = 0; i < AUDIO_PLAYER_VOICES; i++) {
+            if (g_voices[i].active && !g_voices[i].fading) {
+                voice_fade_out(i);
+            }
+        }
+        g_fg = g_bg = -1;
+        while (g_pending_count > 0) {
+            notify(AUDIO_PLAYER_EVT_DROPPED, &g_pending[0]);
+            pending_remove(0);
+        }
+        return;
+    }
+    if (cmd->type == CMD_RATE) {
+        g_rate_request = cmd->token;
+        return;
+    }
+
+    g_stats.commands++;
+    //? 当前声音：正在发声的，或等待切换采样率后立即开始的
+    const player_cmd_t *cur = g_fg >= 0 ? &g_voices[g_fg].cmd : NULL;
+    if (cur == NULL && g_pending_count > 0 && g_pending[0].direct) {
+        cur = &g_pending[0];
+    }
+    if (cur != NULL && (cmd->mode == AUDIO_PLAYER_ENQUEUE || cmd->priority < cur->priority)) {
+        pending_insert(cmd, false);
+        return;
+    }
+
+    if (g_fg >= 0) {
+        //? 采样率不同的声音无法与当前声音混合，压低按抢占处理
+        if (cmd->mode == AUDIO_PLAYER_PREEMPT || needs_rate_switch(cmd)) {
+            voice_fade_out(g_fg);
+            voice_fade_out(g_bg);
+            g_bg = -1;
+        } else {
+            voice_fade_out(g_bg);
+            g_bg = g_fg;
+            g_voices[g_bg].target = g_duck_q16;
+        }
+        g_fg = -1;
+    } else if (cur != NULL) {
+        //? 抢占等待切换采样率的声音
+        notify(AUDIO_PLAYER_EVT_DROPPED, cur);
+        pending_remove(0);
+    }
+
+    //? 命令在块开始时处理，新声音从本块第一帧开始；需要切换采样率时排到最前，等其他声音淡出
+    cmd->direct = true;
+    if (needs_rate_switch(cmd)) {
+        pending_insert(cmd, true);
+    } else {
+        g_fg = voice_start(cmd, 0);
+    }
+}
+
+//? 调度器作为拉模式音源：每个DMA块先处理积压的命令，再生成并混合所有发声中的声音
+static size_t player_source(max98367a_sample_t *buf, size_t frames, void *arg)
+{
+    player_cmd_t cmd;
+    while (xQueueReceive(g_cmd_queue, &cmd, 0) == pdTRUE) {
+        handle_cmd(&cmd);
+    }
+
+    g_block_prescaled = false;
+    g_block_volume = UNITY_Q16;
+    for (int i = 0; i < AUDIO_PLAYER_VOICES; i++) {
+        if (g_voices[i].active && g_voices[i].prescaled) {
+            block_prescale(buf, 0);
+        }
+    }
+
+    //? 当前声音链：一个结束后下一个从同一块的下一帧开始
+    size_t done = 0;
+    while (done < frames) {
+        if (g_fg < 0 && !start_next(done)) {
+            break;
+        }
+        player_voice_t *v = &g_voices[g_fg];
+        if (v->prescaled) {
+            block_prescale(buf, done);
+        }
+        size_t n = voice_render(v, buf + done * MAX98367A_CHANNEL_NUM, frames - done);
+        if (n == 0) {
+            notify(AUDIO_PLAYER_EVT_END, &v->cmd);
+            v->active = false;
+            g_fg = -1;
+            continue;
+        }
+        done += n;
+    }
+    size_t out = done;
+
+    //? 被压低和淡出中的声音叠加在上面
+    for (int i = 0; i < AUDIO_PLAYER_VOICES; i++) {
+        player_voice_t *v = &g_voices[i];
+        if (!v->active || i == g_fg) {
+            continue;
+        }
+        size_t n = voice_render(v, g_mix_buffer, frames);
+        if (n > 0) {
+            if (n > out) {
+                memset(buf + out * MAX98367A_CHANNEL_NUM, 0, (n - out) * MAX98367A_CHANNEL_NUM * sizeof(max98367a_sample_t));
+                out = n;
+            }
+#if MAX98367A_BIT_WIDTH == 16
+            max98367a_mix_s16(buf, g_mix_buffer, n * MAX98367A_CHANNEL_NUM);
+#else
+            max98367a_mix_s32(buf, g_mix_buffer, n * MAX98367A_CHANNEL_NUM);
+#endif
+        }
+        if (n == 0 || (v->fading && v->gain == 0)) {
+            if (!v->fading) {
+                notify(AUDIO_PLAYER_EVT_END, &v->cmd);
+            }
+            v->active = false;
+            if (i == g_bg) {
+                g_bg = -1;
+            }
+        }
+    }
+    return out;
+}
+
+//? 播放任务：空闲时阻塞等待命令，有声音时以调度器为音源播放一段流
+//? 流在没有可继续的声音时结束；队首声音需要不同采样率时，等所有声音结束后切换再开始下一段流
+static void player_task(void *arg)
+{
+    player_cmd_t cmd;
+
+    while (1) {
+        //? 采样率切换请求：等正在发声的声音结束，等待中的声音在切换后继续
+        if (g_rate_request != 0 && !any_active()) {
+            esp_err_t ret = max98367a_set_sample_rate(g_rate_request);
+            if (ret != ESP_OK) {
+                ESP_LOGE(TAG, "Sample rate switch to %lu Hz failed: %s", (unsigned long)g_rate_request, esp_err_to_name(ret));
+            }
+            g_rate_request = 0;
+            continue;
+        }
+
+        if (g_pending_count == 0 && !any_active()) {
+            g_busy = false;
+            xQueueReceive(g_cmd_queue, &cmd, portMAX_DELAY);
+            g_busy = true;
+            handle_cmd(&cmd);
+            continue;
+        }
+
+        if (g_pending_count > 0 && !any_active() && needs_rate_switch(&g_pending[0])) {
+            esp_err_t ret = max98367a_set_sample_rate(g_sounds[g_pending[0].id].clip->sample_rate);
+            if (ret != ESP_OK) {
+                ESP_LOGE(TAG, "Sound %u: sample rate switch failed: %s", g_pending[0].id, esp_err_to_name(ret));
+                notify(AUDIO_PLAYER_EVT_DROPPED, &g_pending[0]);
+                pending_remove(0);
+                continue;
+            }
+        }
+
+        uint32_t fs = max98367a_get_sample_rate();
+        g_ramp_step = (int32_t)(UNITY_Q16 * 1000ull / ((uint64_t)AUDIO_PLAYER_RAMP_MS * fs));
+        g_ramp_step = g_ramp_step > 0 ? g_ramp_step : 1;
+
+        esp_err_t ret = max98367a_play_source(player_source, NULL, portMAX_DELAY);
+        if (ret != ESP_OK) {
+            //? 输出失败：结束所有声音，避免反复重试同一段流
+            ESP_LOGE(TAG, "Playback failed: %s", esp_err_to_name(ret));
+            for (int i = 0; i < AUDIO_PLAYER_VOICES; i++) {
+                if (g_voices[i].active) {
+                    if (!g_voices[i].fading) {
+                        notify(AUDIO_PLAYER_EVT_INTERRUPTED, &g_voices[i].cmd);
+                    }
+                    g_voices[i].active = false;
+                }
+            }
+            g_fg = g_bg = -1;
+        }
+    }
+}
+
+//? ==================== 接口 ====================
+
+esp_err_t audio_player_init(audio_player_event_cb_t cb, void *arg)
+{
+    if (g_cmd_queue != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    g_cmd_queue = xQueueCreate(AUDIO_PLAYER_CMD_QUEUE_LEN, sizeof(player_cmd_t));
+    if (g_cmd_queue == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    g_event_cb = cb;
+    g_event_arg = arg;
+    g_duck_q16 = (int32_t)lrintf(UNITY_Q16 * powf(10.0f, AUDIO_PLAYER_DUCK_DB / 20.0f));
+
+    if (xTaskCreatePinnedToCore(player_task, "audio_player", AUDIO_PLAYER_TASK_STACK_SIZE, NULL,
+                                AUDIO_PLAYER_TASK_PRIORITY, NULL, AUDIO_PLAYER_TASK_CORE) != pdPASS) {
+        vQueueDelete(g_cmd_queue);
+        g_cmd_queue = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "Player started (%d sounds, %d voices, duck %.0f dB)",
+             AUDIO_PLAYER_MAX_SOUNDS, AUDIO_PLAYER_VOICES, AUDIO_PLAYER_DUCK_DB);
+    return ESP_OK;
+}
+
+esp_err_t audio_player_register(uint16_t id, const audio_player_sound_t *sound)
+{
+    if (id >= AUDIO_PLAYER_MAX_SOUNDS || sound == NULL || (sound->clip == NULL && sound->source == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    g_sounds[id] = *sound;
+    return ESP_OK;
+}
+
+static esp_err_t send_cmd(player_cmd_t *cmd)
+{
+    if (g_cmd_queue == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    cmd->t_us = esp_timer_get_time();
+    //? 入队即视为忙，避免调用者在播放任务取出命令之前看到空闲
+    g_busy = true;
+    return xQueueSend(g_cmd_queue, cmd, 0) == pdTRUE ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+esp_err_t audio_player_play(uint16_t id, uint8_t priority, audio_player_mode_t mode, uint32_t *token)
+{
+    if (id >= AUDIO_PLAYER_MAX_SOUNDS || (g_sounds[id].clip == NULL && g_sounds[id].source == NULL)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    player_cmd_t cmd = {
+        .type = CMD_PLAY,
+        .mode = mode,
+        .priority = priority,
+        .id = id,
+    };
+    portENTER_CRITICAL(&g_token_lock);
+    cmd.token = ++g_next_token;
+    portEXIT_CRITICAL(&g_token_lock);
+    if (token != NULL) {
+        *token = cmd.token;
+    }
+    return send_cmd(&cmd);
+}
+
+esp_err_t audio_player_stop(void)
+{
+    player_cmd_t cmd = { .type = CMD_STOP };
+    return send_cmd(&cmd);
+}
+
+esp_err_t audio_player_set_sample_rate(uint32_t sample_rate)
+{
+    if (sample_rate < MAX98367A_MIN_SAMPLE_RATE || sample_rate > MAX98367A_MAX_SAMPLE_RATE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    player_cmd_t cmd = { .type = CMD_RATE, .token = sample_rate };
+    return send_cmd(&cmd);
+}
+
+bool audio_player_busy(void)
+{
+    return g_busy || (g_cmd_queue != NULL && uxQueueMessagesWaiting(g_cmd_queue) > 0);
+}
+
+void audio_player_get_stats(audio_player_stats_t *stats)
+{
+    if (stats != NULL) {
+        *stats = g_stats;
+    }
+}
+
+void audio_player_reset_stats(void)
+{
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_latency_sum = 0;
+}
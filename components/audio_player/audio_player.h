@@ -0,0 +1,143 @@
+#ifndef _AUDIO_PLAYER_H_
+#define _AUDIO_PLAYER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "MAX98367A.h"
+
+//? 播放调度器
+//? 播放任务从命令队列取出按ID登记的声音，按优先级和模式（排队 / 抢占 / 压低）调度。
+//? 所有声音在同一条输出流中逐块生成并混合（max98367a_play_source）：
+//? 前一个声音结束后，下一个在同一DMA块内紧接着开始，中间没有间隙、也不重新预填充；
+//? 被抢占的声音在 AUDIO_PLAYER_RAMP_MS 内淡出，与新声音交叉，不产生爆音。
+//? 开始、结束、中断和丢弃通过回调报告（播放任务上下文），并统计从发出命令到首样本输出的延迟。
+
+//? 可登记的声音数（ID范围 0 ~ AUDIO_PLAYER_MAX_SOUNDS-1）
+#ifndef AUDIO_PLAYER_MAX_SOUNDS
+#define AUDIO_PLAYER_MAX_SOUNDS     16
+#endif
+
+//? 命令队列长度
+#ifndef AUDIO_PLAYER_CMD_QUEUE_LEN
+#define AUDIO_PLAYER_CMD_QUEUE_LEN  8
+#endif
+
+//? 等待播放的声音数上限，满时丢弃优先级最低的
+#ifndef AUDIO_PLAYER_PENDING_MAX
+#define AUDIO_PLAYER_PENDING_MAX    8
+#endif
+
+//? 同时发声的声音数（当前 + 被压低 + 淡出中）
+#ifndef AUDIO_PLAYER_VOICES
+#define AUDIO_PLAYER_VOICES         4
+#endif
+
+//? 被压低（AUDIO_PLAYER_DUCK）的声音的电平（dB）
+#ifndef AUDIO_PLAYER_DUCK_DB
+#define AUDIO_PLAYER_DUCK_DB        (-12.0f)
+#endif
+
+//? 压低、恢复和抢占淡出的过渡时长（毫秒）
+#ifndef AUDIO_PLAYER_RAMP_MS
+#define AUDIO_PLAYER_RAMP_MS        10
+#endif
+
+//? 延迟上限中预留的任务调度余量（毫秒），见 audio_player_stats_t.latency_bound_us
+#ifndef AUDIO_PLAYER_LATENCY_SLACK_MS
+#define AUDIO_PLAYER_LATENCY_SLACK_MS  5
+#endif
+
+//? 播放任务配置
+#ifndef AUDIO_PLAYER_TASK_PRIORITY
+#define AUDIO_PLAYER_TASK_PRIORITY  5
+#endif
+
+#ifndef AUDIO_PLAYER_TASK_STACK_SIZE
+#define AUDIO_PLAYER_TASK_STACK_SIZE  4096
+#endif
+
+#ifndef AUDIO_PLAYER_TASK_CORE
+#define AUDIO_PLAYER_TASK_CORE      1
+#endif
+
+//? 播放模式
+//? 优先级低于当前声音的抢占/压低命令按排队处理
+typedef enum {
+    AUDIO_PLAYER_ENQUEUE = 0,   //? 排队：按优先级（同优先级先到先播）在当前声音之后无缝播放
+    AUDIO_PLAYER_PREEMPT,       //? 抢占：当前声音（及被压低的声音）淡出并报告中断，新声音立即开始
+    AUDIO_PLAYER_DUCK,          //? 压低：当前声音降到 AUDIO_PLAYER_DUCK_DB 继续播放，新声音叠加其上，结束后恢复
+} audio_player_mode_t;
+
+//? 状态事件
+typedef enum {
+    AUDIO_PLAYER_EVT_START = 0,     //? 首样本已生成
+    AUDIO_PLAYER_EVT_END,           //? 播放完毕
+    AUDIO_PLAYER_EVT_INTERRUPTED,   //? 被抢占或停止（开始淡出）
+    AUDIO_PLAYER_EVT_DROPPED,       //? 未开始即被丢弃（等待列表已满、停止或采样率切换失败）
+} audio_player_event_t;
+
+//? 状态回调（播放任务上下文，在生成DMA块的过程中调用，不能阻塞）
+//? @param id 声音ID
+//? @param token audio_player_play() 返回的命令编号，用于区分同一声音的多次播放
+typedef void (*audio_player_event_cb_t)(audio_player_event_t event, uint16_t id, uint32_t token, void *arg);
+
+//? 声音：片段或拉模式音源二选一
+typedef struct {
+    const max98367a_clip_t *clip;   //? 片段（sample_rate 不为0且与当前不同时，等其他声音结束后切换采样率再播放）
+    max98367a_source_fn_t source;   //? 音源（clip为NULL时使用），按当前输出采样率生成
+    void (*open)(void *arg);        //? 每次开始播放时调用（如按当前采样率重置合成器），可为NULL
+    void *arg;                      //? source / open 的参数
+} audio_player_sound_t;
+
+//? 调度统计
+typedef struct {
+    uint32_t commands;          //? 收到的播放命令数
+    uint32_t started;
+    uint32_t finished;
+    uint32_t interrupted;
+    uint32_t dropped;
+    //? 延迟：发出命令到首样本离开DMA的估计时间（命令处理 + 已排在DMA中的数据）
+    //? 只统计立即开始的命令（空闲时、抢占和压低），排队等待的不计入
+    uint32_t latency_count;
+    uint32_t latency_last_us;
+    uint32_t latency_avg_us;
+    uint32_t latency_max_us;
+    uint32_t latency_bound_us;  //? 理论上限：(DMA描述符数 + 1) 个DMA块 + AUDIO_PLAYER_LATENCY_SLACK_MS
+    uint32_t over_bound;        //? 超过上限的次数
+} audio_player_stats_t;
+
+//? 初始化调度器并创建播放任务，须在 i2s_tx_init() / max98367a_attach() 之后调用
+//? 之后所有输出都应经由调度器，不要再在其他任务中直接调用 max98367a_play_clip()
+//? @param cb 状态回调，可为NULL
+//? @return ESP_OK 成功, ESP_ERR_INVALID_STATE 已初始化, ESP_ERR_NO_MEM 队列或任务创建失败
+esp_err_t audio_player_init(audio_player_event_cb_t cb, void *arg);
+
+//? 登记声音，内容被复制（clip 指向的片段描述须保持有效），须在播放该ID之前登记
+//? @return ESP_OK 成功, ESP_ERR_INVALID_ARG ID超出范围或 clip / source 都为NULL
+esp_err_t audio_player_register(uint16_t id, const audio_player_sound_t *sound);
+
+//? 发送播放命令（不阻塞）
+//? @param priority 优先级，越大越优先
+//? @param token 可为NULL，返回命令编号（与回调中的 token 对应）
+//? @return ESP_OK 成功, ESP_ERR_NOT_FOUND ID未登记, ESP_ERR_INVALID_STATE 未初始化, ESP_ERR_NO_MEM 命令队列已满
+esp_err_t audio_player_play(uint16_t id, uint8_t priority, audio_player_mode_t mode, uint32_t *token);
+
+//? 停止：正在播放的声音淡出并报告中断，等待列表清空并报告丢弃
+esp_err_t audio_player_stop(void);
+
+//? 请求切换输出采样率（在播放任务中执行，其他任务不能直接调用 max98367a_set_sample_rate()）
+//? 正在发声的声音播完后切换，等待中的声音随后继续；指定了 sample_rate 的片段播放时仍会切换到自身采样率
+//? @return ESP_OK 已入队, ESP_ERR_INVALID_ARG 超出范围, ESP_ERR_INVALID_STATE 未初始化, ESP_ERR_NO_MEM 命令队列已满
+esp_err_t audio_player_set_sample_rate(uint32_t sample_rate);
+
+//? 有声音在播放、等待或命令尚未处理
+bool audio_player_busy(void);
+
+//? 获取调度统计
+void audio_player_get_stats(audio_player_stats_t *stats);
+
+//? 清零调度统计
+void audio_player_reset_stats(void);
+
+#endif
@@ -0,0 +1,134 @@
+#include "audio_sync.h"
+#include <math.h>
+#include <string.h>
+
+//? Q32定点的1.0
+#define Q32_ONE     ((int64_t)1 << 32)
+
+//? 控制环路阻尼比
+#define LOOP_DAMPING    0.707f
+
+static float clampf(float v, float lim)
+{
+    if (v > lim) {
+        return lim;
+    } else if (v < -lim) {
+        return -lim;
+    }
+    return v;
+}
+
+//? 初始化
+void audio_sync_init(audio_sync_t *s, const audio_sync_config_t *cfg)
+{
+    const audio_sync_config_t def = AUDIO_SYNC_CONFIG_DEFAULT(44100, 0);
+
+    memset(s, 0, sizeof(*s));
+    s->cfg = cfg ? *cfg : def;
+
+    //? 被控对象：水位变化率 = (漂移 - 修正量) * 1e-6 * 采样率（样本/秒）
+    //? 二阶PI环路：自然频率 w = 2π/周期，kp = 2ζw/g，ki = w²/g
+    float g = 1e-6f * s->cfg.sample_rate;
+    float w = 2.0f * (float)M_PI / s->cfg.loop_period_s;
+    s->kp = 2.0f * LOOP_DAMPING * w / g;
+    s->ki = w * w / g;
+
+    s->step = (uint64_t)Q32_ONE;
+}
+
+//? 更新漂移估计
+void audio_sync_update(audio_sync_t *s, uint32_t fill, uint32_t elapsed)
+{
+    if (!s->primed) {
+        s->fill_avg = (float)fill;
+        s->primed = true;
+        return;
+    }
+    if (elapsed == 0) {
+        return;
+    }
+
+    float dt = (float)elapsed / s->cfg.sample_rate;
+    float alpha = dt / (s->cfg.smooth_s + dt);
+    s->fill_avg += alpha * ((float)fill - s->fill_avg);
+
+    //? 水位高于目标说明源比本地快，修正量为正（多消耗输入）
+    float err = s->fill_avg - (float)s->cfg.target_fill;
+
+    //? 积分项限幅防止饱和期间过度累积
+    s->integ = clampf(s->integ + s->ki * err * dt, s->cfg.max_ppm);
+    s->ppm = clampf(s->kp * err + s->integ, s->cfg.max_ppm);
+
+    s->step = (uint64_t)((1.0 + s->ppm * 1e-6) * (double)Q32_ONE);
+}
+
+//? 取第k个输入样本，k<0时取上一块的历史样本
+static inline float sample_at(const audio_sync_t *s, const int32_t *in, int64_t k)
+{
+    return (float)(k < 0 ? s->hist[3 + k] : in[k]);
+}
+
+//? 重采样一块
+size_t audio_sync_process(audio_sync_t *s, const int32_t *in, size_t in_count, int32_t *out, size_t out_cap)
+{
+    if (in_count < 3) {
+        return 0;
+    }
+
+    //? 插值点 i 需要 i-1 ~ i+2 四个样本，i 最大为 in_count-3
+    const int64_t limit = (int64_t)(in_count - 2) << 32;
+    int64_t pos = s->pos;
+    size_t n = 0;
+
+    while (pos < limit && n < out_cap) {
+        int64_t i = pos >> 32;
+        float t = (float)(uint32_t)pos * (1.0f / 4294967296.0f);
+        float xm1 = sample_at(s, in, i - 1);
+        float x0 = sample_at(s, in, i);
+        float x1 = sample_at(s, in, i + 1);
+        float x2 = sample_at(s, in, i + 2);
+
+        //? Catmull-Rom三次Hermite插值，频响比线性插值平坦，相位缓慢滑动时不产生可闻的幅度起伏
+        float c1 = 0.5f * (x1 - xm1);
+        float c2 = xm1 - 2.5f * x0 + 2.0f * x1 - 0.5f * x2;
+        float c3 = 0.5f * (x2 - xm1) + 1.5f * (x0 - x1);
+        float y = ((c3 * t + c2) * t + c1) * t + x0;
+
+        //? 插值可能过冲，饱和到int32
+        if (y >= 2147483520.0f) {
+            out[n] = INT32_MAX;
+        } else if (y <= -2147483648.0f) {
+            out[n] = INT32_MIN;
+        } else {
+            out[n] = (int32_t)y;
+        }
+        n++;
+        pos += (int64_t)s->step;
+    }
+
+    s->pos = pos - ((int64_t)in_count << 32);
+    s->hist[0] = in[in_count - 3];
+    s->hist[1] = in[in_count - 2];
+    s->hist[2] = in[in_count - 1];
+    s->in_total += in_count;
+    s->out_total += n;
+    return n;
+}
+
+//? 最大输出样本数
+size_t audio_sync_max_output(const audio_sync_t *s, size_t in_count)
+{
+    return in_count + (size_t)(in_count * s->cfg.max_ppm * 1e-6f) + 4;
+}
+
+//? 当前修正量
+float audio_sync_get_ppm(const audio_sync_t *s)
+{
+    return s->ppm;
+}
+
+//? 估计的时钟漂移
+float audio_sync_get_drift_ppm(const audio_sync_t *s)
+{
+    return s->integ;
+}
@@ -0,0 +1,95 @@
+#ifndef _AUDIO_SYNC_H_
+#define _AUDIO_SYNC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+//? 网络音频源与本地I2S时钟之间的漂移补偿
+//? 服务器按自己的时钟产生音频，本地按I2S时钟消费，两者相差几十到几百ppm，
+//? 长时间通话中播放队列会慢慢积满或耗尽。本模块：
+//?   1. 根据缓冲区水位的长期趋势估计漂移（PI控制器，积分项收敛到实际漂移ppm）
+//?   2. 用分数比例异步重采样器（Q32.32相位累加 + 4点三次Hermite插值）平滑地修正
+//? 纯C实现，不依赖ESP-IDF，可在主机上编译仿真（见 tools/audio_sync_sim.c）
+
+//? 最大修正量（ppm），晶振误差通常在±100ppm以内，两端叠加留余量
+#ifndef AUDIO_SYNC_MAX_PPM
+#define AUDIO_SYNC_MAX_PPM          500.0f
+#endif
+
+//? 控制环路周期（秒）：越长越平滑，越短跟踪越快
+#ifndef AUDIO_SYNC_LOOP_PERIOD_S
+#define AUDIO_SYNC_LOOP_PERIOD_S    120.0f
+#endif
+
+//? 水位平滑时间常数（秒），滤除网络抖动和按块出队造成的锯齿
+#ifndef AUDIO_SYNC_SMOOTH_S
+#define AUDIO_SYNC_SMOOTH_S         10.0f
+#endif
+
+//? 配置
+typedef struct {
+    uint32_t sample_rate;       //? 本地输出采样率（Hz），建议传实际达到的I2S采样率
+    uint32_t target_fill;       //? 目标缓冲水位（样本数，如队列容量的一半）
+    float max_ppm;              //? 最大修正量（ppm）
+    float loop_period_s;        //? 控制环路周期（秒）
+    float smooth_s;             //? 水位平滑时间常数（秒）
+} audio_sync_config_t;
+
+#define AUDIO_SYNC_CONFIG_DEFAULT(rate, target) {   \
+    .sample_rate = (rate),                          \
+    .target_fill = (target),                        \
+    .max_ppm = AUDIO_SYNC_MAX_PPM,                  \
+    .loop_period_s = AUDIO_SYNC_LOOP_PERIOD_S,      \
+    .smooth_s = AUDIO_SYNC_SMOOTH_S,                \
+}
+
+//? 运行状态（由调用者分配，通常为静态变量）
+typedef struct {
+    audio_sync_config_t cfg;
+    
+    //? 漂移估计
+    float kp;                   //? 比例增益（ppm/样本）
+    float ki;                   //? 积分增益（ppm/(样本*秒)）
+    float fill_avg;             //? 平滑后的水位
+    float integ;                //? 积分项，稳态时即为估计的漂移（ppm）
+    float ppm;                  //? 当前修正量（ppm），正值表示源比本地快、需多消耗输入
+    bool primed;                //? 是否已收到第一次水位
+    
+    //? 重采样
+    uint64_t step;              //? 每个输出样本前进的输入样本数（Q32）
+    int64_t pos;                //? 下一个输出样本在当前输入块中的位置（Q32，可为负，指向历史样本）
+    int32_t hist[3];            //? 上一块最后3个输入样本
+    uint64_t in_total;          //? 累计输入样本数
+    uint64_t out_total;         //? 累计输出样本数
+} audio_sync_t;
+
+//? 初始化
+//? @param s 状态
+//? @param cfg 配置，NULL表示 AUDIO_SYNC_CONFIG_DEFAULT(44100, 0)
+void audio_sync_init(audio_sync_t *s, const audio_sync_config_t *cfg);
+
+//? 更新漂移估计（每处理一块调用一次）
+//? @param fill 当前缓冲水位（样本数，含队列中未处理的数据）
+//? @param elapsed 距上次调用经过的输出样本数
+void audio_sync_update(audio_sync_t *s, uint32_t fill, uint32_t elapsed);
+
+//? 按当前修正量重采样一块单声道数据
+//? 输出样本数约为 in_count / (1 + ppm*1e-6)，上下浮动1个样本
+//? @param in 输入样本
+//? @param in_count 输入样本数（至少3个）
+//? @param out 输出缓冲区
+//? @param out_cap 输出容量，至少 audio_sync_max_output(in_count)
+//? @return 输出样本数
+size_t audio_sync_process(audio_sync_t *s, const int32_t *in, size_t in_count, int32_t *out, size_t out_cap);
+
+//? 给定输入样本数时的最大输出样本数
+size_t audio_sync_max_output(const audio_sync_t *s, size_t in_count);
+
+//? 当前修正量（ppm）
+float audio_sync_get_ppm(const audio_sync_t *s);
+
+//? 估计的时钟漂移（ppm，积分项）
+float audio_sync_get_drift_ppm(const audio_sync_t *s);
+
+#endif
@@ -0,0 +1,402 @@
+#include "audio_synth.h"
+#include <math.h>
+#include <string.h>
+
+//? Q30的1.0
+#define ENV_ONE         (1 << 30)
+//? 释音或无持续的衰减降到此电平（约-84dB）后音符结束
+#define ENV_FLOOR       (ENV_ONE >> 14)
+//? 每次内部处理的最大帧数（栈上混音缓冲区）
+#define RENDER_CHUNK    64
+//? 小数相位位数：相位累加器低位中取15位作为插值系数
+#define FRAC_SHIFT      (32 - AUDIO_SYNTH_TABLE_BITS - 15)
+
+//? 波表，多一个保护点使插值无需回绕
+static int16_t s_tables[AUDIO_SYNTH_WAVE_NUM][AUDIO_SYNTH_TABLE_SIZE + 1];
+static bool s_tables_ready = false;
+
+//? 未指定包络时使用：短起音/释音，防止爆音
+static const audio_synth_adsr_t s_default_adsr = {5, 0, 32767, 5};
+
+//? ==================== 内置序列 ====================
+
+static const audio_synth_step_t s_chime_steps[] = {
+    {{659, 0}, 450, 0},
+    {{523, 0}, 1500, 0},
+};
+const audio_synth_seq_t audio_synth_seq_chime = {
+    s_chime_steps, 2, 0, AUDIO_SYNTH_SINE, {3, 1500, 0, 400}, 16384,
+};
+
+static const audio_synth_step_t s_alert_steps[] = {
+    {{988, 0}, 120, 80},
+    {{988, 0}, 120, 80},
+    {{988, 0}, 120, 300},
+};
+const audio_synth_seq_t audio_synth_seq_alert = {
+    s_alert_steps, 3, 1, AUDIO_SYNTH_SQUARE, {2, 0, 32767, 10}, 8000,
+};
+
+static const audio_synth_step_t s_success_steps[] = {
+    {{1047, 0}, 130, 20},
+    {{1319, 0}, 130, 20},
+    {{1568, 0}, 300, 0},
+};
+const audio_synth_seq_t audio_synth_seq_success = {
+    s_success_steps, 3, 0, AUDIO_SYNTH_TRIANGLE, {3, 600, 8000, 150}, 14000,
+};
+
+static const audio_synth_step_t s_error_steps[] = {
+    {{330, 0}, 220, 120},
+    {{262, 0}, 400, 0},
+};
+const audio_synth_seq_t audio_synth_seq_error = {
+    s_error_steps, 2, 0, AUDIO_SYNTH_SQUARE, {3, 0, 32767, 30}, 9000,
+};
+
+//? DTMF键盘：行频率 x 列频率
+static const char s_dtmf_keys[] = "123A456B789C*0#D";
+static const uint16_t s_dtmf_row[4] = {697, 770, 852, 941};
+static const uint16_t s_dtmf_col[4] = {1209, 1336, 1477, 1633};
+
+//? ==================== 波表 ====================
+
+//? 带限合成：按傅里叶级数叠加 AUDIO_SYNTH_HARMONICS 个谐波，峰值归一化到满幅
+static void build_tables(void)
+{
+    static float buf[AUDIO_SYNTH_TABLE_SIZE];
+
+    for (int w = 0; w < AUDIO_SYNTH_WAVE_NUM; w++) {
+        float peak = 0.0f;
+        for (int i = 0; i < AUDIO_SYNTH_TABLE_SIZE; i++) {
+            double x = 2.0 * M_PI * i / AUDIO_SYNTH_TABLE_SIZE;
+            double v = (w == AUDIO_SYNTH_SINE) ? sin(x) : 0.0;
+            for (int k = 1; k <= AUDIO_SYNTH_HARMONICS && w != AUDIO_SYNTH_SINE; k++) {
+                switch (w) {
+                case AUDIO_SYNTH_TRIANGLE:
+                    v += (k & 1) ? ((k & 2) ? -1.0 : 1.0) * sin(k * x) / (k * k) : 0.0;
+                    break;
+                case AUDIO_SYNTH_SQUARE:
+                    v += (k & 1) ? sin(k * x) / k : 0.0;
+                    break;
+                default:
+                    v += ((k & 1) ? 1.0 : -1.0) * sin(k * x) / k;
+                    break;
+                }
+            }
+            buf[i] = (float)v;
+            peak = fabsf(buf[i]) > peak ? fabsf(buf[i]) : peak;
+        }
+        for (int i = 0; i < AUDIO_SYNTH_TABLE_SIZE; i++) {
+            s_tables[w][i] = (int16_t)lrintf(buf[i] * 32767.0f / peak);
+        }
+        s_tables[w][AUDIO_SYNTH_TABLE_SIZE] = s_tables[w][0];
+    }
+    s_tables_ready = true;
+}
+
+//? ==================== 包络 ====================
+
+static uint32_t ms_to_samples(const audio_synth_t *s, uint32_t ms)
+{
+    return (uint32_t)((uint64_t)ms * s->fs / 1000);
+}
+
+//? 指数衰减系数：ms 内下降60dB，即每样本乘 10^(-3/N)
+static int32_t t60_coef(const audio_synth_t *s, uint16_t ms)
+{
+    uint32_t n = ms_to_samples(s, ms);
+    if (n == 0) {
+        return 0;
+    }
+    return (int32_t)lrint(exp(-6.907755 / n) * ENV_ONE);
+}
+
+//? 推进一个样本的包络，返回Q30电平
+static inline int32_t env_step(audio_synth_voice_t *v)
+{
+    switch (v->stage) {
+    case AUDIO_SYNTH_ENV_ATTACK:
+        v->env += v->attack_inc;
+        if (v->env >= ENV_ONE) {
+            v->env = ENV_ONE;
+            v->stage = AUDIO_SYNTH_ENV_DECAY;
+        }
+        break;
+    case AUDIO_SYNTH_ENV_DECAY:
+        v->env = v->sustain + (int32_t)(((int64_t)(v->env - v->sustain) * v->decay_coef) >> 30);
+        if (v->env - v->sustain < ENV_FLOOR) {
+            v->env = v->sustain;
+            //? 持续电平为0（钟声类）：衰减结束即音符结束
+            v->stage = (v->sustain < ENV_FLOOR) ? AUDIO_SYNTH_ENV_IDLE : AUDIO_SYNTH_ENV_SUSTAIN;
+        }
+        break;
+    case AUDIO_SYNTH_ENV_RELEASE:
+        v->env = (int32_t)(((int64_t)v->env * v->release_coef) >> 30);
+        if (v->env < ENV_FLOOR) {
+            v->env = 0;
+            v->stage = AUDIO_SYNTH_ENV_IDLE;
+        }
+        break;
+    default:
+        break;
+    }
+    return v->env;
+}
+
+//? ==================== 音符 ====================
+
+void audio_synth_init(audio_synth_t *s, uint32_t fs)
+{
+    if (!s_tables_ready) {
+        build_tables();
+    }
+    memset(s, 0, sizeof(*s));
+    s->fs = fs;
+    s->seq_voice[0] = s->seq_voice[1] = -1;
+}
+
+void audio_synth_set_sample_rate(audio_synth_t *s, uint32_t fs)
+{
+    audio_synth_init(s, fs);
+}
+
+int audio_synth_note_on(audio_synth_t *s, float freq_hz, audio_synth_wave_t wave,
+                        const audio_synth_adsr_t *adsr, int16_t level)
+{
+    if (freq_hz <= 0.0f || freq_hz >= 0.5f * s->fs || (unsigned)wave >= AUDIO_SYNTH_WAVE_NUM) {
+        return -1;
+    }
+    if (adsr == NULL) {
+        adsr = &s_default_adsr;
+    }
+
+    //? 优先用空闲音符，否则抢占电平最低的释音音符，再否则抢占电平最低的音符
+    int idx = -1;
+    int32_t lowest = INT32_MAX;
+    bool releasing = false;
+    for (int i = 0; i < AUDIO_SYNTH_MAX_VOICES; i++) {
+        const audio_synth_voice_t *v = &s->voice[i];
+        if (v->stage == AUDIO_SYNTH_ENV_IDLE) {
+            idx = i;
+            break;
+        }
+        bool rel = (v->stage == AUDIO_SYNTH_ENV_RELEASE);
+        if ((rel && !releasing) || (rel == releasing && v->env < lowest)) {
+            idx = i;
+            lowest = v->env;
+            releasing = rel;
+        }
+    }
+
+    audio_synth_voice_t *v = &s->voice[idx];
+    uint32_t attack = ms_to_samples(s, adsr->attack_ms);
+    v->table = s_tables[wave];
+    v->inc = (uint32_t)llround((double)freq_hz * 4294967296.0 / s->fs);
+    v->level = level;
+    v->attack_inc = attack > 0 ? (int32_t)(ENV_ONE / attack) : ENV_ONE;
+    v->decay_coef = t60_coef(s, adsr->decay_ms);
+    v->release_coef = t60_coef(s, adsr->release_ms);
+    v->sustain = (int32_t)adsr->sustain << 15;
+    //? 抢占时从当前电平继续起音，避免跳变；新音符从相位0开始
+    if (v->stage == AUDIO_SYNTH_ENV_IDLE) {
+        v->env = 0;
+        v->phase = 0;
+    }
+    v->stage = AUDIO_SYNTH_ENV_ATTACK;
+    return idx;
+}
+
+void audio_synth_note_off(audio_synth_t *s, int voice)
+{
+    if (voice < 0 || voice >= AUDIO_SYNTH_MAX_VOICES) {
+        return;
+    }
+    audio_synth_voice_t *v = &s->voice[voice];
+    if (v->stage != AUDIO_SYNTH_ENV_IDLE) {
+        v->stage = AUDIO_SYNTH_ENV_RELEASE;
+    }
+}
+
+void audio_synth_stop(audio_synth_t *s)
+{
+    s->seq_active = false;
+    for (int i = 0; i < AUDIO_SYNTH_MAX_VOICES; i++) {
+        audio_synth_note_off(s, i);
+    }
+}
+
+bool audio_synth_busy(const audio_synth_t *s)
+{
+    if (s->seq_active) {
+        return true;
+    }
+    for (int i = 0; i < AUDIO_SYNTH_MAX_VOICES; i++) {
+        if (s->voice[i].stage != AUDIO_SYNTH_ENV_IDLE) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//? ==================== 序列 ====================
+
+void audio_synth_play(audio_synth_t *s, const audio_synth_seq_t *seq)
+{
+    audio_synth_stop(s);
+    if (seq == NULL || seq->steps == NULL || seq->count == 0) {
+        return;
+    }
+    s->seq = *seq;
+    s->step = 0;
+    s->repeat_left = seq->repeat;
+    s->seq_gate = false;
+    s->event_left = 0;
+    s->seq_voice[0] = s->seq_voice[1] = -1;
+    s->seq_active = true;
+}
+
+bool audio_synth_dtmf_freq(char key, uint16_t *row_hz, uint16_t *col_hz)
+{
+    const char *p = (key != '\0') ? strchr(s_dtmf_keys, key) : NULL;
+    if (p == NULL) {
+        return false;
+    }
+    size_t i = p - s_dtmf_keys;
+    *row_hz = s_dtmf_row[i / 4];
+    *col_hz = s_dtmf_col[i % 4];
+    return true;
+}
+
+size_t audio_synth_play_dtmf(audio_synth_t *s, const char *digits, uint16_t on_ms, uint16_t off_ms)
+{
+    size_t n = 0;
+
+    audio_synth_stop(s);
+    for (const char *p = digits; p != NULL && *p != '\0' && n < AUDIO_SYNTH_DTMF_MAX; p++) {
+        char key = (*p >= 'a' && *p <= 'd') ? (char)(*p - 'a' + 'A') : *p;
+        audio_synth_step_t *st = &s->dtmf[n];
+        if (audio_synth_dtmf_freq(key, &st->freq_hz[0], &st->freq_hz[1])) {
+            st->on_ms = on_ms;
+            st->off_ms = off_ms;
+            n++;
+        }
+    }
+    if (n > 0) {
+        //? 两个音各约-9dBFS，合成峰值约-3dBFS；起音/释音各几毫秒，不影响接收端识别
+        const audio_synth_seq_t seq = {
+            s->dtmf, (uint16_t)n, 0, AUDIO_SYNTH_SINE, {2, 0, 32767, 3}, 11500,
+        };
+        audio_synth_play(s, &seq);
+    }
+    return n;
+}
+
+//? 处理一个序列事件：步开始（触发音符）或步发声结束（释音）
+static void seq_event(audio_synth_t *s)
+{
+    if (s->seq_gate) {
+        audio_synth_note_off(s, s->seq_voice[0]);
+        audio_synth_note_off(s, s->seq_voice[1]);
+        s->seq_voice[0] = s->seq_voice[1] = -1;
+        s->seq_gate = false;
+        s->event_left = ms_to_samples(s, s->seq.steps[s->step].off_ms);
+        s->step++;
+        return;
+    }
+
+    if (s->step >= s->seq.count) {
+        if (s->repeat_left == 0) {
+            s->seq_active = false;
+            return;
+        }
+        s->repeat_left--;
+        s->step = 0;
+    }
+    const audio_synth_step_t *st = &s->seq.steps[s->step];
+    for (int k = 0; k < 2; k++) {
+        s->seq_voice[k] = st->freq_hz[k] ? audio_synth_note_on(s, st->freq_hz[k], s->seq.wave, &s->seq.adsr, s->seq.level) : -1;
+    }
+    s->seq_gate = true;
+    s->event_left = ms_to_samples(s, st->on_ms);
+}
+
+//? ==================== 生成 ====================
+
+//? 所有发声音符混合到 mix（Q15，可能超出int16范围，由输出时饱和）
+static void render_mono(audio_synth_t *s, int32_t *mix, size_t n)
+{
+    memset(mix, 0, n * sizeof(int32_t));
+    for (int i = 0; i < AUDIO_SYNTH_MAX_VOICES; i++) {
+        audio_synth_voice_t *v = &s->voice[i];
+        if (v->stage == AUDIO_SYNTH_ENV_IDLE) {
+            continue;
+        }
+        const int16_t *t = v->table;
+        uint32_t phase = v->phase;
+        for (size_t k = 0; k < n; k++) {
+            //? 高位查表，其后15位作为线性插值系数
+            uint32_t idx = phase >> (32 - AUDIO_SYNTH_TABLE_BITS);
+            int32_t frac = (int32_t)((phase >> FRAC_SHIFT) & 0x7FFF);
+            int32_t a = t[idx];
+            int32_t smp = a + (((t[idx + 1] - a) * frac) >> 15);
+            phase += v->inc;
+            int32_t g = ((env_step(v) >> 15) * v->level) >> 15;
+            mix[k] += (smp * g) >> 15;
+        }
+        v->phase = phase;
+    }
+}
+
+//? 生成一段（不超过 RENDER_CHUNK 帧且不跨越序列事件），返回帧数
+static size_t render_chunk(audio_synth_t *s, int32_t *mix, size_t frames)
+{
+    while (s->seq_active && s->event_left == 0) {
+        seq_event(s);
+    }
+    size_t n = frames < RENDER_CHUNK ? frames : RENDER_CHUNK;
+    if (s->seq_active && s->event_left < n) {
+        n = s->event_left;
+    }
+    render_mono(s, mix, n);
+    if (s->seq_active) {
+        s->event_left -= n;
+    }
+    return n;
+}
+
+size_t audio_synth_render_s32(audio_synth_t *s, int32_t *out, size_t frames, uint8_t channels)
+{
+    int32_t mix[RENDER_CHUNK];
+    size_t done = 0;
+
+    while (done < frames) {
+        size_t n = render_chunk(s, mix, frames - done);
+        for (size_t k = 0; k < n; k++) {
+            int32_t v = mix[k] > INT16_MAX ? INT16_MAX : (mix[k] < INT16_MIN ? INT16_MIN : mix[k]);
+            for (uint8_t c = 0; c < channels; c++) {
+                *out++ = v * 65536;
+            }
+        }
+        done += n;
+    }
+    return frames;
+}
+
+size_t audio_synth_render_s16(audio_synth_t *s, int16_t *out, size_t frames, uint8_t channels)
+{
+    int32_t mix[RENDER_CHUNK];
+    size_t done = 0;
+
+    while (done < frames) {
+        size_t n = render_chunk(s, mix, frames - done);
+        for (size_t k = 0; k < n; k++) {
+            int16_t v = (int16_t)(mix[k] > INT16_MAX ? INT16_MAX : (mix[k] < INT16_MIN ? INT16_MIN : mix[k]));
+            for (uint8_t c = 0; c < channels; c++) {
+                *out++ = v;
+            }
+        }
+        done += n;
+    }
+    return frames;
+}
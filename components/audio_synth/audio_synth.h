@@ -0,0 +1,154 @@
+#ifndef _AUDIO_SYNTH_H_
+#define _AUDIO_SYNTH_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+//? 提示音合成器（波表 / DDS）
+//? 相位累加器振荡器 + 插值波表 + ADSR包络，加上按步骤触发音符的序列器（DTMF、门铃、提示音型），
+//? 样本直接生成到输出块中，不占用Flash音频资源。波表在首次初始化时计算到RAM中。
+//? 纯C实现，不依赖ESP-IDF，可在主机上编译测试（见 tools/audio_synth_test.c）
+
+//? 波表长度（2^N点，另加1个保护点供插值）
+#ifndef AUDIO_SYNTH_TABLE_BITS
+#define AUDIO_SYNTH_TABLE_BITS  8
+#endif
+#define AUDIO_SYNTH_TABLE_SIZE  (1 << AUDIO_SYNTH_TABLE_BITS)
+
+//? 非正弦波形的谐波数（带限合成，基频 * 谐波数低于奈奎斯特频率时无混叠）
+#ifndef AUDIO_SYNTH_HARMONICS
+#define AUDIO_SYNTH_HARMONICS   9
+#endif
+
+//? 同时发声的音符数
+#ifndef AUDIO_SYNTH_MAX_VOICES
+#define AUDIO_SYNTH_MAX_VOICES  4
+#endif
+
+//? audio_synth_play_dtmf() 一次最多的按键数
+#ifndef AUDIO_SYNTH_DTMF_MAX
+#define AUDIO_SYNTH_DTMF_MAX    32
+#endif
+
+//? 波形
+typedef enum {
+    AUDIO_SYNTH_SINE = 0,
+    AUDIO_SYNTH_TRIANGLE,
+    AUDIO_SYNTH_SQUARE,
+    AUDIO_SYNTH_SAW,
+    AUDIO_SYNTH_WAVE_NUM,
+} audio_synth_wave_t;
+
+//? ADSR包络参数
+//? 起音为线性上升；衰减和释音为指数下降，时间为下降60dB所需的时长（与钟声、琴弦的自然衰减一致）
+typedef struct {
+    uint16_t attack_ms;
+    uint16_t decay_ms;
+    uint16_t sustain;       //? 持续电平，Q15（32767 = 满幅）
+    uint16_t release_ms;
+} audio_synth_adsr_t;
+
+//? 序列中的一步：同时发出最多两个音（DTMF双音），发声 on_ms 后进入释音，再隔 off_ms 进入下一步
+typedef struct {
+    uint16_t freq_hz[2];    //? 0表示不发声（两个都为0即休止）
+    uint16_t on_ms;
+    uint16_t off_ms;
+} audio_synth_step_t;
+
+//? 序列
+typedef struct {
+    const audio_synth_step_t *steps;
+    uint16_t count;
+    uint16_t repeat;        //? 额外重复次数
+    audio_synth_wave_t wave;
+    audio_synth_adsr_t adsr;
+    int16_t level;          //? 每个音的幅度，Q15
+} audio_synth_seq_t;
+
+//? 内置序列
+extern const audio_synth_seq_t audio_synth_seq_chime;      //? 门铃（叮-咚）
+extern const audio_synth_seq_t audio_synth_seq_alert;      //? 警示（三声短促方波，重复一次）
+extern const audio_synth_seq_t audio_synth_seq_success;    //? 成功（上行三音）
+extern const audio_synth_seq_t audio_synth_seq_error;      //? 错误（两声低音）
+
+//? 包络阶段
+typedef enum {
+    AUDIO_SYNTH_ENV_IDLE = 0,
+    AUDIO_SYNTH_ENV_ATTACK,
+    AUDIO_SYNTH_ENV_DECAY,
+    AUDIO_SYNTH_ENV_SUSTAIN,
+    AUDIO_SYNTH_ENV_RELEASE,
+} audio_synth_env_stage_t;
+
+//? 单个音符：振荡器 + 包络
+typedef struct {
+    const int16_t *table;
+    uint32_t phase;             //? 相位累加器，满量程 2^32 为一个周期
+    uint32_t inc;               //? 每样本相位增量 = f * 2^32 / fs
+    int16_t level;              //? Q15
+    audio_synth_env_stage_t stage;
+    int32_t env;                //? 包络电平，Q30
+    int32_t attack_inc;         //? 起音每样本增量，Q30
+    int32_t decay_coef;         //? 衰减/释音每样本保留比例，Q30
+    int32_t release_coef;
+    int32_t sustain;            //? Q30
+} audio_synth_voice_t;
+
+//? 合成器状态（由调用者分配）
+typedef struct {
+    uint32_t fs;
+    audio_synth_voice_t voice[AUDIO_SYNTH_MAX_VOICES];
+    //? 序列器
+    audio_synth_seq_t seq;
+    bool seq_active;
+    bool seq_gate;              //? true: 当前步发声中；false: 步间间隔
+    uint16_t step;
+    uint16_t repeat_left;
+    uint32_t event_left;        //? 距下一个序列事件的样本数
+    int8_t seq_voice[2];        //? 当前步占用的音符
+    audio_synth_step_t dtmf[AUDIO_SYNTH_DTMF_MAX];
+} audio_synth_t;
+
+//? 初始化合成器（首次调用时生成波表）
+void audio_synth_init(audio_synth_t *s, uint32_t fs);
+
+//? 修改采样率：停止所有音符和序列
+void audio_synth_set_sample_rate(audio_synth_t *s, uint32_t fs);
+
+//? 开始一个音符
+//? @param freq_hz 频率（0 < freq_hz < fs/2）
+//? @param adsr 包络参数，NULL表示无包络（5ms起音与释音，防止爆音）
+//? @param level 幅度，Q15
+//? @return 音符编号，参数无效时返回-1；音符已满时抢占最早进入释音的音符
+int audio_synth_note_on(audio_synth_t *s, float freq_hz, audio_synth_wave_t wave,
+                        const audio_synth_adsr_t *adsr, int16_t level);
+
+//? 音符进入释音阶段
+void audio_synth_note_off(audio_synth_t *s, int voice);
+
+//? 所有音符进入释音，并停止序列
+void audio_synth_stop(audio_synth_t *s);
+
+//? 播放序列（替换正在播放的序列），序列内容被复制，steps 须在播放期间保持有效
+void audio_synth_play(audio_synth_t *s, const audio_synth_seq_t *seq);
+
+//? 播放DTMF按键音（0-9 * # A-D，其他字符忽略）
+//? @param on_ms / off_ms 每个按键的发声与间隔时长（标准最短40ms）
+//? @return 接受的按键数
+size_t audio_synth_play_dtmf(audio_synth_t *s, const char *digits, uint16_t on_ms, uint16_t off_ms);
+
+//? 查询DTMF按键的行/列频率
+//? @return false 不是DTMF按键
+bool audio_synth_dtmf_freq(char key, uint16_t *row_hz, uint16_t *col_hz);
+
+//? 序列播放中或仍有音符在发声
+bool audio_synth_busy(const audio_synth_t *s);
+
+//? 生成交织样本（各声道相同），空闲时输出静音
+//? @param channels 声道数
+//? @return 生成的帧数（总是等于 frames）
+size_t audio_synth_render_s32(audio_synth_t *s, int32_t *out, size_t frames, uint8_t channels);
+size_t audio_synth_render_s16(audio_synth_t *s, int16_t *out, size_t frames, uint8_t channels);
+
+#endif
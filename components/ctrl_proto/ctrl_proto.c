@@ -0,0 +1,267 @@
+#include "ctrl_proto.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+static const char *const s_verb_names[CTRL_VERB_COUNT] = {
+    [CTRL_VERB_UNKNOWN] = "unknown",
+    [CTRL_VERB_GAIN] = "gain",
+    [CTRL_VERB_GATE] = "gate",
+    [CTRL_VERB_PLAY] = "play",
+    [CTRL_VERB_STOP] = "stop",
+    [CTRL_VERB_RATE] = "rate",
+    [CTRL_VERB_CODEC] = "codec",
+    [CTRL_VERB_STATS] = "stats",
+    [CTRL_VERB_CONFIG] = "config",
+};
+
+static inline bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static inline bool is_sep(char c)
+{
+    return c == ';' || c == '\n' || c == '\0';
+}
+
+//? ==================== 解析 ====================
+
+void ctrl_parser_init(ctrl_parser_t *ps, const char *msg, size_t len)
+{
+    ps->p = msg;
+    ps->end = msg + len;
+}
+
+//? 取当前命令中的下一个单词，到命令结尾返回false（不越过分隔符）
+static bool next_word(ctrl_parser_t *ps, ctrl_token_t *t)
+{
+    while (ps->p < ps->end && is_space(*ps->p)) {
+        ps->p++;
+    }
+    if (ps->p >= ps->end || is_sep(*ps->p)) {
+        return false;
+    }
+    t->p = ps->p;
+    while (ps->p < ps->end && !is_space(*ps->p) && !is_sep(*ps->p)) {
+        ps->p++;
+    }
+    t->len = (size_t)(ps->p - t->p);
+    return true;
+}
+
+bool ctrl_parser_next(ctrl_parser_t *ps, ctrl_cmd_t *cmd)
+{
+    while (ps->p < ps->end) {
+        memset(cmd, 0, sizeof(*cmd));
+        ctrl_token_t t;
+        bool have = next_word(ps, &t);
+        if (have && t.p[0] == '#') {
+            cmd->tag.p = t.p + 1;
+            cmd->tag.len = t.len - 1;
+            have = next_word(ps, &t);
+        }
+        if (have) {
+            cmd->name = t;
+            for (int v = CTRL_VERB_UNKNOWN + 1; v < CTRL_VERB_COUNT; v++) {
+                if (ctrl_token_eq(&t, s_verb_names[v])) {
+                    cmd->verb = (ctrl_verb_t)v;
+                    break;
+                }
+            }
+            while (next_word(ps, &t)) {
+                if (cmd->argc < CTRL_PROTO_MAX_ARGS) {
+                    cmd->argv[cmd->argc++] = t;
+                } else {
+                    cmd->too_many = true;
+                }
+            }
+        }
+        //? 越过分隔符
+        if (ps->p < ps->end) {
+            ps->p++;
+        }
+        if (have) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *ctrl_verb_name(ctrl_verb_t verb)
+{
+    return (unsigned)verb < CTRL_VERB_COUNT ? s_verb_names[verb] : s_verb_names[CTRL_VERB_UNKNOWN];
+}
+
+bool ctrl_token_eq(const ctrl_token_t *t, const char *s)
+{
+    return strlen(s) == t->len && memcmp(t->p, s, t->len) == 0;
+}
+
+int ctrl_token_enum(const ctrl_token_t *t, const char *const *names, int count)
+{
+    for (int i = 0; i < count; i++) {
+        if (names[i] != NULL && ctrl_token_eq(t, names[i])) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool ctrl_token_int(const ctrl_token_t *t, int32_t *out)
+{
+    size_t i = 0;
+    bool neg = false;
+    if (i < t->len && (t->p[i] == '-' || t->p[i] == '+')) {
+        neg = t->p[i] == '-';
+        i++;
+    }
+    if (i == t->len) {
+        return false;
+    }
+    int64_t v = 0;
+    for (; i < t->len; i++) {
+        char c = t->p[i];
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        v = v * 10 + (c - '0');
+        if (v > (int64_t)INT32_MAX + 1) {
+            return false;
+        }
+    }
+    v = neg ? -v : v;
+    if (v > INT32_MAX) {
+        return false;
+    }
+    *out = (int32_t)v;
+    return true;
+}
+
+bool ctrl_token_float(const ctrl_token_t *t, float *out)
+{
+    size_t i = 0;
+    bool neg = false;
+    if (i < t->len && (t->p[i] == '-' || t->p[i] == '+')) {
+        neg = t->p[i] == '-';
+        i++;
+    }
+    double v = 0.0, scale = 1.0;
+    bool dot = false, digits = false;
+    for (; i < t->len; i++) {
+        char c = t->p[i];
+        if (c == '.' && !dot) {
+            dot = true;
+        } else if (c >= '0' && c <= '9') {
+            digits = true;
+            if (dot) {
+                scale *= 0.1;
+                v += (c - '0') * scale;
+            } else {
+                v = v * 10.0 + (c - '0');
+            }
+        } else {
+            return false;
+        }
+    }
+    if (!digits) {
+        return false;
+    }
+    *out = (float)(neg ? -v : v);
+    return true;
+}
+
+//? ==================== 回复 ====================
+
+static void append(ctrl_reply_t *r, const char *fmt, ...)
+{
+    if (r->overflow) {
+        return;
+    }
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(r->buf + r->len, r->size - r->len, fmt, ap);
+    va_end(ap);
+    if (n < 0 || (size_t)n >= r->size - r->len) {
+        r->overflow = true;
+        return;
+    }
+    r->len += (size_t)n;
+}
+
+//? 追加JSON字符串内容：转义引号和反斜杠，控制字符替换为 '?'
+static void append_escaped(ctrl_reply_t *r, const char *s, size_t len)
+{
+    for (size_t i = 0; i < len && !r->overflow; i++) {
+        char c = s[i];
+        if (c == '"' || c == '\\') {
+            append(r, "\\%c", c);
+        } else if ((unsigned char)c < 0x20) {
+            append(r, "?");
+        } else {
+            append(r, "%c", c);
+        }
+    }
+}
+
+static void append_key(ctrl_reply_t *r, const char *key)
+{
+    append(r, ",\"%s\":", key);
+}
+
+void ctrl_reply_begin(ctrl_reply_t *r, char *buf, size_t size, const ctrl_cmd_t *cmd, const char *error)
+{
+    r->buf = buf;
+    r->size = size;
+    r->len = 0;
+    r->overflow = size == 0;
+    r->cmd = cmd;
+
+    append(r, "{\"cmd\":\"");
+    append_escaped(r, cmd->name.p, cmd->name.len);
+    append(r, "\"");
+    if (cmd->tag.len > 0) {
+        append(r, ",\"id\":\"");
+        append_escaped(r, cmd->tag.p, cmd->tag.len);
+        append(r, "\"");
+    }
+    append(r, ",\"ok\":%s", error == NULL ? "true" : "false");
+    if (error != NULL) {
+        ctrl_reply_str(r, "error", error);
+    }
+}
+
+void ctrl_reply_int(ctrl_reply_t *r, const char *key, int64_t value)
+{
+    append_key(r, key);
+    append(r, "%lld", (long long)value);
+}
+
+void ctrl_reply_float(ctrl_reply_t *r, const char *key, float value)
+{
+    append_key(r, key);
+    append(r, "%.6g", (double)value);
+}
+
+void ctrl_reply_str(ctrl_reply_t *r, const char *key, const char *value)
+{
+    append_key(r, key);
+    append(r, "\"");
+    append_escaped(r, value, strlen(value));
+    append(r, "\"");
+}
+
+size_t ctrl_reply_end(ctrl_reply_t *r)
+{
+    append(r, "}");
+    if (r->overflow && r->size > 0) {
+        //? 按动词名称重写为错误回复（不再带标签，保证长度最短）
+        int n = snprintf(r->buf, r->size, "{\"cmd\":\"%s\",\"ok\":false,\"error\":\"reply too long\"}",
+                         ctrl_verb_name(r->cmd->verb));
+        r->len = (n > 0 && (size_t)n < r->size) ? (size_t)n : 0;
+        if (r->len == 0) {
+            r->buf[0] = '\0';
+        }
+    }
+    return r->len;
+}
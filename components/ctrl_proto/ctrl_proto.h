@@ -0,0 +1,110 @@
+#ifndef _CTRL_PROTO_H_
+#define _CTRL_PROTO_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+//? WebSocket文本帧控制协议
+//? 一帧可包含多条命令，以 ';' 或换行分隔；命令由空格分隔的单词组成，第一个为动词，其后为参数：
+//?   gain 2.5            设置音量增益（无参数时查询）
+//?   gate 800            设置噪声门限（0为关闭）
+//?   play 3 10 duck      播放声音ID 3，优先级10，模式 enqueue / preempt / duck（后两个参数可省略）
+//?   stop                停止播放
+//?   rate 16000          切换输出采样率
+//?   codec s16           上行采集格式 s32 / s24 / s16（保留，当前固件没有上行音频，回复 "not supported"）
+//?   stats               查询运行统计
+//?   config gain 2.5     修改运行时配置（只写键名为查询），config save 保存到NVS，config reset 恢复默认
+//? 命令前可加 "#标签"（如 "#7 gain 2"），回复中原样带回，便于对应请求。
+//? 解析不分配内存、也不修改接收缓冲区：命令和参数都是指向原缓冲区的片段（指针 + 长度）。
+//? 回复为单行JSON，如 {"cmd":"gain","id":"7","ok":true,"gain":2}，由调用者提供的缓冲区生成。
+//? 纯C实现，不依赖ESP-IDF，可在主机上编译测试（见 tools/ctrl_proto_test.c）
+
+//? 每条命令最多的参数个数（多余的参数使命令被拒绝）
+#ifndef CTRL_PROTO_MAX_ARGS
+#define CTRL_PROTO_MAX_ARGS     4
+#endif
+
+//? 动词
+typedef enum {
+    CTRL_VERB_UNKNOWN = 0,
+    CTRL_VERB_GAIN,
+    CTRL_VERB_GATE,
+    CTRL_VERB_PLAY,
+    CTRL_VERB_STOP,
+    CTRL_VERB_RATE,
+    CTRL_VERB_CODEC,
+    CTRL_VERB_STATS,
+    CTRL_VERB_CONFIG,
+    CTRL_VERB_COUNT,
+} ctrl_verb_t;
+
+//? 原缓冲区中的一个片段（不以0结尾）
+typedef struct {
+    const char *p;
+    size_t len;
+} ctrl_token_t;
+
+//? 一条命令
+typedef struct {
+    ctrl_verb_t verb;
+    ctrl_token_t name;          //? 动词原文（未知动词时用于回复）
+    ctrl_token_t tag;           //? "#标签" 去掉 '#' 后的部分，len为0表示没有
+    uint8_t argc;
+    bool too_many;              //? 参数超过 CTRL_PROTO_MAX_ARGS
+    ctrl_token_t argv[CTRL_PROTO_MAX_ARGS];
+} ctrl_cmd_t;
+
+//? 解析器：只保存当前位置
+typedef struct {
+    const char *p;
+    const char *end;
+} ctrl_parser_t;
+
+//? 回复生成器
+typedef struct {
+    char *buf;
+    size_t size;
+    size_t len;
+    bool overflow;
+    const ctrl_cmd_t *cmd;
+} ctrl_reply_t;
+
+//? 开始解析 msg 的 len 个字节
+void ctrl_parser_init(ctrl_parser_t *ps, const char *msg, size_t len);
+
+//? 取下一条命令（跳过空命令）
+//? @return false 没有更多命令
+bool ctrl_parser_next(ctrl_parser_t *ps, ctrl_cmd_t *cmd);
+
+//? 动词名称
+const char *ctrl_verb_name(ctrl_verb_t verb);
+
+//? 片段是否等于字符串
+bool ctrl_token_eq(const ctrl_token_t *t, const char *s);
+
+//? 十进制整数（可带符号）
+//? @return false 不是整数或超出int32范围
+bool ctrl_token_int(const ctrl_token_t *t, int32_t *out);
+
+//? 十进制小数（可带符号和小数点，不支持指数）
+bool ctrl_token_float(const ctrl_token_t *t, float *out);
+
+//? 在名称表中查找片段
+//? @return 下标，未找到返回-1
+int ctrl_token_enum(const ctrl_token_t *t, const char *const *names, int count);
+
+//? 开始一条回复：写入 "cmd"、"id"（有标签时）和 "ok"
+//? @param error NULL表示成功，否则写入 "error" 字段
+void ctrl_reply_begin(ctrl_reply_t *r, char *buf, size_t size, const ctrl_cmd_t *cmd, const char *error);
+
+//? 追加字段
+void ctrl_reply_int(ctrl_reply_t *r, const char *key, int64_t value);
+void ctrl_reply_float(ctrl_reply_t *r, const char *key, float value);
+void ctrl_reply_str(ctrl_reply_t *r, const char *key, const char *value);
+
+//? 结束回复
+//? @return 回复长度（不含结束符）；缓冲区不足时改写为 "reply too long" 错误回复
+size_t ctrl_reply_end(ctrl_reply_t *r);
+
+#endif
@@ -0,0 +1,149 @@
+#include "i2s_clock.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include <math.h>
+#include <string.h>
+
+//? 候选时钟源 {时钟源, 频率}
+typedef struct {
+    i2s_clock_src_t src;
+    uint32_t hz;
+} clk_source_t;
+
+static const clk_source_t s_sources[] = {
+#if SOC_I2S_SUPPORTS_PLL_F160M
+    {I2S_CLK_SRC_PLL_160M, 160000000},
+#endif
+#if SOC_I2S_SUPPORTS_XTAL
+    {I2S_CLK_SRC_XTAL, CONFIG_XTAL_FREQ * 1000000},
+#endif
+};
+
+static const i2s_mclk_multiple_t s_multiples[] = {
+    I2S_MCLK_MULTIPLE_256, I2S_MCLK_MULTIPLE_384, I2S_MCLK_MULTIPLE_512, I2S_MCLK_MULTIPLE_128,
+};
+
+//? 求 div 的最佳小数分频近似：integer + num/den，den < I2S_CLOCK_FRAC_DIV_MAX
+static void calc_frac_div(double div, uint32_t *integer, uint32_t *num, uint32_t *den)
+{
+    *integer = (uint32_t)div;
+    *num = 0;
+    *den = 1;
+    double frac = div - *integer;
+    if (frac < 1e-9) {
+        return;
+    }
+    
+    double best = 1.0;
+    for (uint32_t b = 2; b < I2S_CLOCK_FRAC_DIV_MAX; b++) {
+        uint32_t a = (uint32_t)lround(frac * b);
+        if (a == 0 || a >= b) {
+            continue;
+        }
+        double err = fabs((double)a / b - frac);
+        if (err < best) {
+            best = err;
+            *num = a;
+            *den = b;
+        }
+    }
+    //? 最接近整数时直接取整
+    if (frac < best) {
+        *num = 0;
+        *den = 1;
+    } else if (1.0 - frac < best) {
+        (*integer)++;
+        *num = 0;
+        *den = 1;
+    }
+}
+
+//? 为指定采样率选择最佳时钟配置
+esp_err_t i2s_clock_select(uint32_t sample_rate, uint32_t slot_bits, i2s_std_clk_config_t *clk_cfg, i2s_clock_info_t *info)
+{
+    i2s_clock_info_t best;
+    bool found = false;
+    
+    if (sample_rate == 0 || clk_cfg == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(&best, 0, sizeof(best));
+    
+    for (size_t s = 0; s < sizeof(s_sources) / sizeof(s_sources[0]); s++) {
+        for (size_t m = 0; m < sizeof(s_multiples) / sizeof(s_multiples[0]); m++) {
+            uint32_t multiple = s_multiples[m];
+            //? BCLK = 采样率 * 2 * slot位数，需由MCLK整数分频且分频系数至少为2
+            if (multiple % (2 * slot_bits) != 0 || multiple / (2 * slot_bits) < 2) {
+                continue;
+            }
+            double div = (double)s_sources[s].hz / ((double)sample_rate * multiple);
+            if (div < 2.0 || div >= 256.0) {
+                continue;
+            }
+            
+            i2s_clock_info_t c = {
+                .clk_src = s_sources[s].src,
+                .sclk_hz = s_sources[s].hz,
+                .mclk_multiple = multiple,
+            };
+            calc_frac_div(div, &c.div_integer, &c.div_numerator, &c.div_denominator);
+            double real_div = c.div_integer + (double)c.div_numerator / c.div_denominator;
+            c.actual_rate = s_sources[s].hz / real_div / multiple;
+            c.error_ppm = (float)((c.actual_rate / sample_rate - 1.0) * 1e6);
+            c.jitter_ns = c.div_numerator ? 1e9f / s_sources[s].hz : 0.0f;
+            
+            //? 先比误差（0.01ppm以内视为相同），再比抖动；候选顺序保证同等条件下优先默认组合
+            if (!found ||
+                fabsf(c.error_ppm) < fabsf(best.error_ppm) - 0.01f ||
+                (fabsf(c.error_ppm) < fabsf(best.error_ppm) + 0.01f && c.jitter_ns < best.jitter_ns)) {
+                best = c;
+                found = true;
+            }
+        }
+    }
+    
+#if SOC_I2S_SUPPORTS_APLL && I2S_CLOCK_ALLOW_APLL
+    //? APLL可编程到目标MCLK频率后整数分频，几乎无误差和分频抖动（实际频率以驱动日志为准）
+    if (!found || best.error_ppm != 0.0f || best.jitter_ns != 0.0f) {
+        memset(&best, 0, sizeof(best));
+        best.clk_src = I2S_CLK_SRC_APLL;
+        best.mclk_multiple = I2S_MCLK_MULTIPLE_256;
+        best.sclk_hz = sample_rate * 256;
+        best.div_integer = 1;
+        best.div_denominator = 1;
+        best.actual_rate = sample_rate;
+        found = true;
+    }
+#endif
+    
+    if (!found) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    
+    i2s_std_clk_config_t cfg = I2S_STD_CLK_DEFAULT_CONFIG(sample_rate);
+    cfg.clk_src = best.clk_src;
+    cfg.mclk_multiple = best.mclk_multiple;
+    *clk_cfg = cfg;
+    if (info) {
+        *info = best;
+    }
+    return ESP_OK;
+}
+
+//? 打印选择结果
+void i2s_clock_log(const char *tag, const i2s_clock_info_t *info)
+{
+    const char *name = "PLL_160M";
+    if (info->clk_src == I2S_CLK_SRC_XTAL) {
+        name = "XTAL";
+    }
+#if SOC_I2S_SUPPORTS_APLL
+    if (info->clk_src == I2S_CLK_SRC_APLL) {
+        name = "APLL";
+    }
+#endif
+    ESP_LOGI(tag, "I2S clock: %s, MCLK x%d, div %lu+%lu/%lu, actual %.3f Hz (%+.2f ppm), jitter %.2f ns",
+             name, (int)info->mclk_multiple, (unsigned long)info->div_integer,
+             (unsigned long)info->div_numerator, (unsigned long)info->div_denominator,
+             info->actual_rate, info->error_ppm, info->jitter_ns);
+}
@@ -0,0 +1,46 @@
+#ifndef _I2S_CLOCK_H_
+#define _I2S_CLOCK_H_
+
+#include <stdint.h>
+#include "driver/i2s_std.h"
+#include "soc/soc_caps.h"
+
+//? I2S时钟源选择
+//? I2S_STD_CLK_DEFAULT_CONFIG 固定使用默认时钟源和256倍MCLK，44.1kHz等采样率需要小数分频，
+//? 小数分频使MCLK周期在N和N+1个源时钟之间交替（抖动约为1个源时钟周期），分母受限时还有频率误差。
+//? 本模块对所有可用时钟源和MCLK倍数按HAL的小数分频方式估算实际采样率，
+//? 选出误差最小、抖动最低的组合，并返回实际采样率供抖动缓冲和重采样使用
+
+//? 是否允许使用APLL（仅部分芯片支持，ESP32-S3没有APLL；APLL与其他外设共享，多个I2S采样率不同时会冲突）
+#ifndef I2S_CLOCK_ALLOW_APLL
+#define I2S_CLOCK_ALLOW_APLL    1
+#endif
+
+//? 小数分频分母上限（与HAL一致）
+#define I2S_CLOCK_FRAC_DIV_MAX  512
+
+//? 选择结果
+typedef struct {
+    i2s_clock_src_t clk_src;            //? 时钟源
+    uint32_t sclk_hz;                   //? 源时钟频率
+    i2s_mclk_multiple_t mclk_multiple;  //? MCLK倍数
+    uint32_t div_integer;               //? MCLK分频整数部分
+    uint32_t div_numerator;             //? 小数部分分子（0表示整数分频）
+    uint32_t div_denominator;           //? 小数部分分母
+    double actual_rate;                 //? 估算的实际采样率（Hz）
+    float error_ppm;                    //? 相对标称采样率的误差（ppm）
+    float jitter_ns;                    //? 小数分频引起的MCLK周期抖动（ns），整数分频为0
+} i2s_clock_info_t;
+
+//? 为指定采样率选择最佳时钟配置
+//? @param sample_rate 标称采样率
+//? @param slot_bits 每个slot的位数（16/32），用于保证BCLK可由MCLK整数分频得到
+//? @param clk_cfg 输出：可直接用于 i2s_channel_init_std_mode / i2s_channel_reconfig_std_clock
+//? @param info 输出：选择结果与实际采样率，可为NULL
+//? @return ESP_OK 成功, ESP_ERR_NOT_SUPPORTED 没有可用组合
+esp_err_t i2s_clock_select(uint32_t sample_rate, uint32_t slot_bits, i2s_std_clk_config_t *clk_cfg, i2s_clock_info_t *info);
+
+//? 打印选择结果
+void i2s_clock_log(const char *tag, const i2s_clock_info_t *info);
+
+#endif
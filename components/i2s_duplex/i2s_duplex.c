@@ -0,0 +1,67 @@
+#include "i2s_duplex.h"
+#include "MAX98367A.h"
+#include "INMP441.h"
+#include "esp_log.h"
+
+static const char *TAG = "I2S_DUPLEX";
+
+static i2s_chan_handle_t s_tx = NULL;
+static i2s_chan_handle_t s_rx = NULL;
+
+//? 功放切换采样率后同步麦克风：控制器时钟已由TX改好，RX侧更新自身记录并淡入
+static void on_rate_changed(uint32_t sample_rate, void *arg)
+{
+    esp_err_t ret = inmp441_set_sample_rate(sample_rate);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "RX follow %lu Hz failed: %s", (unsigned long)sample_rate, esp_err_to_name(ret));
+    }
+}
+
+esp_err_t i2s_duplex_init(void)
+{
+    if (s_tx != NULL) {
+        return ESP_OK;
+    }
+
+    //? TX和RX必须在同一次调用中创建，驱动才会把它们配置为共用时钟的全双工
+    i2s_chan_config_t chan_cfg = I2S_CHANNEL_DEFAULT_CONFIG(I2S_DUPLEX_PORT, I2S_ROLE_MASTER);
+    chan_cfg.dma_desc_num = I2S_DUPLEX_DMA_DESC_NUM;
+    chan_cfg.dma_frame_num = I2S_DUPLEX_DMA_FRAME_NUM;
+    chan_cfg.auto_clear = true;
+    esp_err_t ret = i2s_new_channel(&chan_cfg, &s_tx, &s_rx);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Create duplex channels failed: %s", esp_err_to_name(ret));
+        s_tx = s_rx = NULL;
+        return ret;
+    }
+
+    ret = max98367a_attach(s_tx, I2S_DUPLEX_DMA_DESC_NUM, I2S_DUPLEX_DMA_FRAME_NUM,
+                           I2S_DUPLEX_BCLK, I2S_DUPLEX_WS, on_rate_changed, NULL);
+    if (ret == ESP_OK) {
+        ret = inmp441_attach(s_rx, I2S_DUPLEX_DMA_DESC_NUM, I2S_DUPLEX_DMA_FRAME_NUM,
+                             I2S_DUPLEX_BCLK, I2S_DUPLEX_WS);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Attach failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    //? 两个驱动的初始采样率可能不同，以功放为准
+    ret = inmp441_set_sample_rate(max98367a_get_sample_rate());
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Full duplex on I2S%d, BCLK %d, WS %d, %lu Hz",
+             I2S_DUPLEX_PORT, I2S_DUPLEX_BCLK, I2S_DUPLEX_WS, (unsigned long)max98367a_get_sample_rate());
+    return ESP_OK;
+}
+
+esp_err_t i2s_duplex_set_sample_rate(uint32_t sample_rate)
+{
+    if (s_tx == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    //? RX由 on_rate_changed 跟随
+    return max98367a_set_sample_rate(sample_rate);
+}
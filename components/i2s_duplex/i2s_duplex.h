@@ -0,0 +1,40 @@
+#ifndef _I2S_DUPLEX_H_
+#define _I2S_DUPLEX_H_
+
+#include <stdint.h>
+#include "driver/i2s_std.h"
+#include "driver/gpio.h"
+
+//? 全双工模式：INMP441与MAX98367A共用一个I2S控制器和BCLK/WS
+//? 独立模式下麦克风（I2S_NUM_0）和功放（I2S_NUM_1）各自产生时钟，两者样本会相对漂移，不利于回声消除；
+//? 全双工模式下TX/RX由同一时钟驱动，样本逐帧锁定，并空出一个I2S控制器。
+//? 用 i2s_duplex_init() 代替 i2s_tx_init() + i2s_rx_init()，之后两个驱动的其余接口照常使用
+//? 接线：INMP441的SCK/WS与MAX98367A的BCLK/LRC并联到 I2S_DUPLEX_BCLK / I2S_DUPLEX_WS
+
+#ifndef I2S_DUPLEX_PORT
+#define I2S_DUPLEX_PORT     I2S_NUM_0
+#endif
+#ifndef I2S_DUPLEX_BCLK
+#define I2S_DUPLEX_BCLK     GPIO_NUM_3      //? 共用BCLK（沿用 MAX_BCLK）
+#endif
+#ifndef I2S_DUPLEX_WS
+#define I2S_DUPLEX_WS       GPIO_NUM_46     //? 共用WS（沿用 MAX_LRC）
+#endif
+
+//? DMA配置在创建通道时确定，全双工模式下运行时不可更改（两个通道必须同时创建）
+#ifndef I2S_DUPLEX_DMA_DESC_NUM
+#define I2S_DUPLEX_DMA_DESC_NUM     6
+#endif
+#ifndef I2S_DUPLEX_DMA_FRAME_NUM
+#define I2S_DUPLEX_DMA_FRAME_NUM    256
+#endif
+
+//? 初始化全双工I2S，以功放当前采样率启动
+//? @return ESP_OK 成功
+esp_err_t i2s_duplex_init(void);
+
+//? 切换共用采样率（功放先淡出排空，随后麦克风同步切换）
+//? @return ESP_OK 成功, ESP_ERR_INVALID_ARG 采样率超出范围, ESP_ERR_INVALID_STATE 未初始化
+esp_err_t i2s_duplex_set_sample_rate(uint32_t sample_rate);
+
+#endif
@@ -1,6 +1,10 @@
 #include "wss_client.h"
 #include <errno.h>
+#include <stdatomic.h>
 #include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_random.h"
+#include "esp_timer.h"
 
 #define TAG "wss_client"
 
@@ -12,110 +16,206 @@ extern QueueHandle_t audio_playback_queue;  // WebSocket → 扬声器
 static int g_websocket_sock = -1;
 //? WebSocket配置,用于回调函数
 static const wss_client_config_t *g_config = NULL;
+//? 发送锁：音频帧与文本帧来自不同任务，整帧发送期间持有，避免两帧字节交错
+static SemaphoreHandle_t g_send_lock = NULL;
 
-//? 静态缓冲区（避免占用任务栈空间）
-static uint8_t g_send_audio_buffer[2048];    // 发送任务音频缓冲区
-static uint8_t g_send_frame_buffer[2200];    // 发送任务WebSocket帧缓冲区
-static uint8_t g_recv_buffer[2200];          // 接收任务数据缓冲区
+//? 限速日志：每个调用点在 WSS_LOG_INTERVAL_MS 内最多打印一次，并附带期间被抑制的条数
+//? 网络拥塞时避免告警刷屏UART，拖慢整个系统
+#define WSS_LOGW_RATELIMITED(fmt, ...) do {                                             \
+    static int64_t s_last_us = -(int64_t)WSS_LOG_INTERVAL_MS * 1000;                    \
+    static uint32_t s_suppressed = 0;                                                   \
+    int64_t now_us = esp_timer_get_time();                                              \
+    if (now_us - s_last_us >= (int64_t)WSS_LOG_INTERVAL_MS * 1000) {                    \
+        ESP_LOGW(TAG, fmt " (+%lu suppressed)", ##__VA_ARGS__, (unsigned long)s_suppressed); \
+        s_last_us = now_us;                                                             \
+        s_suppressed = 0;                                                               \
+    } else {                                                                            \
+        s_suppressed++;                                                                 \
+    }                                                                                   \
+} while (0)
+
+//? 单个队列的溢出策略与原子计数器
+typedef struct {
+    volatile wss_queue_policy_t policy;
+    volatile uint32_t block_timeout_ms;
+    _Atomic uint32_t pushed;
+    _Atomic uint32_t dropped_newest;
+    _Atomic uint32_t dropped_oldest;
+    _Atomic uint32_t block_timeouts;
+    _Atomic uint32_t high_watermark;
+    uint8_t discard[WSS_AUDIO_BLOCK_SIZE];      // DROP_OLDEST 丢弃旧块用的暂存区（每个队列只有一个生产者）
+} wss_queue_ctl_t;
+
+static wss_queue_ctl_t g_queue_ctl[WSS_QUEUE_COUNT] = {
+    [WSS_QUEUE_CAPTURE]  = { .policy = WSS_CAPTURE_QUEUE_POLICY,  .block_timeout_ms = WSS_QUEUE_BLOCK_TIMEOUT_MS },
+    [WSS_QUEUE_PLAYBACK] = { .policy = WSS_PLAYBACK_QUEUE_POLICY, .block_timeout_ms = WSS_QUEUE_BLOCK_TIMEOUT_MS },
+};
+
+//? 连接与收发统计（原子计数器）
+static _Atomic uint32_t g_frames_sent;
+static _Atomic uint32_t g_blocks_sent;
+static _Atomic uint32_t g_send_errors;
+static _Atomic uint32_t g_frames_received;
+static _Atomic uint32_t g_blocks_received;
+static _Atomic uint32_t g_bad_frames;
+static _Atomic uint32_t g_reconnects;
+
+#define STAT_INC(counter)       atomic_fetch_add_explicit(&(counter), 1, memory_order_relaxed)
+#define STAT_ADD(counter, n)    atomic_fetch_add_explicit(&(counter), (n), memory_order_relaxed)
+#define STAT_LOAD(counter)      atomic_load_explicit(&(counter), memory_order_relaxed)
 
-//? 组包 WebSocket 二进制帧，返回帧长度
-static size_t build_websocket_binary_frame(const uint8_t *data, size_t data_len, uint8_t *frame_buf, size_t buf_size) 
+//? 按策略将一个音频块放入队列，返回是否入队成功
+static bool wss_queue_push(wss_queue_id_t id, QueueHandle_t queue, const void *block)
 {
-    size_t header_len = 6;  // 基础头：2字节 + 4字节掩码
+    wss_queue_ctl_t *ctl = &g_queue_ctl[id];
+    bool ok = false;
     
-    //? 根据数据长度确定帧头大小
-    if (data_len <= 125)
+    switch (ctl->policy)
     {
-        header_len = 6;  // 2 + 4
-    }
-    else if (data_len <= 65535)
-    {
-        header_len = 8;  // 2 + 2(扩展长度) + 4
-    }
-    else
-    {
-        header_len = 14;  // 2 + 8(扩展长度) + 4
+    case WSS_QUEUE_BLOCK:
+        ok = (xQueueSend(queue, block, pdMS_TO_TICKS(ctl->block_timeout_ms)) == pdPASS);
+        if (!ok)
+        {
+            STAT_INC(ctl->block_timeouts);
+            STAT_INC(ctl->dropped_newest);
+        }
+        break;
+        
+    case WSS_QUEUE_DROP_OLDEST:
+        ok = (xQueueSend(queue, block, 0) == pdPASS);
+        if (!ok)
+        {
+            //? 队列满：丢弃最旧块后重试一次（消费者可能同时取走数据，重试仍失败则丢弃新块）
+            if (xQueueReceive(queue, ctl->discard, 0) == pdTRUE)
+            {
+                STAT_INC(ctl->dropped_oldest);
+            }
+            ok = (xQueueSend(queue, block, 0) == pdPASS);
+            if (!ok)
+            {
+                STAT_INC(ctl->dropped_newest);
+            }
+        }
+        break;
+        
+    case WSS_QUEUE_DROP_NEWEST:
+    default:
+        ok = (xQueueSend(queue, block, 0) == pdPASS);
+        if (!ok)
+        {
+            STAT_INC(ctl->dropped_newest);
+        }
+        break;
     }
     
-    //? 检查缓冲区大小
-    if (buf_size < data_len + header_len) 
+    if (ok)
     {
-        ESP_LOGE(TAG, "Buffer too small: need %d, have %d", data_len + header_len, buf_size);
-        return 0;
+        STAT_INC(ctl->pushed);
+        
+        //? 更新队列深度高水位
+        uint32_t depth = uxQueueMessagesWaiting(queue);
+        uint32_t prev = STAT_LOAD(ctl->high_watermark);
+        while (depth > prev && !atomic_compare_exchange_weak(&ctl->high_watermark, &prev, depth))
+        {
+        }
     }
     
+    return ok;
+}
+
+//? 二进制帧头长度：2字节 + 2字节扩展长度 + 4字节掩码（音频帧总是 126 < len <= 65535）
+#define WS_BIN_HEADER_LEN       8
+//? 单帧最大音频负载（批量合并后）
+#define WSS_AUDIO_PAYLOAD_MAX   (WSS_AUDIO_BLOCK_SIZE * WSS_SEND_BATCH_MAX)
+
+_Static_assert(WSS_AUDIO_BLOCK_SIZE > 125, "audio block must use 16-bit extended length");
+_Static_assert(WSS_AUDIO_PAYLOAD_MAX <= 65535, "batched payload must fit 16-bit extended length");
+_Static_assert(WSS_AUDIO_BLOCK_SIZE % 4 == 0, "audio block must be word aligned");
+
+//? 静态缓冲区（避免占用任务栈空间）
+//? 发送帧缓冲区：音频块直接从队列读入帧头之后的位置，原地掩码，省去整帧拷贝
+static uint8_t g_send_frame_buffer[WS_BIN_HEADER_LEN + WSS_AUDIO_PAYLOAD_MAX] __attribute__((aligned(4)));
+static uint8_t g_recv_buffer[WSS_AUDIO_PAYLOAD_MAX + 1];    // 接收任务数据缓冲区（+1 用于文本帧结束符）
+static uint8_t g_text_frame_buffer[8 + WSS_TEXT_MAX];      // 文本帧缓冲区（帧头最长8字节），在发送锁内使用
+
+//? 原地组包 WebSocket 二进制帧：负载已位于 frame_buf + WS_BIN_HEADER_LEN，返回帧长度
+static size_t finalize_websocket_binary_frame(uint8_t *frame_buf, size_t data_len)
+{
     //? 第一个字节：FIN + OpCode
     frame_buf[0] = 0x82;  // FIN=1, RSV=0, OpCode=2 (binary)
+    frame_buf[1] = 0x80 | 126;  // MASK=1 + 126 (使用扩展长度)
+    frame_buf[2] = (data_len >> 8) & 0xFF;  // 高字节
+    frame_buf[3] = data_len & 0xFF;         // 低字节
     
-    //? 第二个字节及扩展长度
-    int mask_offset = 2;
-    if (data_len <= 125)
+    //? 生成随机掩码
+    uint32_t mask = esp_random();
+    memcpy(&frame_buf[4], &mask, 4);
+    
+    //? 按32位字掩码：掩码字与负载在内存中的字节顺序一致，任意字节序下都等价于 data[i] ^ mask[i % 4]
+    uint32_t *words = (uint32_t *)(frame_buf + WS_BIN_HEADER_LEN);
+    size_t word_count = data_len / 4;
+    for (size_t i = 0; i < word_count; ++i) 
     {
-        frame_buf[1] = 0x80 | data_len;  // MASK=1 + payload length
+        words[i] ^= mask;
     }
-    else if (data_len <= 65535)
+    const uint8_t *mask_bytes = (const uint8_t *)&mask;
+    for (size_t i = word_count * 4; i < data_len; ++i) 
     {
-        frame_buf[1] = 0x80 | 126;  // MASK=1 + 126 (使用扩展长度)
-        frame_buf[2] = (data_len >> 8) & 0xFF;  // 高字节
-        frame_buf[3] = data_len & 0xFF;         // 低字节
-        mask_offset = 4;
+        frame_buf[WS_BIN_HEADER_LEN + i] ^= mask_bytes[i % 4];
     }
-    else
+    
+    return WS_BIN_HEADER_LEN + data_len;
+}
+
+//? 发送完整缓冲区，处理部分发送，成功返回0
+static int send_all(int sock, const uint8_t *buf, size_t len)
+{
+    size_t sent = 0;
+    while (sent < len)
     {
-        frame_buf[1] = 0x80 | 127;  // MASK=1 + 127 (使用64位扩展长度)
-        //? 填充 8 字节长度（大端序）
-        for (int i = 0; i < 8; i++)
+        int ret = send(sock, buf + sent, len - sent, 0);
+        if (ret <= 0)
         {
-            frame_buf[2 + i] = (data_len >> (56 - i * 8)) & 0xFF;
+            return -1;
         }
-        mask_offset = 10;
-    }
-    
-    //? 生成随机掩码
-    uint8_t mask[4];
-    for (int i = 0; i < 4; ++i) 
-    {
-        mask[i] = esp_random() & 0xFF;
-    }
-    memcpy(&frame_buf[mask_offset], mask, 4);
-    
-    //? 对数据进行掩码处理
-    int data_offset = mask_offset + 4;
-    for (size_t i = 0; i < data_len; ++i) 
-    {
-        frame_buf[data_offset + i] = data[i] ^ mask[i % 4];
+        sent += ret;
     }
-    
-    return data_offset + data_len;
+    return 0;
 }
 
-//? 组包 WebSocket 文本帧，返回帧长度
-static size_t build_websocket_frame(const char *msg, uint8_t *frame_buf, size_t buf_size) 
+//? 组包 WebSocket 文本帧，返回帧长度，缓冲区不足返回0
+static size_t build_websocket_frame(const char *msg, size_t msg_len, uint8_t *frame_buf, size_t buf_size) 
 {
-    size_t msg_len = strlen(msg);
-    if (buf_size < msg_len + 6) 
+    size_t header_len = msg_len < 126 ? 6 : 8;
+    if (msg_len > 65535 || buf_size < msg_len + header_len) 
     {
         return 0;   // 缓冲区不足
     }
     
     frame_buf[0] = 0x81;                        // FIN + text frame
-    frame_buf[1] = 0x80 | (msg_len & 0x7F);     // MASK bit + payload len
-    
-    //? 生成随机掩码
-    uint8_t mask[4];
-    for (int i = 0; i < 4; ++i) 
+    if (msg_len < 126) 
     {
-        mask[i] = esp_random() & 0xFF;
+        frame_buf[1] = 0x80 | msg_len;          // MASK bit + payload len
+    } 
+    else 
+    {
+        frame_buf[1] = 0x80 | 126;              // MASK bit + 16位扩展长度
+        frame_buf[2] = (msg_len >> 8) & 0xFF;
+        frame_buf[3] = msg_len & 0xFF;
     }
-    memcpy(&frame_buf[2], mask, 4);
+    
+    //? 生成随机掩码
+    uint32_t mask = esp_random();
+    uint8_t *mask_bytes = &frame_buf[header_len - 4];
+    memcpy(mask_bytes, &mask, 4);
     
     //? 对消息内容进行掩码处理
     for (size_t i = 0; i < msg_len; ++i) 
     {
-        frame_buf[6 + i] = msg[i] ^ mask[i % 4];
+        frame_buf[header_len + i] = msg[i] ^ mask_bytes[i % 4];
     }
     
-    return msg_len + 6;
+    return msg_len + header_len;
 }
 
 //? 解析WebSocket URI，提取主机名、端口和路径
@@ -151,8 +251,76 @@ static void parse_websocket_uri(const char *uri, char *host, int *port, char *pa
     }
 }
 
+//? 默认socket选项（config->sock_opts为NULL时使用）
+static const wss_socket_opts_t s_default_sock_opts = WSS_SOCKET_OPTS_DEFAULT();
+
+//? 应用socket选项，单项失败只打印警告，不影响连接
+static void apply_socket_options(int sock, const wss_socket_opts_t *opts)
+{
+    int val;
+
+    //? 设置socket超时
+    struct timeval timeout;
+    timeout.tv_sec = opts->timeout_sec;
+    timeout.tv_usec = 0;
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    //? 禁用Nagle：2KB音频帧和短文本帧不再等待ACK合并
+    val = opts->tcp_nodelay ? 1 : 0;
+    if (setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &val, sizeof(val)) != 0)
+    {
+        ESP_LOGW(TAG, "TCP_NODELAY not applied, errno: %d", errno);
+    }
+
+    if (opts->sndbuf > 0)
+    {
+        val = opts->sndbuf;
+        if (setsockopt(sock, SOL_SOCKET, SO_SNDBUF, &val, sizeof(val)) != 0)
+        {
+            ESP_LOGW(TAG, "SO_SNDBUF not supported, errno: %d", errno);
+        }
+    }
+
+    if (opts->rcvbuf > 0)
+    {
+        val = opts->rcvbuf;
+        if (setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &val, sizeof(val)) != 0)
+        {
+            ESP_LOGW(TAG, "SO_RCVBUF not supported (enable CONFIG_LWIP_SO_RCVBUF), errno: %d", errno);
+        }
+    }
+
+    //? Keepalive：尽早发现半开连接，触发重连
+    val = opts->keepalive ? 1 : 0;
+    setsockopt(sock, SOL_SOCKET, SO_KEEPALIVE, &val, sizeof(val));
+    if (opts->keepalive)
+    {
+        val = opts->keepidle_sec;
+        setsockopt(sock, IPPROTO_TCP, TCP_KEEPIDLE, &val, sizeof(val));
+        val = opts->keepintvl_sec;
+        setsockopt(sock, IPPROTO_TCP, TCP_KEEPINTVL, &val, sizeof(val));
+        val = opts->keepcnt;
+        setsockopt(sock, IPPROTO_TCP, TCP_KEEPCNT, &val, sizeof(val));
+    }
+
+    //? IP TOS/DSCP：让支持WMM的AP把语音包放入高优先级队列
+    if (opts->ip_tos > 0)
+    {
+        val = opts->ip_tos;
+        if (setsockopt(sock, IPPROTO_IP, IP_TOS, &val, sizeof(val)) != 0)
+        {
+            ESP_LOGW(TAG, "IP_TOS not applied, errno: %d", errno);
+        }
+    }
+
+    ESP_LOGI(TAG, "Socket opts: nodelay=%d sndbuf=%d rcvbuf=%d keepalive=%d(%d/%d/%d) tos=0x%02X",
+             opts->tcp_nodelay, opts->sndbuf, opts->rcvbuf, opts->keepalive,
+             opts->keepidle_sec, opts->keepintvl_sec, opts->keepcnt, opts->ip_tos);
+}
+
 //? WebSocket握手，返回socket文件描述符，失败返回-1
-static int websocket_handshake(const char *uri)
+static int websocket_handshake(const char *uri, const wss_socket_opts_t *opts)
 {
     char host[128] = {0};
     char path[128] = {0};
@@ -192,12 +360,8 @@ static int websocket_handshake(const char *uri)
         return -1;
     }
     
-    //? 设置socket超时
-    struct timeval timeout;
-    timeout.tv_sec = 10;
-    timeout.tv_usec = 0;
-    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
-    setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    //? 设置socket选项（缓冲区大小需在connect之前设置）
+    apply_socket_options(sock, opts);
     
     //? 连接到服务器
     ESP_LOGI(TAG, "Attempting to connect to %s:%d", host, port);
@@ -250,7 +414,11 @@ static int websocket_handshake(const char *uri)
 //? WebSocket发送任务
 static void wss_send_task(void *param)
 {
-    int send_count = 0;
+    int send_count = 0;                 // 已发送WebSocket帧数
+    uint32_t block_count = 0;           // 已发送音频块数
+    int64_t window_start_us = esp_timer_get_time();
+    uint32_t window_blocks = 0;
+    uint8_t *payload = g_send_frame_buffer + WS_BIN_HEADER_LEN;
     
     while (1)
     {
@@ -259,41 +427,62 @@ static void wss_send_task(void *param)
         {
             vTaskDelay(pdMS_TO_TICKS(100));
             send_count = 0;  // 重置计数器
+            block_count = 0;
             continue;
         }
         
-        //? 从队列读取完整音频帧（阻塞，超时100ms）
-        if (xQueueReceive(audio_data_queue, g_send_audio_buffer, pdMS_TO_TICKS(100)) == pdTRUE)
+        //? 从队列读取首个音频块，直接写入帧缓冲区负载位置（阻塞，超时100ms）
+        if (xQueueReceive(audio_data_queue, payload, pdMS_TO_TICKS(100)) != pdTRUE)
         {
-            //? 将音频数据封装成WebSocket二进制帧
-            size_t frame_len = build_websocket_binary_frame(g_send_audio_buffer, 2048, g_send_frame_buffer, 2200);
-            if (frame_len > 0) 
+            continue;
+        }
+        
+        //? 自适应批量：仅当队列已有积压时，把后续块合并进同一帧
+        int batch = 1;
+        if (WSS_SEND_BATCH_MAX > 1 && uxQueueMessagesWaiting(audio_data_queue) > 0)
+        {
+            TickType_t start = xTaskGetTickCount();
+            TickType_t max_wait = pdMS_TO_TICKS(WSS_SEND_BATCH_MAX_WAIT_MS);
+            while (batch < WSS_SEND_BATCH_MAX)
             {
-                int ret = send(g_websocket_sock, g_send_frame_buffer, frame_len, 0);
-                if (ret > 0)
-                {
-                    send_count++;
-                    if (send_count % 50 == 0)  // 每 50 个包打印一次日志
-                    {
-                        ESP_LOGI(TAG, "Sent %d audio frames (frame_len=%zu, data_size=2048)", send_count, frame_len);
-                    }
-                }
-                else
+                TickType_t elapsed = xTaskGetTickCount() - start;
+                TickType_t wait = (elapsed < max_wait) ? (max_wait - elapsed) : 0;
+                if (xQueueReceive(audio_data_queue, payload + batch * WSS_AUDIO_BLOCK_SIZE, wait) != pdTRUE)
                 {
-                    ESP_LOGE(TAG, "Send failed after %d packets, errno: %d", send_count, errno);
-                    g_websocket_sock = -1;  // 标记连接断开，触发重连
+                    break;
                 }
+                batch++;
             }
-            else
+        }
+        
+        //? 原地封装成WebSocket二进制帧并发送
+        size_t frame_len = finalize_websocket_binary_frame(g_send_frame_buffer, batch * WSS_AUDIO_BLOCK_SIZE);
+        xSemaphoreTake(g_send_lock, portMAX_DELAY);
+        int sent = send_all(g_websocket_sock, g_send_frame_buffer, frame_len);
+        xSemaphoreGive(g_send_lock);
+        if (sent == 0)
+        {
+            STAT_INC(g_frames_sent);
+            STAT_ADD(g_blocks_sent, batch);
+            send_count++;
+            block_count += batch;
+            window_blocks += batch;
+            if (send_count % 50 == 0)  // 每 50 个包打印一次日志
             {
-                ESP_LOGE(TAG, "Failed to build WebSocket frame");
+                int64_t now_us = esp_timer_get_time();
+                int64_t elapsed_us = now_us - window_start_us;
+                ESP_LOGI(TAG, "Sent %d frames / %lu blocks (avg batch %.2f, %.1f KB/s)",
+                         send_count, (unsigned long)block_count, (float)block_count / send_count,
+                         elapsed_us > 0 ? (float)window_blocks * WSS_AUDIO_BLOCK_SIZE / 1024.0f * 1000000.0f / elapsed_us : 0.0f);
+                window_start_us = now_us;
+                window_blocks = 0;
             }
-            vTaskDelay(pdMS_TO_TICKS(3));
         }
         else
         {
-            //? 队列为空，避免空转占用CPU
-            vTaskDelay(pdMS_TO_TICKS(50));
+            STAT_INC(g_send_errors);
+            ESP_LOGE(TAG, "Send failed after %d packets, errno: %d", send_count, errno);
+            g_websocket_sock = -1;  // 标记连接断开，触发重连
         }
     }
     
@@ -304,8 +493,6 @@ static void wss_send_task(void *param)
 //? WebSocket接收任务
 static void wss_recv_task(void *param)
 {
-    int recv_count = 0;
-    
     while (1)
     {
         //? 检查socket是否有效
@@ -352,7 +539,7 @@ static void wss_recv_task(void *param)
         }
         
         //? 接收数据（分块接收大数据）
-        if (payload_len > 0 && payload_len <= 2200) 
+        if (payload_len > 0 && payload_len <= WSS_AUDIO_PAYLOAD_MAX) 
         {
             int received = 0;
             while (received < payload_len)
@@ -386,23 +573,21 @@ static void wss_recv_task(void *param)
                 }
                 else if (opcode == 0x02)  // 二进制帧（回显的音频数据）
                 {
-                    recv_count++;
+                    STAT_INC(g_frames_received);
                     
-                    //? 只处理完整的2048字节音频帧
-                    if (received == 2048) {
-                        //? 将完整音频帧放入播放队列
-                        if (audio_playback_queue != NULL) {
-                            //? 发送到播放队列，如果队列满则等待50ms
-                            if (xQueueSend(audio_playback_queue, g_recv_buffer, pdMS_TO_TICKS(50)) != pdPASS) {
-                                ESP_LOGW(TAG, "Playback queue full, dropping audio frame");
-                            } else {
-                                // if (recv_count % 50 == 0) {
-                                //     ESP_LOGI(TAG, "Received %d audio frames (2048 bytes each)", recv_count);
-                                // }
+                    //? 只处理完整音频块（服务器可能回显合并后的批量帧，按块拆分）
+                    if (received % WSS_AUDIO_BLOCK_SIZE == 0) {
+                        //? 按播放队列溢出策略逐块入队
+                        for (int off = 0; off < received && audio_playback_queue != NULL; off += WSS_AUDIO_BLOCK_SIZE) {
+                            STAT_INC(g_blocks_received);
+                            if (!wss_queue_push(WSS_QUEUE_PLAYBACK, audio_playback_queue, g_recv_buffer + off)) {
+                                WSS_LOGW_RATELIMITED("Playback queue full, dropped %lu blocks so far",
+                                                     (unsigned long)STAT_LOAD(g_queue_ctl[WSS_QUEUE_PLAYBACK].dropped_newest));
                             }
                         }
                     } else {
-                        ESP_LOGW(TAG, "Received incomplete audio frame: %d bytes (expected 2048)", received);
+                        STAT_INC(g_bad_frames);
+                        WSS_LOGW_RATELIMITED("Received incomplete audio frame: %d bytes (expected multiple of %d)", received, WSS_AUDIO_BLOCK_SIZE);
                     }
                 }
                 else if (opcode == 0x08)  // 关闭帧
@@ -412,10 +597,11 @@ static void wss_recv_task(void *param)
                 }
             }
         }
-        else if (payload_len > 2200)
+        else if (payload_len > WSS_AUDIO_PAYLOAD_MAX)
         {
             //? 数据过大，分批丢弃
-            ESP_LOGW(TAG, "Payload too large (%d bytes), discarding", payload_len);
+            STAT_INC(g_bad_frames);
+            WSS_LOGW_RATELIMITED("Payload too large (%d bytes), discarding", payload_len);
             uint8_t tmp[128];
             int remaining = payload_len;
             while (remaining > 0)
@@ -453,6 +639,14 @@ static void wss_client_task(void *param)
         return;
     }
 
+    //? 重试时间：配置为0时使用编译期默认值
+    const uint32_t retry_interval_ms = config->retry_interval_ms ? config->retry_interval_ms : WSS_HANDSHAKE_RETRY_INTERVAL_MS;
+    const uint32_t reconnect_delay_ms = config->reconnect_delay_ms ? config->reconnect_delay_ms : WSS_RECONNECT_DELAY_MS;
+    const uint32_t failed_delay_ms = config->reconnect_delay_ms ? 2 * config->reconnect_delay_ms : WSS_RECONNECT_FAILED_DELAY_MS;
+
+    //? 是否已有过成功的连接：之后每次建立连接才计为重连
+    bool connected_before = false;
+
     //? 主循环：支持断线自动重连
     while (1)
     {
@@ -467,22 +661,26 @@ static void wss_client_task(void *param)
             if (retry_count > 0)
             {
                 ESP_LOGW(TAG, "Retry connection %d/%d", retry_count, WSS_HANDSHAKE_MAX_RETRY);
-                vTaskDelay(pdMS_TO_TICKS(WSS_HANDSHAKE_RETRY_INTERVAL_MS));
+                vTaskDelay(pdMS_TO_TICKS(retry_interval_ms));
             }
             
-            sock = websocket_handshake(config->uri);
+            sock = websocket_handshake(config->uri, config->sock_opts ? config->sock_opts : &s_default_sock_opts);
             retry_count++;
         }
         
         if (sock < 0)
         {
-            ESP_LOGE(TAG, "WebSocket handshake failed after %d retries, will retry in %d ms", 
-                     WSS_HANDSHAKE_MAX_RETRY, WSS_RECONNECT_FAILED_DELAY_MS);
-            vTaskDelay(pdMS_TO_TICKS(WSS_RECONNECT_FAILED_DELAY_MS));
+            ESP_LOGE(TAG, "WebSocket handshake failed after %d retries, will retry in %lu ms", 
+                     WSS_HANDSHAKE_MAX_RETRY, (unsigned long)failed_delay_ms);
+            vTaskDelay(pdMS_TO_TICKS(failed_delay_ms));
             continue;  // 继续外层循环，重新尝试连接
         }
         
         g_websocket_sock = sock;    // 保存socket供其他任务使用
+        if (connected_before) {
+            STAT_INC(g_reconnects);
+        }
+        connected_before = true;
         ESP_LOGI(TAG, "WebSocket connected successfully");
         
         //? 等待连接断开（socket被置为-1表示断开）
@@ -495,11 +693,11 @@ static void wss_client_task(void *param)
         if (sock >= 0)
         {
             close(sock);
-            ESP_LOGW(TAG, "WebSocket connection closed, will reconnect in %d ms...", WSS_RECONNECT_DELAY_MS);
+            ESP_LOGW(TAG, "WebSocket connection closed, will reconnect in %lu ms...", (unsigned long)reconnect_delay_ms);
         }
         
         //? 等待后自动重连
-        vTaskDelay(pdMS_TO_TICKS(WSS_RECONNECT_DELAY_MS));
+        vTaskDelay(pdMS_TO_TICKS(reconnect_delay_ms));
     }
     
     //? 理论上不会到达这里
@@ -514,6 +712,11 @@ void wss_client_start(const wss_client_config_t *config)
         return;
     }
     
+    if (g_send_lock == NULL)
+    {
+        g_send_lock = xSemaphoreCreateMutex();
+    }
+    
     //? 在Core 1上创建WebSocket主任务
     xTaskCreatePinnedToCore(wss_client_task, "wss_client", 8192, (void *)config, 3, NULL, 1);
     ESP_LOGI(TAG, "wss_client_task created");
@@ -527,3 +730,104 @@ void wss_client_start(const wss_client_config_t *config)
     ESP_LOGI(TAG, "wss_recv_task created");
 }
 
+esp_err_t wss_client_send_text(const char *msg, size_t len)
+{
+    if (msg == NULL || len > WSS_TEXT_MAX)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (g_send_lock == NULL || g_websocket_sock < 0)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    xSemaphoreTake(g_send_lock, portMAX_DELAY);
+    size_t frame_len = build_websocket_frame(msg, len, g_text_frame_buffer, sizeof(g_text_frame_buffer));
+    int sock = g_websocket_sock;
+    int ret = sock >= 0 ? send_all(sock, g_text_frame_buffer, frame_len) : -1;
+    xSemaphoreGive(g_send_lock);
+    
+    if (ret != 0)
+    {
+        STAT_INC(g_send_errors);
+        if (sock >= 0)
+        {
+            ESP_LOGE(TAG, "Send text failed, errno: %d", errno);
+            g_websocket_sock = -1;  // 标记连接断开，触发重连
+        }
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+void wss_client_set_queue_policy(wss_queue_id_t queue, wss_queue_policy_t policy, uint32_t block_timeout_ms)
+{
+    if (queue >= WSS_QUEUE_COUNT)
+    {
+        return;
+    }
+    g_queue_ctl[queue].block_timeout_ms = block_timeout_ms;
+    g_queue_ctl[queue].policy = policy;
+    ESP_LOGI(TAG, "Queue %d overflow policy: %d (block timeout %lu ms)", queue, policy, (unsigned long)block_timeout_ms);
+}
+
+bool wss_client_push_capture(const void *block)
+{
+    if (audio_data_queue == NULL || block == NULL)
+    {
+        return false;
+    }
+    
+    bool ok = wss_queue_push(WSS_QUEUE_CAPTURE, audio_data_queue, block);
+    if (!ok)
+    {
+        WSS_LOGW_RATELIMITED("Capture queue full, dropped %lu blocks so far",
+                             (unsigned long)STAT_LOAD(g_queue_ctl[WSS_QUEUE_CAPTURE].dropped_newest));
+    }
+    return ok;
+}
+
+void wss_client_get_stats(wss_client_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+    
+    for (int i = 0; i < WSS_QUEUE_COUNT; i++)
+    {
+        wss_queue_ctl_t *ctl = &g_queue_ctl[i];
+        stats->queue[i].pushed = STAT_LOAD(ctl->pushed);
+        stats->queue[i].dropped_newest = STAT_LOAD(ctl->dropped_newest);
+        stats->queue[i].dropped_oldest = STAT_LOAD(ctl->dropped_oldest);
+        stats->queue[i].block_timeouts = STAT_LOAD(ctl->block_timeouts);
+        stats->queue[i].high_watermark = STAT_LOAD(ctl->high_watermark);
+    }
+    stats->frames_sent = STAT_LOAD(g_frames_sent);
+    stats->blocks_sent = STAT_LOAD(g_blocks_sent);
+    stats->send_errors = STAT_LOAD(g_send_errors);
+    stats->frames_received = STAT_LOAD(g_frames_received);
+    stats->blocks_received = STAT_LOAD(g_blocks_received);
+    stats->bad_frames = STAT_LOAD(g_bad_frames);
+    stats->reconnects = STAT_LOAD(g_reconnects);
+}
+
+void wss_client_reset_stats(void)
+{
+    for (int i = 0; i < WSS_QUEUE_COUNT; i++)
+    {
+        wss_queue_ctl_t *ctl = &g_queue_ctl[i];
+        atomic_store(&ctl->pushed, 0);
+        atomic_store(&ctl->dropped_newest, 0);
+        atomic_store(&ctl->dropped_oldest, 0);
+        atomic_store(&ctl->block_timeouts, 0);
+        atomic_store(&ctl->high_watermark, 0);
+    }
+    atomic_store(&g_frames_sent, 0);
+    atomic_store(&g_blocks_sent, 0);
+    atomic_store(&g_send_errors, 0);
+    atomic_store(&g_frames_received, 0);
+    atomic_store(&g_blocks_received, 0);
+    atomic_store(&g_bad_frames, 0);
+    atomic_store(&g_reconnects, 0);
+}
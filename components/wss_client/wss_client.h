@@ -4,10 +4,12 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdbool.h>
 #include <unistd.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
+#include "esp_err.h"
 #include "lwip/sockets.h"
 #include "lwip/netdb.h"
 
@@ -61,6 +63,92 @@
 #define WSS_RECONNECT_FAILED_DELAY_MS  10000
 #endif
 
+//? ==================== 音频帧配置 ====================
+
+//? 音频队列中每个音频块的字节数（audio_data_queue / audio_playback_queue 的元素大小）
+#ifndef WSS_AUDIO_BLOCK_SIZE
+#define WSS_AUDIO_BLOCK_SIZE  2048
+#endif
+
+//? 批量发送：队列有积压时，单个WebSocket帧最多合并的音频块数（1=不合并）
+#ifndef WSS_SEND_BATCH_MAX
+#define WSS_SEND_BATCH_MAX  4
+#endif
+
+//? 批量发送最大等待时间（毫秒）
+//? 仅在取出首块时队列已有积压才会等待后续块凑批，空闲时首块立即发送，不增加延迟
+#ifndef WSS_SEND_BATCH_MAX_WAIT_MS
+#define WSS_SEND_BATCH_MAX_WAIT_MS  0
+#endif
+
+//? 文本帧（控制命令回复等）最大负载字节数
+#ifndef WSS_TEXT_MAX
+#define WSS_TEXT_MAX  512
+#endif
+
+//? ==================== 队列溢出策略 ====================
+
+//? 采集队列（麦克风 → WebSocket）溢出策略，取值见 wss_queue_policy_t
+//? 默认丢弃最旧块：网络卡顿恢复后优先发送最新音频
+#ifndef WSS_CAPTURE_QUEUE_POLICY
+#define WSS_CAPTURE_QUEUE_POLICY  WSS_QUEUE_DROP_OLDEST
+#endif
+
+//? 播放队列（WebSocket → 扬声器）溢出策略
+#ifndef WSS_PLAYBACK_QUEUE_POLICY
+#define WSS_PLAYBACK_QUEUE_POLICY  WSS_QUEUE_DROP_OLDEST
+#endif
+
+//? WSS_QUEUE_BLOCK 策略下的最长等待时间（毫秒），超时后丢弃新块
+#ifndef WSS_QUEUE_BLOCK_TIMEOUT_MS
+#define WSS_QUEUE_BLOCK_TIMEOUT_MS  50
+#endif
+
+//? 限速日志间隔（毫秒）：同一条告警在此间隔内最多打印一次
+#ifndef WSS_LOG_INTERVAL_MS
+#define WSS_LOG_INTERVAL_MS  2000
+#endif
+
+//? ==================== TCP Socket选项默认值 ====================
+//? wss_client_config_t.sock_opts 为NULL时使用以下默认值
+
+//? 禁用Nagle算法：小帧立即发出，不等待ACK合并（1=禁用Nagle，0=保持lwIP默认）
+#ifndef WSS_TCP_NODELAY
+#define WSS_TCP_NODELAY  1
+#endif
+
+//? 发送/接收缓冲区大小（字节），0表示保持lwIP默认
+//? 注意：lwIP需开启 CONFIG_LWIP_SO_RCVBUF 才支持 SO_RCVBUF，SO_SNDBUF 不支持时仅打印警告
+#ifndef WSS_SO_SNDBUF
+#define WSS_SO_SNDBUF  0
+#endif
+
+#ifndef WSS_SO_RCVBUF
+#define WSS_SO_RCVBUF  0
+#endif
+
+//? TCP Keepalive：空闲多少秒后开始探测、探测间隔（秒）、探测次数
+#ifndef WSS_TCP_KEEPALIVE
+#define WSS_TCP_KEEPALIVE  1
+#endif
+
+#ifndef WSS_TCP_KEEPIDLE_SEC
+#define WSS_TCP_KEEPIDLE_SEC  5
+#endif
+
+#ifndef WSS_TCP_KEEPINTVL_SEC
+#define WSS_TCP_KEEPINTVL_SEC  2
+#endif
+
+#ifndef WSS_TCP_KEEPCNT
+#define WSS_TCP_KEEPCNT  3
+#endif
+
+//? IP TOS字节，默认DSCP EF(46)用于语音：46 << 2 = 0xB8，0表示保持默认
+#ifndef WSS_IP_TOS
+#define WSS_IP_TOS  0xB8
+#endif
+
 //? DNS查询重试次数
 #ifndef WSS_DNS_MAX_RETRY
 #define WSS_DNS_MAX_RETRY  3
@@ -89,15 +177,105 @@
 extern "C" {
 #endif
 
+//? 文本帧回调（接收任务上下文），msg 以0结尾，仅在回调期间有效
 typedef void (*wss_on_message_cb)(const char *msg, size_t len);
 
+//? TCP socket选项，在connect()之前应用
+typedef struct {
+    bool tcp_nodelay;           //? true=禁用Nagle算法
+    int sndbuf;                 //? SO_SNDBUF（字节），0=lwIP默认
+    int rcvbuf;                 //? SO_RCVBUF（字节），0=lwIP默认
+    bool keepalive;             //? 是否开启TCP Keepalive
+    int keepidle_sec;           //? 空闲多久开始探测（秒）
+    int keepintvl_sec;          //? 探测间隔（秒）
+    int keepcnt;                //? 探测失败多少次判定断线
+    int ip_tos;                 //? IP TOS字节（DSCP << 2），0=默认
+    int timeout_sec;            //? SO_RCVTIMEO/SO_SNDTIMEO（秒），0=不超时
+} wss_socket_opts_t;
+
+//? 默认socket选项初始化宏
+#define WSS_SOCKET_OPTS_DEFAULT() {             \
+    .tcp_nodelay = WSS_TCP_NODELAY,             \
+    .sndbuf = WSS_SO_SNDBUF,                    \
+    .rcvbuf = WSS_SO_RCVBUF,                    \
+    .keepalive = WSS_TCP_KEEPALIVE,             \
+    .keepidle_sec = WSS_TCP_KEEPIDLE_SEC,       \
+    .keepintvl_sec = WSS_TCP_KEEPINTVL_SEC,     \
+    .keepcnt = WSS_TCP_KEEPCNT,                 \
+    .ip_tos = WSS_IP_TOS,                       \
+    .timeout_sec = WSS_TIMEOUT_SEC,             \
+}
+
 typedef struct {
     const char *uri;
     wss_on_message_cb on_message;
+    const wss_socket_opts_t *sock_opts;     //? socket选项，NULL表示使用默认值
+    uint32_t retry_interval_ms;             //? 握手重试间隔，0表示 WSS_HANDSHAKE_RETRY_INTERVAL_MS
+    uint32_t reconnect_delay_ms;            //? 断线后重连等待，握手全部失败后等待其2倍；0表示 WSS_RECONNECT_DELAY_MS / WSS_RECONNECT_FAILED_DELAY_MS
 } wss_client_config_t;
 
+//? 音频队列标识
+typedef enum {
+    WSS_QUEUE_CAPTURE = 0,      //? audio_data_queue：麦克风 → WebSocket
+    WSS_QUEUE_PLAYBACK,         //? audio_playback_queue：WebSocket → 扬声器
+    WSS_QUEUE_COUNT,
+} wss_queue_id_t;
+
+//? 队列满时的处理策略
+typedef enum {
+    WSS_QUEUE_DROP_NEWEST = 0,  //? 丢弃新块，保留队列中已有数据
+    WSS_QUEUE_DROP_OLDEST,      //? 丢弃最旧块，为新块腾出空间（延迟最低）
+    WSS_QUEUE_BLOCK,            //? 阻塞等待，超过截止时间后丢弃新块
+} wss_queue_policy_t;
+
+//? 单个队列的统计
+typedef struct {
+    uint32_t pushed;            //? 成功入队的块数
+    uint32_t dropped_newest;    //? 因队列满被丢弃的新块数（含阻塞超时）
+    uint32_t dropped_oldest;    //? 为腾出空间被丢弃的旧块数
+    uint32_t block_timeouts;    //? WSS_QUEUE_BLOCK 等待超时次数
+    uint32_t high_watermark;    //? 入队时观察到的最大队列深度
+} wss_queue_stats_t;
+
+//? WebSocket客户端统计
+typedef struct {
+    wss_queue_stats_t queue[WSS_QUEUE_COUNT];
+    uint32_t frames_sent;       //? 已发送WebSocket二进制帧数
+    uint32_t blocks_sent;       //? 已发送音频块数
+    uint32_t send_errors;       //? 发送失败次数
+    uint32_t frames_received;   //? 已接收二进制帧数
+    uint32_t blocks_received;   //? 已接收音频块数
+    uint32_t bad_frames;        //? 长度不是音频块整数倍或过大的帧数
+    uint32_t reconnects;        //? 断线后重新建立连接的次数（首次连接不计）
+} wss_client_stats_t;
+
+//? 启动客户端，config 在整个运行期间须保持有效
 void wss_client_start(const wss_client_config_t *config);
 
+//? 发送一个文本帧（可在任意任务中调用，包括 on_message 回调中回复）
+//? 与音频帧共用发送锁，整帧发出后才返回
+//? @param msg 文本内容（不要求以0结尾）
+//? @param len 字节数（不超过 WSS_TEXT_MAX）
+//? @return ESP_OK 成功, ESP_ERR_INVALID_SIZE 超长, ESP_ERR_INVALID_STATE 未连接, ESP_FAIL 发送失败（连接将重建）
+esp_err_t wss_client_send_text(const char *msg, size_t len);
+
+//? 设置队列溢出策略（运行时可调）
+//? @param queue 队列标识
+//? @param policy 溢出策略
+//? @param block_timeout_ms WSS_QUEUE_BLOCK 策略下的最长等待时间（毫秒）
+void wss_client_set_queue_policy(wss_queue_id_t queue, wss_queue_policy_t policy, uint32_t block_timeout_ms);
+
+//? 按采集队列策略将一个音频块（WSS_AUDIO_BLOCK_SIZE字节）放入 audio_data_queue
+//? 供麦克风采集任务调用，替代直接 xQueueSend
+//? @return true 已入队, false 新块被丢弃
+bool wss_client_push_capture(const void *block);
+
+//? 获取统计快照（各计数器为原子读取，可在任意任务中调用）
+void wss_client_get_stats(wss_client_stats_t *stats);
+
+//? 清零所有统计
+void wss_client_reset_stats(void);
+
 #ifdef __cplusplus
 }
 #endif
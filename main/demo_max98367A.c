@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -10,6 +11,14 @@
 #include "esp_log.h"
 
 #include "MAX98367A.h"
+#include "INMP441.h"
+#include "i2s_duplex.h"
+#include "audio_synth.h"
+#include "audio_player.h"
+#include "wifi_sta.h"
+#include "wss_client.h"
+#include "remote_control.h"
+#include "app_config.h"
 #include "audio_data.h"  // 包含音频数据头文件
 
 static const char *TAG = "AUDIO_DEMO";
@@ -20,7 +29,128 @@ static const char *TAG = "AUDIO_DEMO";
 #define TONE_DURATION_MS    3000    // 播放时长(毫秒)
 #define AMPLITUDE           (INT32_MAX / 4)  // 音量幅度
 
-// ...已移除正弦波生成函数...
+//? 置1时启动后先运行输出内核性能测试（32位/16位对比）
+#ifndef DEMO_RUN_BENCHMARK
+#define DEMO_RUN_BENCHMARK  0
+#endif
+
+//? 大于0时初始化后先做DMA延迟扫描，每组配置测量指定毫秒数
+#ifndef DEMO_LATENCY_SWEEP_MS
+#define DEMO_LATENCY_SWEEP_MS  0
+#endif
+
+//? 置1时功放与麦克风共用一个I2S控制器（需将两者的BCLK/WS并联），否则功放独立使用I2S_NUM_1
+#ifndef DEMO_FULL_DUPLEX
+#define DEMO_FULL_DUPLEX  0
+#endif
+
+//? 置1时启用扬声器校正均衡示例（切除小腔体无法重放的低频并补偿中高频）
+#ifndef DEMO_SPEAKER_EQ
+#define DEMO_SPEAKER_EQ  0
+#endif
+
+//? 置1时开机先播放一声 TONE_FREQUENCY 纯音，之后每次播放语音前播放门铃提示音（合成生成，不占Flash）
+#ifndef DEMO_PROMPT_TONES
+#define DEMO_PROMPT_TONES  1
+#endif
+
+//? 置1时演示压低：每轮语音播放中途以更高优先级叠加一段警示音，语音被压低后恢复
+#ifndef DEMO_PLAYER_DUCK
+#define DEMO_PLAYER_DUCK  0
+#endif
+
+//? 置1时连接WiFi和WebSocket服务器（WIFI_SSID / WSS_URI），接受文本帧控制命令（见 ctrl_proto.h）
+#ifndef DEMO_REMOTE_CONTROL
+#define DEMO_REMOTE_CONTROL  0
+#endif
+
+//? wss_client 使用的音频队列（本示例没有麦克风上行和网络下行播放，仅满足发送任务的等待）
+QueueHandle_t audio_data_queue = NULL;
+QueueHandle_t audio_playback_queue = NULL;
+
+//? 调度器中登记的声音ID
+enum {
+    SOUND_VOICE = 0,
+    SOUND_STARTUP,
+    SOUND_CHIME,
+    SOUND_ALERT,
+};
+
+//? 合成提示音：每个声音各自一个合成器，压低时可同时发声
+typedef struct {
+    audio_synth_t synth;
+    const audio_synth_seq_t *seq;
+} prompt_t;
+
+//? 开机提示：TONE_FREQUENCY 纯音，幅度 AMPLITUDE，时长 TONE_DURATION_MS
+static const audio_synth_step_t s_startup_step = {{(uint16_t)TONE_FREQUENCY, 0}, TONE_DURATION_MS, 0};
+static const audio_synth_seq_t s_startup_seq = {
+    &s_startup_step, 1, 0, AUDIO_SYNTH_SINE, {10, 0, 32767, 50}, (int16_t)(AMPLITUDE >> 16),
+};
+
+static prompt_t s_startup = { .seq = &s_startup_seq };
+static prompt_t s_chime = { .seq = &audio_synth_seq_chime };
+static prompt_t s_alert = { .seq = &audio_synth_seq_alert };
+
+//? 合成器作为拉模式音源：样本直接生成到输出块中，序列结束且音符释音完毕后返回0
+static size_t prompt_source(max98367a_sample_t *buf, size_t frames, void *arg)
+{
+    audio_synth_t *synth = &((prompt_t *)arg)->synth;
+    if (!audio_synth_busy(synth)) {
+        return 0;
+    }
+#if MAX98367A_BIT_WIDTH == 16
+    return audio_synth_render_s16(synth, buf, frames, MAX98367A_CHANNEL_NUM);
+#else
+    return audio_synth_render_s32(synth, buf, frames, MAX98367A_CHANNEL_NUM);
+#endif
+}
+
+//? 每次开始播放时按当前输出采样率重新开始序列
+static void prompt_open(void *arg)
+{
+    prompt_t *p = (prompt_t *)arg;
+    uint32_t fs = max98367a_get_sample_rate();
+    if (p->synth.fs != fs) {
+        audio_synth_init(&p->synth, fs);
+    }
+    audio_synth_play(&p->synth, p->seq);
+}
+
+static void register_prompt(uint16_t id, prompt_t *p)
+{
+    const audio_player_sound_t sound = { .source = prompt_source, .open = prompt_open, .arg = p };
+    audio_player_register(id, &sound);
+}
+
+//? 调度器状态回调（播放任务上下文）
+static void player_event(audio_player_event_t event, uint16_t id, uint32_t token, void *arg)
+{
+    static const char *names[] = {"开始", "结束", "被中断", "被丢弃"};
+    ESP_LOGI(TAG, "声音 %u (#%lu) %s", id, (unsigned long)token, names[event]);
+    if (id == SOUND_VOICE && event == AUDIO_PLAYER_EVT_END) {
+        max98367a_dma_stats_t st;
+        max98367a_get_dma_stats(&st);
+        ESP_LOGI(TAG, "播放完成: %lu 字节, 欠载 %lu 次 (%.2f 次/分钟), 最小余量 %lu 块",
+                 (unsigned long)audio_data_len, (unsigned long)st.underruns,
+                 st.underruns_per_min, (unsigned long)st.headroom_min_blocks);
+    }
+}
+
+//? 运行时配置变更（在修改配置的任务中调用）
+//? 增益和门限立即生效；DMA和网络参数在启动时读取，保存后重启生效
+static void config_changed(const app_config_t *cfg, uint32_t changed, void *arg)
+{
+    if (changed & APP_CONFIG_OUTPUT) {
+        max98367a_set_gain(cfg->gain);
+    }
+    if (changed & APP_CONFIG_INPUT) {
+        inmp441_set_noise_gate(cfg->noise_gate);
+    }
+    if (changed & (APP_CONFIG_DMA | APP_CONFIG_WIFI | APP_CONFIG_WSS)) {
+        ESP_LOGI(TAG, "DMA/网络配置已修改，保存后重启生效");
+    }
+}
 
 /**
  * @brief 播放预录制的“我爱你，中国”语音
@@ -28,15 +158,89 @@ static const char *TAG = "AUDIO_DEMO";
 void play_voice_task(void *pvParameters)
 {
     ESP_LOGI(TAG, "循环播放: 我爱你，中国");
+#if DEMO_FULL_DUPLEX
+    i2s_duplex_init();
+#else
     i2s_tx_init();
+#endif
+#if DEMO_LATENCY_SWEEP_MS > 0 && !DEMO_FULL_DUPLEX
+    max98367a_latency_sweep(DEMO_LATENCY_SWEEP_MS);
+#endif
+#if DEMO_SPEAKER_EQ
+    const max98367a_eq_band_t eq[] = {
+        { .type = MAX98367A_EQ_HIGHPASS, .freq_hz = 150.0f, .q = 0.707f },
+        { .type = MAX98367A_EQ_PEAKING, .freq_hz = 3000.0f, .gain_db = 4.0f, .q = 1.0f },
+    };
+    max98367a_set_eq(eq, sizeof(eq) / sizeof(eq[0]));
+#endif
+    
+    //? 应用运行时配置（NVS中保存的值，没有时为编译期默认值）
+    const app_config_t *cfg = app_config_get();
+#if !DEMO_FULL_DUPLEX
+    if (max98367a_set_dma_config(cfg->dma_desc_num, cfg->dma_frame_num) != ESP_OK) {
+        ESP_LOGW(TAG, "DMA配置 %ld x %ld 无效，保持默认", (long)cfg->dma_desc_num, (long)cfg->dma_frame_num);
+    }
+#endif
+    max98367a_set_gain(cfg->gain);
+    inmp441_set_noise_gate(cfg->noise_gate);
+    app_config_subscribe(APP_CONFIG_ALL, config_changed, NULL);
+    
+    //? 资源若已在构建时烘焙增益（AUDIO_DATA_PRESCALED），调度器抵消运行时音量
+    //? 调度器保存片段指针，描述须在整个运行期间有效
+    static max98367a_clip_t clip = {
+        .data = audio_data,
+        .flags = AUDIO_DATA_PRESCALED ? MAX98367A_CLIP_PRESCALED : 0,
+        .channels = AUDIO_DATA_CHANNELS,
+        .bits = AUDIO_DATA_BITS,
+        .sample_rate = AUDIO_DATA_SAMPLE_RATE,  //? 按资源原生采样率输出，不做重采样（全双工时麦克风随之切换）
+    };
+    clip.len = audio_data_len;
+    
+    //? 所有输出经由调度器：命令入队后由播放任务按优先级无缝衔接
+    ESP_ERROR_CHECK(audio_player_init(player_event, NULL));
+    audio_player_register(SOUND_VOICE, &(audio_player_sound_t){ .clip = &clip });
+    register_prompt(SOUND_STARTUP, &s_startup);
+    register_prompt(SOUND_CHIME, &s_chime);
+    register_prompt(SOUND_ALERT, &s_alert);
+    
+#if DEMO_PROMPT_TONES
+    audio_player_play(SOUND_STARTUP, 0, AUDIO_PLAYER_ENQUEUE, NULL);
+#endif
+
+#if DEMO_REMOTE_CONTROL
+    //? 远程命令经调度器执行，须在 audio_player_init() 之后连接
+    //? 客户端在整个运行期间引用配置和地址，复制一份，不直接指向会被替换的配置快照
+    cfg = app_config_get();
+    static char wss_uri[sizeof(cfg->wss_uri)];
+    static wss_client_config_t wss_cfg = { .uri = wss_uri, .on_message = remote_control_on_message };
+    strcpy(wss_uri, cfg->wss_uri);
+    wss_cfg.retry_interval_ms = cfg->wss_retry_ms;
+    wss_cfg.reconnect_delay_ms = cfg->wss_reconnect_ms;
+    audio_data_queue = xQueueCreate(2, WSS_AUDIO_BLOCK_SIZE);
+    ESP_ERROR_CHECK(wifi_sta_init(&(wifi_sta_config){ cfg->wifi_ssid, cfg->wifi_pass, (uint8_t)cfg->wifi_max_retry }));
+    wss_client_start(&wss_cfg);
+    ESP_LOGI(TAG, "远程控制已启用: %s", wss_uri);
+#endif
+    
     while (1) {
-        size_t bytes_written = 0;
-        esp_err_t ret = i2s_channel_write(tx_handle, (void*)audio_data, audio_data_len, &bytes_written, portMAX_DELAY);
-        if (ret == ESP_OK) {
-            ESP_LOGI(TAG, "播放完成: %d 字节", bytes_written);
-        } else {
-            ESP_LOGE(TAG, "播放失败: %s", esp_err_to_name(ret));
+        //? 门铃与语音排队，语音在门铃释音结束的下一帧开始
+#if DEMO_PROMPT_TONES
+        audio_player_play(SOUND_CHIME, 0, AUDIO_PLAYER_ENQUEUE, NULL);
+#endif
+        audio_player_play(SOUND_VOICE, 0, AUDIO_PLAYER_ENQUEUE, NULL);
+#if DEMO_PLAYER_DUCK
+        vTaskDelay(pdMS_TO_TICKS(3000));
+        audio_player_play(SOUND_ALERT, 10, AUDIO_PLAYER_DUCK, NULL);
+#endif
+        while (audio_player_busy()) {
+            vTaskDelay(pdMS_TO_TICKS(50));
         }
+        
+        audio_player_stats_t ps;
+        audio_player_get_stats(&ps);
+        ESP_LOGI(TAG, "调度延迟: 最近 %lu us, 平均 %lu us, 最大 %lu us (上限 %lu us, 超限 %lu 次)",
+                 (unsigned long)ps.latency_last_us, (unsigned long)ps.latency_avg_us,
+                 (unsigned long)ps.latency_max_us, (unsigned long)ps.latency_bound_us, (unsigned long)ps.over_bound);
         vTaskDelay(pdMS_TO_TICKS(2000)); // 每次播放间隔2秒
     }
 }
@@ -46,5 +250,13 @@ void app_main(void)
     ESP_LOGI(TAG, "======================================");
     ESP_LOGI(TAG, "  MAX98367A 语音播放：我爱你，中国");
     ESP_LOGI(TAG, "======================================");
+    ESP_ERROR_CHECK(app_config_init());
+#if DEMO_RUN_BENCHMARK
+    if (!audio_dsp_benchmark()) {
+        ESP_LOGE(TAG, "DSP 内核结果校验失败");
+    }
+    max98367a_benchmark();
+    max98367a_eq_benchmark();
+#endif
     xTaskCreate(play_voice_task, "play_voice", 4096, NULL, 5, NULL);
 }
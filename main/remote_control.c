@@ -0,0 +1,264 @@
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+
+#include "ctrl_proto.h"
+#include "wss_client.h"
+#include "MAX98367A.h"
+#include "INMP441.h"
+#include "audio_player.h"
+#include "app_config.h"
+#include "remote_control.h"
+
+static const char *TAG = "REMOTE_CTRL";
+
+static const char *const s_mode_names[] = {
+    [AUDIO_PLAYER_ENQUEUE] = "enqueue",
+    [AUDIO_PLAYER_PREEMPT] = "preempt",
+    [AUDIO_PLAYER_DUCK] = "duck",
+};
+
+//? 回复缓冲区：只在接收任务中使用
+static char s_reply[WSS_TEXT_MAX];
+
+#define COUNT_OF(a)  (sizeof(a) / sizeof((a)[0]))
+
+//? 各命令处理：成功时返回NULL并追加结果字段，失败返回错误描述（此时回复已由调用者重新开始）
+//? 增益和门限经运行时配置修改，由配置订阅者应用，"config save" 可一并保存
+
+//? 配置错误码转为回复文本
+static const char *config_error(esp_err_t ret)
+{
+    switch (ret) {
+    case ESP_OK:
+        return NULL;
+    case ESP_ERR_NOT_FOUND:
+        return "unknown key";
+    case ESP_ERR_INVALID_ARG:
+        return "value out of range";
+    case ESP_ERR_INVALID_SIZE:
+        return "value too long";
+    default:
+        return esp_err_to_name(ret);
+    }
+}
+
+//? 片段复制为以0结尾的字符串
+static bool token_copy(const ctrl_token_t *t, char *buf, size_t size)
+{
+    if (t->len >= size) {
+        return false;
+    }
+    memcpy(buf, t->p, t->len);
+    buf[t->len] = '\0';
+    return true;
+}
+
+static const char *cmd_gain(const ctrl_cmd_t *cmd, ctrl_reply_t *r)
+{
+    if (cmd->argc > 1) {
+        return "usage: gain [value]";
+    }
+    if (cmd->argc == 1) {
+        float gain;
+        if (!ctrl_token_float(&cmd->argv[0], &gain) || gain < 0.0f || gain > MAX98367A_MAX_GAIN) {
+            return "gain out of range";
+        }
+        const char *error = config_error(app_config_set_float("gain", gain));
+        if (error != NULL) {
+            return error;
+        }
+    }
+    ctrl_reply_float(r, "gain", max98367a_get_gain());
+    return NULL;
+}
+
+static const char *cmd_gate(const ctrl_cmd_t *cmd, ctrl_reply_t *r)
+{
+    if (cmd->argc > 1) {
+        return "usage: gate [threshold]";
+    }
+    if (cmd->argc == 1) {
+        int32_t gate;
+        if (!ctrl_token_int(&cmd->argv[0], &gate) || gate < 0) {
+            return "gate out of range";
+        }
+        const char *error = config_error(app_config_set_int("gate", gate));
+        if (error != NULL) {
+            return error;
+        }
+    }
+    ctrl_reply_int(r, "gate", inmp441_get_noise_gate());
+    return NULL;
+}
+
+static const char *cmd_play(const ctrl_cmd_t *cmd, ctrl_reply_t *r)
+{
+    int32_t id, prio = 0;
+    int mode = AUDIO_PLAYER_ENQUEUE;
+    if (cmd->argc < 1 || cmd->argc > 3) {
+        return "usage: play id [priority] [enqueue|preempt|duck]";
+    }
+    if (!ctrl_token_int(&cmd->argv[0], &id) || id < 0 || id >= AUDIO_PLAYER_MAX_SOUNDS) {
+        return "bad sound id";
+    }
+    if (cmd->argc >= 2 && (!ctrl_token_int(&cmd->argv[1], &prio) || prio < 0 || prio > 255)) {
+        return "bad priority";
+    }
+    if (cmd->argc == 3 && (mode = ctrl_token_enum(&cmd->argv[2], s_mode_names, COUNT_OF(s_mode_names))) < 0) {
+        return "bad mode";
+    }
+    uint32_t token;
+    esp_err_t ret = audio_player_play((uint16_t)id, (uint8_t)prio, (audio_player_mode_t)mode, &token);
+    if (ret != ESP_OK) {
+        return esp_err_to_name(ret);
+    }
+    ctrl_reply_int(r, "token", token);
+    return NULL;
+}
+
+static const char *cmd_stop(const ctrl_cmd_t *cmd, ctrl_reply_t *r)
+{
+    if (cmd->argc != 0) {
+        return "usage: stop";
+    }
+    esp_err_t ret = audio_player_stop();
+    return ret == ESP_OK ? NULL : esp_err_to_name(ret);
+}
+
+static const char *cmd_rate(const ctrl_cmd_t *cmd, ctrl_reply_t *r)
+{
+    if (cmd->argc > 1) {
+        return "usage: rate [hz]";
+    }
+    if (cmd->argc == 1) {
+        int32_t rate;
+        if (!ctrl_token_int(&cmd->argv[0], &rate) || rate < MAX98367A_MIN_SAMPLE_RATE || rate > MAX98367A_MAX_SAMPLE_RATE) {
+            return "rate out of range";
+        }
+        //? 由播放任务在当前声音结束后切换，回复的是请求的采样率
+        esp_err_t ret = audio_player_set_sample_rate((uint32_t)rate);
+        if (ret != ESP_OK) {
+            return esp_err_to_name(ret);
+        }
+        ctrl_reply_int(r, "rate", rate);
+    } else {
+        ctrl_reply_int(r, "rate", max98367a_get_sample_rate());
+    }
+    return NULL;
+}
+
+//? 固件还没有上行音频通道（没有任务用 audio_pack 打包采集数据发送），动词保留以兼容协议，回复失败而不是假装生效
+static const char *cmd_codec(const ctrl_cmd_t *cmd, ctrl_reply_t *r)
+{
+    (void)cmd;
+    (void)r;
+    return "not supported";
+}
+
+static const char *cmd_stats(const ctrl_cmd_t *cmd, ctrl_reply_t *r)
+{
+    if (cmd->argc != 0) {
+        return "usage: stats";
+    }
+    max98367a_dma_stats_t dma;
+    audio_player_stats_t ps;
+    wss_client_stats_t ws;
+    max98367a_get_dma_stats(&dma);
+    audio_player_get_stats(&ps);
+    wss_client_get_stats(&ws);
+
+    ctrl_reply_float(r, "gain", max98367a_get_gain());
+    ctrl_reply_int(r, "gate", inmp441_get_noise_gate());
+    ctrl_reply_int(r, "rate", max98367a_get_sample_rate());
+    ctrl_reply_float(r, "comp_db", max98367a_get_gain_reduction_db());
+    ctrl_reply_int(r, "underruns", dma.underruns);
+    ctrl_reply_int(r, "headroom_min", dma.headroom_min_blocks);
+    ctrl_reply_int(r, "started", ps.started);
+    ctrl_reply_int(r, "interrupted", ps.interrupted);
+    ctrl_reply_int(r, "dropped", ps.dropped);
+    ctrl_reply_int(r, "latency_avg_us", ps.latency_avg_us);
+    ctrl_reply_int(r, "latency_max_us", ps.latency_max_us);
+    ctrl_reply_int(r, "latency_bound_us", ps.latency_bound_us);
+    ctrl_reply_int(r, "ws_sent", ws.frames_sent);
+    ctrl_reply_int(r, "ws_received", ws.frames_received);
+    ctrl_reply_int(r, "ws_errors", ws.send_errors);
+    ctrl_reply_int(r, "ws_drops", ws.queue[WSS_QUEUE_CAPTURE].dropped_newest + ws.queue[WSS_QUEUE_CAPTURE].dropped_oldest);
+    ctrl_reply_int(r, "reconnects", ws.reconnects);
+    return NULL;
+}
+
+static const char *cmd_config(const ctrl_cmd_t *cmd, ctrl_reply_t *r)
+{
+    //? 键名不超过15个字符（NVS限制），字符串值不能含空格
+    char key[16];
+    char value[128];
+    if (cmd->argc < 1 || cmd->argc > 2) {
+        return "usage: config key [value] | config save | config reset";
+    }
+    if (cmd->argc == 1 && ctrl_token_eq(&cmd->argv[0], "save")) {
+        return config_error(app_config_save());
+    }
+    if (cmd->argc == 1 && ctrl_token_eq(&cmd->argv[0], "reset")) {
+        return config_error(app_config_reset());
+    }
+    if (!token_copy(&cmd->argv[0], key, sizeof(key))) {
+        return "unknown key";
+    }
+    if (cmd->argc == 2) {
+        if (!token_copy(&cmd->argv[1], value, sizeof(value))) {
+            return "value too long";
+        }
+        const char *error = config_error(app_config_set_text(key, value));
+        if (error != NULL) {
+            return error;
+        }
+    }
+    const char *error = config_error(app_config_get_text(key, value, sizeof(value)));
+    if (error != NULL) {
+        return error;
+    }
+    ctrl_reply_str(r, "key", key);
+    ctrl_reply_str(r, "value", value);
+    return NULL;
+}
+
+typedef const char *(*cmd_handler_t)(const ctrl_cmd_t *cmd, ctrl_reply_t *r);
+
+static const cmd_handler_t s_handlers[CTRL_VERB_COUNT] = {
+    [CTRL_VERB_GAIN] = cmd_gain,
+    [CTRL_VERB_GATE] = cmd_gate,
+    [CTRL_VERB_PLAY] = cmd_play,
+    [CTRL_VERB_STOP] = cmd_stop,
+    [CTRL_VERB_RATE] = cmd_rate,
+    [CTRL_VERB_CODEC] = cmd_codec,
+    [CTRL_VERB_STATS] = cmd_stats,
+    [CTRL_VERB_CONFIG] = cmd_config,
+};
+
+void remote_control_on_message(const char *msg, size_t len)
+{
+    ctrl_parser_t ps;
+    ctrl_cmd_t cmd;
+    ctrl_reply_t r;
+
+    ctrl_parser_init(&ps, msg, len);
+    while (ctrl_parser_next(&ps, &cmd)) {
+        cmd_handler_t handler = s_handlers[cmd.verb];
+        const char *error = handler == NULL ? "unknown command" : cmd.too_many ? "too many arguments" : NULL;
+        if (error == NULL) {
+            ctrl_reply_begin(&r, s_reply, sizeof(s_reply), &cmd, NULL);
+            error = handler(&cmd, &r);
+        }
+        if (error != NULL) {
+            ctrl_reply_begin(&r, s_reply, sizeof(s_reply), &cmd, error);
+        }
+        size_t n = ctrl_reply_end(&r);
+        if (error != NULL) {
+            ESP_LOGW(TAG, "命令 %.*s 失败: %s", (int)cmd.name.len, cmd.name.p, error);
+        }
+        if (n > 0 && wss_client_send_text(s_reply, n) != ESP_OK) {
+            ESP_LOGW(TAG, "回复发送失败");
+        }
+    }
+}
@@ -0,0 +1,12 @@
+#ifndef _REMOTE_CONTROL_H_
+#define _REMOTE_CONTROL_H_
+
+#include <stddef.h>
+
+//? 远程控制：解析WebSocket文本帧中的控制命令（协议见 ctrl_proto.h），执行后逐条回复JSON
+//? 作为 wss_client_config_t.on_message 使用（接收任务上下文）
+
+//? 文本帧回调
+void remote_control_on_message(const char *msg, size_t len);
+
+#endif
@@ -0,0 +1,105 @@
+/**
+ * app_config 主机测试
+ * 检查快照环：值未变化的修改不占用快照格，读者持有的已发布快照在之后 APP_CONFIG_SNAPSHOTS-1 次修改内不被改写
+ *
+ * 编译运行（在仓库根目录）：
+ *   gcc -O2 -Itools/host_stubs -Icomponents/app_config -Icomponents/wifi_sta -Icomponents/wss_client \
+ *       -Icomponents/MAX98367A -Icomponents/INMP441 tools/app_config_test.c -o app_config_test
+ *   ./app_config_test
+ *
+ * 全部通过时返回0
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+//? 不引入各组件的驱动头文件，以下是 app_config 用到的默认值宏
+#define _WIFI_STA_H_
+#define _WSS_CLIENT_H
+#define _MAX98367A_H_
+#define _INMP441_H_
+
+#define WIFI_SSID                           "test_ssid"
+#define WIFI_PASS                           "test_pass"
+#define WIFI_MAX_RETRY                      5
+#define WSS_URI                             "ws://127.0.0.1:8080/websocket/1"
+#define WSS_HANDSHAKE_RETRY_INTERVAL_MS     3000
+#define WSS_RECONNECT_DELAY_MS              5000
+#define MAX98367A_DMA_DESC_NUM              6
+#define MAX98367A_DMA_DESC_NUM_MAX          16
+#define MAX98367A_DMA_FRAME_NUM             256
+#define MAX98367A_DMA_FRAME_NUM_MAX         511
+#define MAX98367A_DEFAULT_GAIN              3.0f
+#define MAX98367A_MAX_GAIN                  5.0f
+#define INMP441_NOISE_GATE_THRESHOLD        500000
+
+#include "../components/app_config/app_config.c"
+
+static int s_failed = 0;
+static int s_notified = 0;
+
+static void check(int ok, const char *name)
+{
+    printf("  %-56s %s\n", name, ok ? "ok" : "FAIL");
+    s_failed |= !ok;
+}
+
+static void on_change(const app_config_t *cfg, uint32_t changed, void *arg)
+{
+    (void)cfg; (void)changed; (void)arg;
+    s_notified++;
+}
+
+//? 重复设置相同的值后再真正修改：修改前发布的快照必须保持不变
+static void test_noop_sets(void)
+{
+    printf("no-op sets then a real set:\n");
+    check(app_config_set_float("gain", 2.5f) == ESP_OK, "set gain 2.5");
+    const app_config_t *held = app_config_get();
+    app_config_t before = *held;
+    uint32_t generation = app_config_generation();
+    int notified = s_notified;
+
+    int ok = 1;
+    //? 修复前 APP_CONFIG_SNAPSHOTS-1 次无变化修改后，环的下一格正好是当前快照
+    for (int i = 0; i < APP_CONFIG_SNAPSHOTS - 1; i++) {
+        ok &= (i & 1) ? app_config_set_text("wss_uri", WSS_URI) == ESP_OK
+                      : app_config_set_float("gain", 2.5f) == ESP_OK;
+    }
+    check(ok, "repeated sets of the current value accepted");
+    check(app_config_get() == held, "no-op sets do not publish");
+    check(app_config_generation() == generation && s_notified == notified, "no-op sets do not notify");
+
+    check(app_config_set_text("wss_uri", "ws://10.0.0.1:9000/ws") == ESP_OK, "set wss_uri");
+    const app_config_t *cur = app_config_get();
+    check(cur != held, "real set publishes a new snapshot");
+    check(memcmp(held, &before, sizeof(before)) == 0, "previously published snapshot unmodified");
+    check(strcmp(cur->wss_uri, "ws://10.0.0.1:9000/ws") == 0 && cur->gain == 2.5f, "new snapshot has both values");
+}
+
+//? 连续 APP_CONFIG_SNAPSHOTS-1 次真实修改内，最早持有的快照不被改写
+static void test_ring_lifetime(void)
+{
+    printf("snapshot lifetime:\n");
+    const app_config_t *held = app_config_get();
+    app_config_t before = *held;
+    int ok = 1;
+    for (int i = 0; i < APP_CONFIG_SNAPSHOTS - 1; i++) {
+        ok &= app_config_set_int("gate", 1000 + i) == ESP_OK;
+        ok &= app_config_set_int("gate", 1000 + i) == ESP_OK;
+    }
+    check(ok, "sets accepted");
+    check(memcmp(held, &before, sizeof(before)) == 0, "held snapshot valid for SNAPSHOTS-1 changes");
+}
+
+int main(void)
+{
+    if (app_config_init() != ESP_OK || app_config_subscribe(APP_CONFIG_ALL, on_change, NULL) != ESP_OK) {
+        printf("init failed\n");
+        return 1;
+    }
+    test_noop_sets();
+    test_ring_lifetime();
+    printf("%s\n", s_failed ? "FAILED" : "all passed");
+    return s_failed;
+}
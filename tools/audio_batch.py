@@ -0,0 +1,334 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+批量音频资源打包工具
+将整个目录的提示音转换、响度归一化后打包为一个二进制资源，用于MAX98367A播放
+
+处理流程（每个文件并行执行，进程数默认等于CPU核数）：
+1. 去除首尾静音（silenceremove）
+2. EBU R128 响度归一化（loudnorm 两遍法：先测量，再按测量值线性增益），运行时无需再乘增益
+3. 转换为目标采样率/声道/位深的小端PCM
+4. 以"输入文件内容 + 处理参数"的SHA-256为键缓存结果，未变化的文件不重新编码
+5. 可选 --gain 在打包时烘焙线性增益；归一化或烘焙过增益的资源标记为 PRESCALED，
+   播放时以 MAX98367A_CLIP_PRESCALED 调用 max98367a_play_clip()，跳过运行时增益
+
+输出（默认前缀 prompts，复制到 main 目录并把 prompts.S 加入 SRCS）：
+- prompts.bin  : 所有片段按4字节对齐拼接的PCM数据
+- prompts.S    : .incbin 引入数据，并导出片段表 prompts_clips[]
+- prompts.h    : 片段ID枚举、片段表结构和格式宏
+- prompts.json : 清单（名称、偏移、长度、时长、测得响度、内容哈希）
+
+使用方法：
+  python audio_batch.py prompts_dir/ -o ../main
+  python audio_batch.py prompts_dir/ -o ../main --lufs -18 --jobs 8
+"""
+
+import argparse
+import concurrent.futures
+import hashlib
+import json
+import os
+import re
+import subprocess
+import sys
+
+import numpy as np
+
+from audio_to_c_array import bake_gain
+
+# 处理参数变化时需修改版本号，使旧缓存失效
+PIPELINE_VERSION = 1
+
+AUDIO_EXTENSIONS = ('.mp3', '.wav', '.m4a', '.flac', '.ogg', '.aac', '.opus')
+
+
+def file_sha256(path):
+    h = hashlib.sha256()
+    with open(path, 'rb') as f:
+        for chunk in iter(lambda: f.read(1 << 20), b''):
+            h.update(chunk)
+    return h.hexdigest()
+
+
+def clip_symbol(filename):
+    """
+    文件名转C标识符（大写），如 "door-open.mp3" -> "DOOR_OPEN"
+    """
+    base = os.path.splitext(os.path.basename(filename))[0]
+    sym = re.sub(r'[^0-9A-Za-z]+', '_', base).strip('_').upper()
+    if not sym or sym[0].isdigit():
+        sym = 'CLIP_' + sym
+    return sym
+
+
+def trim_filter(args):
+    """
+    首尾静音裁剪滤镜：裁掉开头静音，反转后再裁一次即为结尾静音
+    """
+    if args.no_trim:
+        return []
+    sr = (f"silenceremove=start_periods=1:start_duration=0:"
+          f"start_threshold={args.silence_db}dB:start_silence={args.keep_silence}")
+    return [sr, 'areverse', sr, 'areverse']
+
+
+def measure_loudness(input_file, args):
+    """
+    第一遍：测量积分响度、真峰值、响度范围和阈值
+    """
+    loudnorm = f"loudnorm=I={args.lufs}:TP={args.true_peak}:LRA={args.lra}:print_format=json"
+    chain = ','.join(trim_filter(args) + [loudnorm])
+    cmd = ['ffmpeg', '-hide_banner', '-nostats', '-i', input_file, '-af', chain, '-f', 'null', '-']
+    result = subprocess.run(cmd, capture_output=True, text=True)
+    if result.returncode != 0:
+        raise RuntimeError(f"FFmpeg测量失败: {input_file}\n{result.stderr}")
+    # loudnorm 的JSON输出在stderr末尾
+    match = re.search(r'\{[^{}]*"input_i"[^{}]*\}', result.stderr, re.S)
+    if not match:
+        raise RuntimeError(f"无法解析loudnorm测量结果: {input_file}")
+    return json.loads(match.group(0))
+
+
+def encode_clip(input_file, output_file, args, measured):
+    """
+    第二遍：按测量值做线性响度归一化并输出RAW PCM
+    """
+    filters = trim_filter(args)
+    if measured is not None:
+        filters.append(
+            f"loudnorm=I={args.lufs}:TP={args.true_peak}:LRA={args.lra}:"
+            f"measured_I={measured['input_i']}:measured_TP={measured['input_tp']}:"
+            f"measured_LRA={measured['input_lra']}:measured_thresh={measured['input_thresh']}:"
+            f"offset={measured['target_offset']}:linear=true")
+    cmd = ['ffmpeg', '-hide_banner', '-nostats', '-i', input_file]
+    if filters:
+        cmd += ['-af', ','.join(filters)]
+    cmd += ['-ar', str(args.rate), '-ac', str(args.channels),
+            '-f', 's32le' if args.bits == 32 else 's16le', '-y', output_file]
+    result = subprocess.run(cmd, capture_output=True, text=True)
+    if result.returncode != 0:
+        raise RuntimeError(f"FFmpeg编码失败: {input_file}\n{result.stderr}")
+
+
+def process_clip(input_file, args):
+    """
+    处理单个文件（在工作进程中运行），返回清单条目
+    """
+    params = {
+        'version': PIPELINE_VERSION, 'rate': args.rate, 'channels': args.channels, 'bits': args.bits,
+        'lufs': None if args.no_normalize else args.lufs, 'true_peak': args.true_peak, 'lra': args.lra,
+        'trim': not args.no_trim, 'silence_db': args.silence_db, 'keep_silence': args.keep_silence,
+    }
+    content_hash = file_sha256(input_file)
+    key = hashlib.sha256((content_hash + json.dumps(params, sort_keys=True)).encode()).hexdigest()
+    raw_file = os.path.join(args.cache_dir, f"{key}.raw")
+    meta_file = os.path.join(args.cache_dir, f"{key}.json")
+
+    if os.path.exists(raw_file) and os.path.exists(meta_file):
+        with open(meta_file, 'r', encoding='utf-8') as f:
+            meta = json.load(f)
+        meta['cached'] = True
+        return meta
+
+    measured = None if args.no_normalize else measure_loudness(input_file, args)
+    tmp_file = raw_file + '.tmp'
+    encode_clip(input_file, tmp_file, args, measured)
+    os.replace(tmp_file, raw_file)
+
+    meta = {
+        'source': os.path.basename(input_file),
+        'sha256': content_hash,
+        'cache_key': key,
+        'measured_lufs': float(measured['input_i']) if measured else None,
+        'measured_true_peak': float(measured['input_tp']) if measured else None,
+    }
+    with open(meta_file, 'w', encoding='utf-8') as f:
+        json.dump(meta, f, ensure_ascii=False, indent=2)
+    meta['cached'] = False
+    return meta
+
+
+def write_pack(clips, args):
+    """
+    拼接所有片段并写出 .bin/.S/.h/.json
+    """
+    name = args.name
+    macro = name.upper()
+    sample_bytes = args.bits // 8
+    frame_bytes = sample_bytes * args.channels
+
+    os.makedirs(args.out_dir, exist_ok=True)
+    bin_file = os.path.join(args.out_dir, f"{name}.bin")
+
+    entries = []
+    offset = 0
+    with open(bin_file, 'wb') as out:
+        for clip in clips:
+            data = np.fromfile(os.path.join(args.cache_dir, f"{clip['cache_key']}.raw"), dtype=np.uint8)
+            data = data[:len(data) - len(data) % frame_bytes]
+            if args.gain is not None:
+                samples = data.view('<i4' if args.bits == 32 else '<i2')
+                data = bake_gain(samples, args.gain, bits=args.bits)[0].astype(samples.dtype).view(np.uint8)
+            data.tofile(out)
+            pad = (-len(data)) % 4
+            if pad:
+                out.write(b'\0' * pad)
+            entries.append({
+                'id': clip['symbol'],
+                'source': clip['source'],
+                'offset': offset,
+                'len': int(len(data)),
+                'duration_sec': round(len(data) / (frame_bytes * args.rate), 3),
+                'measured_lufs': clip['measured_lufs'],
+                'measured_true_peak': clip['measured_true_peak'],
+                'sha256': clip['sha256'],
+            })
+            offset += len(data) + pad
+
+    total_len = offset
+    prescaled = (not args.no_normalize) or args.gain is not None
+    comment = (
+        '/**\n'
+        ' * 自动生成的批量音频资源文件（tools/audio_batch.py）\n'
+        f' * 片段数: {len(entries)}\n'
+        f' * 数据大小: {total_len} 字节\n'
+        f' * 采样率: {args.rate} Hz\n'
+        f' * 位深度: {args.bits} bit\n'
+        f' * 声道数: {args.channels}\n'
+        f' * 响度: {"未归一化" if args.no_normalize else f"{args.lufs} LUFS (EBU R128)"}\n'
+        ' */\n\n'
+    )
+
+    with open(os.path.join(args.out_dir, f"{name}.S"), 'w', encoding='utf-8', newline='\n') as f:
+        f.write(comment)
+        f.write(f'    .section .rodata.{name}, "a"\n')
+        f.write('    .balign 4\n')
+        f.write(f'    .global {name}\n')
+        f.write(f'    .type {name}, @object\n')
+        f.write(f'{name}:\n')
+        f.write(f'    .incbin "{name}.bin"\n')
+        f.write(f'    .size {name}, . - {name}\n\n')
+        f.write('    .balign 4\n')
+        f.write(f'    .global {name}_clips\n')
+        f.write(f'    .type {name}_clips, @object\n')
+        f.write(f'{name}_clips:\n')
+        for e in entries:
+            f.write(f'    .long {e["offset"]}, {e["len"]}    /* {e["id"]} */\n')
+        f.write(f'    .size {name}_clips, . - {name}_clips\n')
+
+    with open(os.path.join(args.out_dir, f"{name}.h"), 'w', encoding='utf-8', newline='\n') as f:
+        f.write(comment)
+        f.write(f'#ifndef {macro}_H\n')
+        f.write(f'#define {macro}_H\n\n')
+        f.write('#include <stdint.h>\n\n')
+        f.write(f'#define {macro}_SAMPLE_RATE   {args.rate}\n')
+        f.write(f'#define {macro}_BITS          {args.bits}\n')
+        f.write(f'#define {macro}_CHANNELS      {args.channels}\n')
+        f.write(f'#define {macro}_CLIP_COUNT    {len(entries)}\n')
+        f.write(f'#define {macro}_PRESCALED     {1 if prescaled else 0}    //? 1=增益已烘焙，播放时跳过运行时增益\n\n')
+        f.write('//? 片段ID\n')
+        f.write('typedef enum {\n')
+        for i, e in enumerate(entries):
+            f.write(f'    {macro}_{e["id"]} = {i},\n')
+        f.write(f'}} {name}_id_t;\n\n')
+        f.write('//? 片段在打包数据中的位置（字节）\n')
+        f.write('typedef struct {\n')
+        f.write('    uint32_t offset;\n')
+        f.write('    uint32_t len;\n')
+        f.write(f'}} {name}_clip_t;\n\n')
+        f.write(f'//? 数据与片段表由 {name}.S 通过 .incbin 链接，4字节对齐\n')
+        f.write(f'extern const uint8_t {name}[];\n')
+        f.write(f'extern const {name}_clip_t {name}_clips[{macro}_CLIP_COUNT];\n\n')
+        f.write('//? 获取片段数据指针和长度\n')
+        f.write(f'#define {macro}_DATA(id)  ((const void *)({name} + {name}_clips[(id)].offset))\n')
+        f.write(f'#define {macro}_LEN(id)   ({name}_clips[(id)].len)\n\n')
+        f.write(f'#endif // {macro}_H\n')
+
+    manifest = {
+        'name': name,
+        'sample_rate': args.rate,
+        'bits': args.bits,
+        'channels': args.channels,
+        'target_lufs': None if args.no_normalize else args.lufs,
+        'gain': args.gain,
+        'prescaled': prescaled,
+        'total_len': total_len,
+        'clips': entries,
+    }
+    with open(os.path.join(args.out_dir, f"{name}.json"), 'w', encoding='utf-8') as f:
+        json.dump(manifest, f, ensure_ascii=False, indent=2)
+
+    return total_len
+
+
+def main():
+    parser = argparse.ArgumentParser(description="批量音频资源打包（并行转换 + EBU R128响度归一化 + 静音裁剪 + 缓存）")
+    parser.add_argument("input_dir", help="输入音频目录")
+    parser.add_argument("-n", "--name", default="prompts", help="输出符号名/文件名前缀（默认 prompts）")
+    parser.add_argument("-o", "--out-dir", default=".", help="输出目录")
+    parser.add_argument("--cache-dir", default=None, help="缓存目录（默认 <输入目录>/.asset_cache）")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count(), help="并行进程数（默认CPU核数）")
+    parser.add_argument("--rate", type=int, default=44100, help="采样率")
+    parser.add_argument("--channels", type=int, default=1, choices=(1, 2), help="声道数（MAX98367A为单声道功放，默认1）")
+    parser.add_argument("--bits", type=int, default=32, choices=(16, 32), help="位深度")
+    parser.add_argument("--lufs", type=float, default=-16.0, help="目标积分响度（LUFS）")
+    parser.add_argument("--true-peak", type=float, default=-1.5, help="真峰值上限（dBTP）")
+    parser.add_argument("--lra", type=float, default=11.0, help="目标响度范围（LU）")
+    parser.add_argument("--no-normalize", action="store_true", help="不做响度归一化")
+    parser.add_argument("--gain", type=float, default=None, help="打包时烘焙的线性增益（在响度归一化之后）")
+    parser.add_argument("--no-trim", action="store_true", help="不裁剪首尾静音")
+    parser.add_argument("--silence-db", type=float, default=-50.0, help="静音判定门限（dBFS）")
+    parser.add_argument("--keep-silence", type=float, default=0.02, help="首尾保留的静音时长（秒）")
+    args = parser.parse_args()
+
+    if not os.path.isdir(args.input_dir):
+        print(f"错误: 目录不存在: {args.input_dir}")
+        sys.exit(1)
+    if args.cache_dir is None:
+        args.cache_dir = os.path.join(args.input_dir, '.asset_cache')
+    os.makedirs(args.cache_dir, exist_ok=True)
+
+    files = sorted(os.path.join(args.input_dir, f) for f in os.listdir(args.input_dir)
+                   if f.lower().endswith(AUDIO_EXTENSIONS))
+    if not files:
+        print(f"错误: 目录中没有音频文件: {args.input_dir}")
+        sys.exit(1)
+
+    symbols = {}
+    for path in files:
+        sym = clip_symbol(path)
+        if sym in symbols:
+            print(f"错误: 片段ID冲突: {os.path.basename(path)} 与 {os.path.basename(symbols[sym])} 都映射为 {sym}")
+            sys.exit(1)
+        symbols[sym] = path
+
+    print(f"共 {len(files)} 个文件，使用 {args.jobs} 个进程处理")
+    clips = [None] * len(files)
+    failed = False
+    with concurrent.futures.ProcessPoolExecutor(max_workers=args.jobs) as pool:
+        futures = {pool.submit(process_clip, path, args): i for i, path in enumerate(files)}
+        for fut in concurrent.futures.as_completed(futures):
+            i = futures[fut]
+            try:
+                meta = fut.result()
+            except Exception as e:
+                print(f"✗ {os.path.basename(files[i])}: {e}")
+                failed = True
+                continue
+            meta['symbol'] = clip_symbol(files[i])
+            meta['source'] = os.path.basename(files[i])
+            clips[i] = meta
+            lufs = f"{meta['measured_lufs']:.1f} LUFS" if meta['measured_lufs'] is not None else "-"
+            print(f"{'=' if meta['cached'] else '✓'} {meta['source']} ({lufs}){' [缓存]' if meta['cached'] else ''}")
+
+    if failed:
+        sys.exit(1)
+
+    total_len = write_pack(clips, args)
+    cached = sum(1 for c in clips if c['cached'])
+    print(f"\n✓ 打包完成: {len(clips)} 个片段（{cached} 个命中缓存），共 {total_len / 1024:.2f} KB")
+    print(f"  输出: {os.path.join(args.out_dir, args.name)}.bin/.S/.h/.json")
+
+
+if __name__ == '__main__':
+    main()
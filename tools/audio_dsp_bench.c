@@ -0,0 +1,321 @@
+/**
+ * audio_dsp 内核主机性能对比
+ * 每个内核与直观写法的参考实现（取模环形缓冲、双精度浮点、逐样本64位钳位）对比结果和耗时
+ * 设备上的每块CPU周期数与结果校验见 audio_dsp_benchmark()
+ *
+ * 编译运行（在仓库根目录）：
+ *   gcc -O2 -Icomponents/audio_dsp tools/audio_dsp_bench.c components/audio_dsp/audio_dsp.c components/audio_dsp/audio_dsp_kernels.c components/audio_dsp/audio_dsp_dynamics.c -lm -o audio_dsp_bench
+ *   ./audio_dsp_bench [块样本数=256]
+ *
+ * 结果超出允许误差时返回1
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "audio_dsp.h"
+
+#define MAX_BLOCK   4096
+#define FIR_TAPS    32
+#define ROUNDS      4000
+
+static size_t s_n = 256;
+static int s_failed = 0;
+
+static int32_t s_a32[MAX_BLOCK], s_b32[MAX_BLOCK], s_x32[MAX_BLOCK], s_y32[MAX_BLOCK];
+static int32_t s_o32[2 * MAX_BLOCK], s_r32[2 * MAX_BLOCK];
+static int16_t s_a16[MAX_BLOCK], s_b16[MAX_BLOCK], s_x16[MAX_BLOCK], s_y16[MAX_BLOCK];
+static int16_t s_o16[2 * MAX_BLOCK], s_r16[2 * MAX_BLOCK];
+static int32_t s_coef32[FIR_TAPS];
+static int16_t s_coef16[FIR_TAPS];
+
+static void fill(void)
+{
+    uint32_t seed = 0x12345678;
+    for (size_t i = 0; i < MAX_BLOCK; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        s_a32[i] = (int32_t)seed;
+        s_b32[i] = (int32_t)(seed ^ 0x5A5A5A5A);
+        s_a16[i] = (int16_t)(s_a32[i] >> 16);
+        s_b16[i] = (int16_t)(s_b32[i] >> 16);
+    }
+    //? 边界值
+    s_a32[0] = INT32_MIN; s_b32[0] = INT32_MIN;
+    s_a32[1] = INT32_MAX; s_b32[1] = INT32_MAX;
+    s_a16[0] = INT16_MIN; s_b16[0] = INT16_MIN;
+    s_a16[1] = INT16_MAX; s_b16[1] = INT16_MAX;
+    for (size_t k = 0; k < FIR_TAPS; k++) {
+        //? 汉宁窗低通，系数和约为1
+        double w = 0.5 - 0.5 * cos(2.0 * M_PI * (k + 1) / (FIR_TAPS + 1));
+        s_coef32[k] = (int32_t)lrint(w / (FIR_TAPS + 1) * 2.0 * 2147483647.0 * 0.99);
+        s_coef16[k] = (int16_t)(s_coef32[k] >> 16);
+    }
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+//? 计时：setup 每轮恢复输入（不计入差异很小，两边相同）
+#define TIME(var, setup, stmt) do {                                 \
+    double t0 = now_ns();                                           \
+    for (int r = 0; r < ROUNDS; r++) {                              \
+        setup;                                                      \
+        stmt;                                                       \
+        __asm__ volatile("" ::: "memory");                          \
+    }                                                               \
+    var = (now_ns() - t0) / ROUNDS;                                 \
+} while (0)
+
+static void report(const char *name, double t_lib, double t_ref, double err, double tol)
+{
+    int ok = err <= tol;
+    printf("%-18s | %9.1f | %9.1f | %6.2fx | %10.3g%s\n", name, t_lib, t_ref, t_ref / t_lib, err, ok ? "" : "  FAIL");
+    s_failed |= !ok;
+}
+
+static double max_diff32(const int32_t *a, const int32_t *b, size_t n)
+{
+    double m = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        m = fmax(m, fabs((double)a[i] - b[i]));
+    }
+    return m;
+}
+
+static double max_diff16(const int16_t *a, const int16_t *b, size_t n)
+{
+    double m = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        m = fmax(m, fabs((double)a[i] - b[i]));
+    }
+    return m;
+}
+
+//? ==================== 参考实现 ====================
+
+static int64_t clamp64(int64_t v, int64_t lo, int64_t hi)
+{
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+static void ref_add_s32(int32_t *d, const int32_t *s, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        d[i] = (int32_t)clamp64((int64_t)d[i] + s[i], INT32_MIN, INT32_MAX);
+    }
+}
+
+static void ref_scale_s32(int32_t *d, size_t n, int32_t g, int sh)
+{
+    for (size_t i = 0; i < n; i++) {
+        d[i] = (int32_t)clamp64((int64_t)floor((double)d[i] * g / (1 << sh)), INT32_MIN, INT32_MAX);
+    }
+}
+
+static void ref_mul_q15(const int16_t *a, const int16_t *b, int16_t *o, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        o[i] = (int16_t)clamp64((int64_t)floor((double)a[i] * b[i] / 32768.0), INT16_MIN, INT16_MAX);
+    }
+}
+
+//? 直接型FIR：环形缓冲按取模索引
+static int32_t s_ref_hist32[FIR_TAPS];
+static int16_t s_ref_hist16[FIR_TAPS];
+static size_t s_ref_pos;
+
+static void ref_fir_s32(const int32_t *in, int32_t *out, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        s_ref_hist32[s_ref_pos] = in[i];
+        int64_t acc = (int64_t)1 << 30;
+        for (size_t k = 0; k < FIR_TAPS; k++) {
+            //? h[k] 对应 x[n-k]；系数倒序存放，h[k] = coef[taps-1-k]
+            acc += (int64_t)s_coef32[FIR_TAPS - 1 - k] * s_ref_hist32[(s_ref_pos + FIR_TAPS - k) % FIR_TAPS];
+        }
+        out[i] = (int32_t)clamp64(acc >> 31, INT32_MIN, INT32_MAX);
+        s_ref_pos = (s_ref_pos + 1) % FIR_TAPS;
+    }
+}
+
+static void ref_fir_s16(const int16_t *in, int16_t *out, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        s_ref_hist16[s_ref_pos] = in[i];
+        int64_t acc = 1 << 14;
+        for (size_t k = 0; k < FIR_TAPS; k++) {
+            acc += (int32_t)s_coef16[FIR_TAPS - 1 - k] * s_ref_hist16[(s_ref_pos + FIR_TAPS - k) % FIR_TAPS];
+        }
+        out[i] = (int16_t)clamp64(acc >> 15, INT16_MIN, INT16_MAX);
+        s_ref_pos = (s_ref_pos + 1) % FIR_TAPS;
+    }
+}
+
+//? 双精度浮点二阶节（直接II型转置）
+static void ref_biquad(const audio_dsp_biquad_coef_t *c, double *z, int32_t *d, size_t n)
+{
+    const double k = 1.0 / (1 << AUDIO_DSP_COEF_SHIFT);
+    //? b系数按 2^shift 缩小存储
+    const double kb = k * (1 << c->shift);
+    double b0 = c->b0 * kb, b1 = c->b1 * kb, b2 = c->b2 * kb, a1 = c->a1 * k, a2 = c->a2 * k;
+    for (size_t i = 0; i < n; i++) {
+        double x = d[i];
+        double y = b0 * x + z[0];
+        z[0] = b1 * x - a1 * y + z[1];
+        z[1] = b2 * x - a2 * y;
+        d[i] = (int32_t)clamp64((int64_t)floor(y), INT32_MIN, INT32_MAX);
+    }
+}
+
+static double ref_dot_q31(const int32_t *a, const int32_t *b, size_t n)
+{
+    double acc = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        acc += (double)a[i] * b[i];
+    }
+    return acc / 2147483648.0;
+}
+
+static double ref_dot_q15(const int16_t *a, const int16_t *b, size_t n)
+{
+    double acc = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        acc += (double)a[i] * b[i];
+    }
+    return fmin(fmax(floor(acc / 32768.0 + 0.5), -32768.0), 32767.0);
+}
+
+static double ref_rms(const int32_t *a, size_t n)
+{
+    double acc = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        acc += (double)a[i] * a[i];
+    }
+    return sqrt(acc / n);
+}
+
+//? ==================== 对比 ====================
+
+static void run(void)
+{
+    const size_t n = s_n;
+    double tl, tr, err;
+    volatile int64_t sink;
+
+    printf("block %zu samples, %d rounds\n", n, ROUNDS);
+    printf("kernel             |  lib ns   |  ref ns   | speedup | max error\n");
+
+    TIME(tl, memcpy(s_x32, s_a32, n * 4), audio_dsp_add_sat_s32(s_x32, s_b32, n));
+    TIME(tr, memcpy(s_y32, s_a32, n * 4), ref_add_s32(s_y32, s_b32, n));
+    report("add sat s32", tl, tr, max_diff32(s_x32, s_y32, n), 0);
+
+    TIME(tl, memcpy(s_x32, s_a32, n * 4), audio_dsp_scale_s32(s_x32, n, 300, 8));
+    TIME(tr, memcpy(s_y32, s_a32, n * 4), ref_scale_s32(s_y32, n, 300, 8));
+    report("scale s32 (q8)", tl, tr, max_diff32(s_x32, s_y32, n), 0);
+
+    TIME(tl, , audio_dsp_mul_q15(s_a16, s_b16, s_x16, n));
+    TIME(tr, , ref_mul_q15(s_a16, s_b16, s_y16, n));
+    report("mul q15", tl, tr, max_diff16(s_x16, s_y16, n), 0);
+
+    //? FIR：连续处理多块，状态跨块保持
+    audio_dsp_fir_s32_t f32;
+    static int32_t delay32[AUDIO_DSP_FIR_DELAY_LEN(FIR_TAPS)];
+    audio_dsp_fir_init_s32(&f32, s_coef32, delay32, FIR_TAPS);
+    memset(s_ref_hist32, 0, sizeof(s_ref_hist32));
+    s_ref_pos = 0;
+    TIME(tl, , audio_dsp_fir_s32(&f32, s_a32, s_x32, n));
+    TIME(tr, , ref_fir_s32(s_a32, s_y32, n));
+    report("fir 32 taps q31", tl, tr, max_diff32(s_x32, s_y32, n), 0);
+
+    audio_dsp_fir_s16_t f16;
+    static int16_t delay16[AUDIO_DSP_FIR_DELAY_LEN(FIR_TAPS)];
+    audio_dsp_fir_init_s16(&f16, s_coef16, delay16, FIR_TAPS);
+    memset(s_ref_hist16, 0, sizeof(s_ref_hist16));
+    s_ref_pos = 0;
+    TIME(tl, , audio_dsp_fir_s16(&f16, s_a16, s_x16, n));
+    TIME(tr, , ref_fir_s16(s_a16, s_y16, n));
+    report("fir 32 taps q15", tl, tr, max_diff16(s_x16, s_y16, n), 0);
+
+    //? 二阶节：定点与双精度浮点的差异应只有几个LSB
+    audio_dsp_biquad_cascade_t hp;
+    audio_dsp_cascade_init(&hp, 1);
+    audio_dsp_design_highpass(&hp.coef[0], 80.0f, 0.7071f, 44100);
+    double z[2] = {0.0, 0.0};
+    for (size_t i = 0; i < n; i++) {
+        s_o32[i] = s_a32[i] >> 2;
+    }
+    TIME(tl, memcpy(s_x32, s_o32, n * 4), audio_dsp_cascade_process(&hp, s_x32, n));
+    TIME(tr, memcpy(s_y32, s_o32, n * 4), ref_biquad(&hp.coef[0], z, s_y32, n));
+    report("biquad q31", tl, tr, max_diff32(s_x32, s_y32, n), 16);
+
+    TIME(tl, , sink = audio_dsp_dot_q31(s_a32, s_b32, n));
+    TIME(tr, , sink = (int64_t)ref_dot_q31(s_a32, s_b32, n));
+    //? 库实现只用高24位，误差约为 n * 2^-8 量级（Q31）
+    err = fabs((double)audio_dsp_dot_q31(s_a32, s_b32, n) - ref_dot_q31(s_a32, s_b32, n));
+    report("dot q31", tl, tr, err, n * 512.0);
+
+    TIME(tl, , sink = audio_dsp_dot_q15(s_a16, s_b16, n));
+    TIME(tr, , sink = (int64_t)ref_dot_q15(s_a16, s_b16, n));
+    //? 满幅随机数据的点积超出Q15范围，同时检查饱和；非对齐地址结果须一致
+    err = fabs(audio_dsp_dot_q15(s_a16, s_b16, n) - ref_dot_q15(s_a16, s_b16, n));
+    err += fabs(audio_dsp_dot_q15(s_a16 + 1, s_b16 + 3, n - 3) - ref_dot_q15(s_a16 + 1, s_b16 + 3, n - 3));
+    err += fabs(audio_dsp_dot_q15(s_a16 + 2, s_b16 + 2, n / 8) - ref_dot_q15(s_a16 + 2, s_b16 + 2, n / 8));
+    report("dot q15", tl, tr, err, 0);
+
+    TIME(tl, , sink = audio_dsp_rms_s32(s_a32, n));
+    TIME(tr, , sink = (int64_t)ref_rms(s_a32, n));
+    err = fabs((double)audio_dsp_rms_s32(s_a32, n) - ref_rms(s_a32, n)) / ref_rms(s_a32, n);
+    report("rms s32 (rel)", tl, tr, err, 1e-5);
+
+    TIME(tl, , sink = audio_dsp_peak_s32(s_a32, n));
+    TIME(tr, , { int64_t m = 0; for (size_t i = 0; i < n; i++) m = llabs((int64_t)s_a32[i]) > m ? llabs((int64_t)s_a32[i]) : m; sink = m; });
+    report("peak s32", tl, tr, fabs((double)audio_dsp_peak_s32(s_a32, n) - 2147483648.0), 0);
+
+    TIME(tl, , audio_dsp_interleave_s32(s_a32, s_b32, s_o32, n));
+    TIME(tr, , for (size_t i = 0; i < 2 * n; i++) s_r32[i] = (i & 1) ? s_b32[i / 2] : s_a32[i / 2]);
+    report("interleave s32", tl, tr, max_diff32(s_o32, s_r32, 2 * n), 0);
+
+    audio_dsp_interleave_s16(s_a16, s_b16, s_o16, n);
+    TIME(tl, , audio_dsp_deinterleave_s16(s_o16, s_x16, s_y16, n));
+    TIME(tr, , for (size_t i = 0; i < 2 * n; i++) s_r16[(i & 1) * n + i / 2] = s_o16[i]);
+    report("deinterleave s16", tl, tr, max_diff16(s_x16, s_r16, n) + max_diff16(s_y16, s_r16 + n, n), 0);
+
+    //? 查表对数/指数与libm对比（对数误差按log2单位，指数按相对误差）
+    TIME(tl, , for (size_t i = 0; i < n; i++) sink += audio_dsp_log2_q16((uint32_t)s_a32[i]));
+    TIME(tr, , for (size_t i = 0; i < n; i++) sink += (int64_t)(log2((double)(uint32_t)s_a32[i]) * 65536.0));
+    err = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        if (s_a32[i] != 0) {
+            err = fmax(err, fabs(audio_dsp_log2_q16((uint32_t)s_a32[i]) / 65536.0 - log2((double)(uint32_t)s_a32[i])));
+        }
+    }
+    report("log2 q16", tl, tr, err, 3e-4);
+
+    TIME(tl, , for (size_t i = 0; i < n; i++) sink += audio_dsp_exp2_q16(s_a32[i] >> 13));
+    TIME(tr, , for (size_t i = 0; i < n; i++) sink += (int64_t)(exp2((s_a32[i] >> 13) / 65536.0) * 65536.0));
+    err = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        double ref = exp2((s_a32[i] >> 13) / 65536.0) * 65536.0;
+        err = fmax(err, fabs(audio_dsp_exp2_q16(s_a32[i] >> 13) - ref) / ref);
+    }
+    report("exp2 q16 (rel)", tl, tr, err, 3e-4);
+    (void)sink;
+}
+
+int main(int argc, char **argv)
+{
+    s_n = argc > 1 ? (size_t)atoi(argv[1]) : 256;
+    if (s_n < 2 || s_n > MAX_BLOCK) {
+        s_n = 256;
+    }
+    fill();
+    run();
+    printf("%s\n", s_failed ? "FAILED" : "all within tolerance");
+    return s_failed;
+}
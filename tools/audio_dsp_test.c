@@ -0,0 +1,421 @@
+/**
+ * audio_dsp 主机测试：频率响应、均衡设计、直流去除、极限环、压缩器与性能
+ * 用正弦扫频实测定点滤波器的增益，与系数计算的理论响应比较
+ *
+ * 编译运行（在仓库根目录）：
+ *   gcc -O2 -Icomponents/audio_dsp tools/audio_dsp_test.c components/audio_dsp/audio_dsp.c components/audio_dsp/audio_dsp_kernels.c components/audio_dsp/audio_dsp_dynamics.c -lm -o audio_dsp_test
+ *   ./audio_dsp_test [采样率=44100] [高通截止Hz=80]
+ *
+ * 全部通过时返回0
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "audio_dsp.h"
+
+#define BLOCK           256
+#define AMPLITUDE       (1 << 29)       //? -6dBFS，留出过冲余量
+#define TOL_DB          0.05            //? 实测与理论响应的允许偏差
+
+static uint32_t s_fs = 44100;
+static int s_failed = 0;
+static double s_amp = AMPLITUDE;        //? 激励幅度，测试提升型均衡时降低以免削波
+
+static void check(int ok, const char *fmt, double v)
+{
+    printf("  ");
+    printf(fmt, v);
+    printf("%s\n", ok ? "  ok" : "  FAIL");
+    s_failed |= !ok;
+}
+
+static double db(double v)
+{
+    return 20.0 * log10(v);
+}
+
+//? 以正弦激励 process，跳过 settle_s 秒暂态后测量 measure_s 秒的RMS增益
+typedef void (*process_fn)(void *ctx, int32_t *data, size_t n);
+
+static double measure_gain(process_fn fn, void *ctx, double f, double settle_s, double measure_s)
+{
+    static int32_t buf[BLOCK];
+    //? 测量窗口取整数个周期，避免非整周期截断带来的RMS误差
+    size_t settle = (size_t)(settle_s * s_fs);
+    size_t window = (size_t)lrint(ceil(measure_s * f) * s_fs / f);
+    size_t total = settle + window;
+    double ph = 0.0, dph = 2.0 * M_PI * f / s_fs;
+    double in_sq = 0.0, out_sq = 0.0;
+
+    for (size_t pos = 0; pos < total; pos += BLOCK) {
+        double in_blk[BLOCK];
+        for (size_t i = 0; i < BLOCK; i++) {
+            in_blk[i] = s_amp * sin(ph);
+            buf[i] = (int32_t)lrint(in_blk[i]);
+            ph += dph;
+        }
+        ph = fmod(ph, 2.0 * M_PI);
+        fn(ctx, buf, BLOCK);
+        for (size_t i = 0; i < BLOCK; i++) {
+            if (pos + i >= settle && pos + i < total) {
+                in_sq += in_blk[i] * in_blk[i];
+                out_sq += (double)buf[i] * buf[i];
+            }
+        }
+    }
+    return sqrt(out_sq / in_sq);
+}
+
+static void cascade_fn(void *ctx, int32_t *data, size_t n)
+{
+    audio_dsp_cascade_process((audio_dsp_biquad_cascade_t *)ctx, data, n);
+}
+
+static void dc_fn(void *ctx, int32_t *data, size_t n)
+{
+    audio_dsp_dc_block_process((audio_dsp_dc_block_t *)ctx, data, n);
+}
+
+//? 扫频：实测增益与理论值比较
+static void test_response(float fc)
+{
+    static const double freqs[] = {10, 20, 40, 60, 80, 120, 250, 1000, 4000, 12000, 18000};
+    audio_dsp_biquad_cascade_t f;
+
+    for (int stages = 1; stages <= 2; stages++) {
+        printf("highpass %.0f Hz, %d stage(s) @ %lu Hz:\n", fc, stages, (unsigned long)s_fs);
+        printf("     freq | theory dB | measured dB\n");
+        int ok = 1;
+        for (size_t i = 0; i < sizeof(freqs) / sizeof(freqs[0]) && freqs[i] < 0.45 * s_fs; i++) {
+            audio_dsp_cascade_init(&f, stages);
+            for (int k = 0; k < stages; k++) {
+                audio_dsp_design_highpass(&f.coef[k], fc, 0.7071f, s_fs);
+            }
+            double theory = pow(audio_dsp_biquad_magnitude(&f.coef[0], freqs[i], s_fs), stages);
+            //? 暂态按截止频率的若干周期计算，低频测量至少包含10个周期
+            double g = measure_gain(cascade_fn, &f, freqs[i], 40.0 / fc, fmax(0.5, 10.0 / freqs[i]));
+            int pass = fabs(db(g) - db(theory)) < TOL_DB || (db(theory) < -60.0 && db(g) < -55.0);
+            printf("  %7.0f | %9.2f | %11.2f%s\n", freqs[i], db(theory), db(g), pass ? "" : "  <-");
+            ok &= pass;
+        }
+        check(ok, "measured response within %.2f dB of theory", TOL_DB);
+    }
+
+    //? 理论值本身的关键点：截止处-3dB，一个倍频程以下约-12dB，通带平坦
+    audio_dsp_biquad_coef_t c;
+    audio_dsp_design_highpass(&c, fc, 0.7071f, s_fs);
+    check(fabs(db(audio_dsp_biquad_magnitude(&c, fc, s_fs)) + 3.01) < 0.05, "gain at fc = -3 dB (%.0f Hz)", fc);
+    check(db(audio_dsp_biquad_magnitude(&c, fc / 2, s_fs)) < -11.0, "gain at fc/2 < -11 dB (%.0f Hz)", fc / 2);
+    check(fabs(db(audio_dsp_biquad_magnitude(&c, 1000, s_fs))) < 0.1, "passband flat at %.0f Hz", 1000);
+}
+
+//? 均衡段：实测响应与理论值比较，中心/搁架处增益等于设定值
+static void test_eq_band(const char *name, const audio_dsp_biquad_coef_t *c, float f0, float gain_db, double at)
+{
+    static const double freqs[] = {30, 100, 200, 500, 1000, 2000, 4000, 8000, 16000};
+    audio_dsp_biquad_cascade_t f;
+
+    printf("%s %.0f Hz %+.1f dB (shift %u) @ %lu Hz:\n", name, f0, gain_db, c->shift, (unsigned long)s_fs);
+    printf("     freq | theory dB | measured dB\n");
+    int ok = 1;
+    for (size_t i = 0; i < sizeof(freqs) / sizeof(freqs[0]) && freqs[i] < 0.45 * s_fs; i++) {
+        audio_dsp_cascade_init(&f, 1);
+        f.coef[0] = *c;
+        double theory = audio_dsp_biquad_magnitude(c, freqs[i], s_fs);
+        double g = measure_gain(cascade_fn, &f, freqs[i], 0.1, fmax(0.5, 10.0 / freqs[i]));
+        int pass = fabs(db(g) - db(theory)) < TOL_DB;
+        printf("  %7.0f | %9.2f | %11.2f%s\n", freqs[i], db(theory), db(g), pass ? "" : "  <-");
+        ok &= pass;
+    }
+    check(ok, "measured response within %.2f dB of theory", TOL_DB);
+    check(fabs(db(audio_dsp_biquad_magnitude(c, at, s_fs)) - gain_db) < 0.1, "gain at reference point = %+.1f dB", gain_db);
+}
+
+static void test_eq(void)
+{
+    audio_dsp_biquad_coef_t c;
+    //? 提升最多+12dB，激励降到-24dBFS
+    s_amp = AMPLITUDE / 8;
+
+    audio_dsp_design_peaking(&c, 1000.0f, 9.0f, 1.4f, s_fs);
+    test_eq_band("peaking", &c, 1000.0f, 9.0f, 1000.0);
+    audio_dsp_design_peaking(&c, 3000.0f, -12.0f, 2.0f, s_fs);
+    test_eq_band("peaking", &c, 3000.0f, -12.0f, 3000.0);
+    audio_dsp_design_peaking(&c, 120.0f, 12.0f, 0.7f, s_fs);
+    test_eq_band("peaking", &c, 120.0f, 12.0f, 120.0);
+    //? 搁架的参考点取远离转折频率处（接近平台）
+    audio_dsp_design_low_shelf(&c, 200.0f, -6.0f, 0.7071f, s_fs);
+    test_eq_band("low shelf", &c, 200.0f, -6.0f, 10.0);
+    audio_dsp_design_high_shelf(&c, 4000.0f, 6.0f, 0.7071f, s_fs);
+    test_eq_band("high shelf", &c, 4000.0f, 6.0f, 0.45 * s_fs);
+
+    //? 旁路段：输出等于输入
+    audio_dsp_design_bypass(&c);
+    check(fabs(db(audio_dsp_biquad_magnitude(&c, 1000.0, s_fs))) < 1e-6, "bypass flat (%.0f dB)", 0);
+
+    s_amp = AMPLITUDE;
+}
+
+//? 带直流偏置的信号：稳态输出均值必须为0（误差反馈保证没有截断偏置）
+static void test_dc(float fc)
+{
+    static int32_t buf[BLOCK];
+    audio_dsp_biquad_cascade_t f;
+    audio_dsp_dc_block_t d;
+    audio_dsp_cascade_init(&f, 1);
+    audio_dsp_design_highpass(&f.coef[0], fc, 0.7071f, s_fs);
+    audio_dsp_dc_block_init(&d, 10.0f, s_fs);
+
+    //? 叠加奈奎斯特频率的方波：在测量窗口内整周期抵消，不影响均值，但让每个样本都有截断误差
+    printf("DC removal (offset 0x%X + Nyquist tone):\n", 1 << 26);
+    for (int which = 0; which < 2; which++) {
+        double sum = 0.0;
+        size_t count = 0, total = s_fs * 20;
+        for (size_t pos = 0; pos < total; pos += BLOCK) {
+            for (size_t i = 0; i < BLOCK; i++) {
+                buf[i] = (1 << 26) + ((i & 1) ? -12345679 : 12345679);
+            }
+            if (which == 0) {
+                audio_dsp_cascade_process(&f, buf, BLOCK);
+            } else {
+                audio_dsp_dc_block_process(&d, buf, BLOCK);
+            }
+            if (pos >= total - s_fs * 5) {
+                for (size_t i = 0; i < BLOCK; i++) {
+                    sum += buf[i];
+                }
+                count += BLOCK;
+            }
+        }
+        check(fabs(sum / count) < 1.0, which == 0 ? "highpass residual DC %.1f" : "DC blocker residual DC %.1f", sum / count);
+    }
+
+    //? 直流阻断器在通带的增益
+    audio_dsp_dc_block_init(&d, 10.0f, s_fs);
+    double g = measure_gain(dc_fn, &d, 1000.0, 1.0, 0.5);
+    check(fabs(db(g)) < TOL_DB, "DC blocker gain at 1 kHz %.4f dB", db(g));
+}
+
+//? 满幅方波后输入静音：输出必须精确回到0（无极限环），且满幅输入不回绕
+static void test_stability(float fc)
+{
+    static int32_t buf[BLOCK];
+    audio_dsp_biquad_cascade_t f;
+    audio_dsp_cascade_init(&f, 2);
+    audio_dsp_design_highpass(&f.coef[0], fc, 0.7071f, s_fs);
+    audio_dsp_design_highpass(&f.coef[1], fc, 0.7071f, s_fs);
+
+    int wrapped = 0;
+    for (size_t pos = 0; pos < s_fs; pos += BLOCK) {
+        for (size_t i = 0; i < BLOCK; i++) {
+            buf[i] = ((pos + i) / 200) & 1 ? INT32_MAX : INT32_MIN;
+        }
+        int32_t first = buf[0];
+        audio_dsp_cascade_process(&f, buf, BLOCK);
+        //? 方波沿后输出应与输入同号（高通只削弱平台，不反相翻转到另一侧满幅）
+        wrapped |= (pos % 400 == 0) && ((first > 0) != (buf[0] > 0)) && (buf[0] == INT32_MIN || buf[0] == INT32_MAX);
+    }
+    check(!wrapped, "full-scale square wave, no wrap-around%.0s", 0);
+
+    size_t settle_blocks = 0;
+    int zero = 0;
+    for (size_t pos = 0; pos < s_fs * 10 && !zero; pos += BLOCK, settle_blocks++) {
+        memset(buf, 0, sizeof(buf));
+        audio_dsp_cascade_process(&f, buf, BLOCK);
+        zero = 1;
+        for (size_t i = 0; i < BLOCK; i++) {
+            zero &= buf[i] == 0;
+        }
+    }
+    check(zero, "decays to exact zero after %.2f s of silence", (double)settle_blocks * BLOCK / s_fs);
+}
+
+static void comp_fn(void *ctx, int32_t *data, size_t n)
+{
+    audio_dsp_comp_process_s32((audio_dsp_comp_t *)ctx, data, n);
+}
+
+//? 压缩曲线理论值（dB）：与 gain_computer 相同的软拐点公式
+static double comp_theory_db(const audio_dsp_comp_config_t *cfg, double level_db)
+{
+    double d = level_db - cfg->threshold_db;
+    double slope = 1.0 / cfg->ratio - 1.0;
+    double g;
+    if (2.0 * d <= -cfg->knee_db) {
+        g = 0.0;
+    } else if (2.0 * d < cfg->knee_db) {
+        double t = d + cfg->knee_db / 2.0;
+        g = slope * t * t / (2.0 * cfg->knee_db);
+    } else {
+        g = slope * d;
+    }
+    return g + cfg->makeup_db;
+}
+
+//? 电平阶跃后衰减变化到63%所需时间（ms）
+static double comp_step_time(audio_dsp_comp_t *c, double from_db, double to_db)
+{
+    static int32_t buf[AUDIO_DSP_COMP_BLOCK];
+    double ph = 0.0, dph = 2.0 * M_PI * 1000.0 / s_fs;
+    double start = 0.0, end = 0.0, t_cross = -1.0;
+
+    //? 先在起始电平下稳定2秒，再切换并运行2秒
+    for (int phase = 0; phase < 2; phase++) {
+        double amp = 2147483648.0 * pow(10.0, (phase ? to_db : from_db) / 20.0);
+        size_t blocks = 2 * s_fs / AUDIO_DSP_COMP_BLOCK;
+        for (size_t b = 0; b < blocks; b++) {
+            for (size_t i = 0; i < AUDIO_DSP_COMP_BLOCK; i++) {
+                buf[i] = (int32_t)lrint(amp * sin(ph));
+                ph += dph;
+            }
+            ph = fmod(ph, 2.0 * M_PI);
+            audio_dsp_comp_process_s32(c, buf, AUDIO_DSP_COMP_BLOCK);
+        }
+        if (phase == 0) {
+            start = audio_dsp_comp_get_reduction_db(c);
+        }
+    }
+    end = audio_dsp_comp_get_reduction_db(c);
+
+    //? 重新运行阶跃，记录穿越63%的时刻
+    audio_dsp_comp_t r = *c;
+    double amp0 = 2147483648.0 * pow(10.0, from_db / 20.0);
+    double amp1 = 2147483648.0 * pow(10.0, to_db / 20.0);
+    for (size_t b = 0; b < 2 * s_fs / AUDIO_DSP_COMP_BLOCK; b++) {
+        for (size_t i = 0; i < AUDIO_DSP_COMP_BLOCK; i++) {
+            buf[i] = (int32_t)lrint(amp0 * sin(ph));
+            ph += dph;
+        }
+        ph = fmod(ph, 2.0 * M_PI);
+        audio_dsp_comp_process_s32(&r, buf, AUDIO_DSP_COMP_BLOCK);
+    }
+    double target = start + 0.632 * (end - start);
+    for (size_t b = 0; b < 2 * s_fs / AUDIO_DSP_COMP_BLOCK && t_cross < 0.0; b++) {
+        for (size_t i = 0; i < AUDIO_DSP_COMP_BLOCK; i++) {
+            buf[i] = (int32_t)lrint(amp1 * sin(ph));
+            ph += dph;
+        }
+        ph = fmod(ph, 2.0 * M_PI);
+        audio_dsp_comp_process_s32(&r, buf, AUDIO_DSP_COMP_BLOCK);
+        double red = audio_dsp_comp_get_reduction_db(&r);
+        if ((end < start && red <= target) || (end > start && red >= target)) {
+            t_cross = (b + 1) * AUDIO_DSP_COMP_BLOCK * 1000.0 / s_fs;
+        }
+    }
+    return t_cross;
+}
+
+static void test_comp(void)
+{
+    //? 对数/指数近似精度（指数只比较Q16量化误差可忽略的区间）
+    double log_err = 0.0, exp_err = 0.0;
+    for (uint64_t x = 1; x < (1ULL << 32); x = x * 1.0007 + 1) {
+        double e = fabs(audio_dsp_log2_q16((uint32_t)x) / 65536.0 - log2((double)x));
+        log_err = fmax(log_err, e);
+    }
+    for (int32_t y = -(16 << 16); y < (15 << 16); y += 97) {
+        double ref = pow(2.0, y / 65536.0) * 65536.0;
+        if (ref >= 16384.0) {
+            exp_err = fmax(exp_err, fabs(audio_dsp_exp2_q16(y) - ref) / ref);
+        }
+    }
+    printf("compressor:\n");
+    check(log_err * 6.0206 < 0.002, "log2 max error %.5f dB", log_err * 6.0206);
+    check(exp_err < 2e-4, "exp2 max relative error %.2e", exp_err);
+
+    //? 静态曲线：稳态下实测增益与理论值比较（RMS检测，正弦RMS比峰值低3.01dB）
+    audio_dsp_comp_config_t cfg = AUDIO_DSP_COMP_CONFIG_DEFAULT();
+    audio_dsp_comp_t c;
+    printf("  static curve, threshold %.0f dBFS, ratio %.0f:1, knee %.0f dB, makeup %.0f dB:\n",
+           cfg.threshold_db, cfg.ratio, cfg.knee_db, cfg.makeup_db);
+    printf("     peak dBFS | theory dB | measured dB\n");
+    int ok = 1;
+    for (double lvl = -50.0; lvl <= 0.0; lvl += 5.0) {
+        audio_dsp_comp_init(&c, &cfg, s_fs, 1);
+        s_amp = 2147483647.0 * pow(10.0, lvl / 20.0);
+        double theory = comp_theory_db(&cfg, lvl - 3.0103);
+        double g = db(measure_gain(comp_fn, &c, 1000.0, 1.0, 0.5));
+        int pass = fabs(g - theory) < 0.3;
+        printf("  %12.0f | %9.2f | %11.2f%s\n", lvl, theory, g, pass ? "" : "  <-");
+        ok &= pass;
+    }
+    s_amp = AMPLITUDE;
+    check(ok, "measured curve within %.1f dB of theory", 0.3);
+
+    //? 时间常数（峰值检测，排除RMS平均的延迟）
+    cfg.detect = AUDIO_DSP_DETECT_PEAK;
+    audio_dsp_comp_init(&c, &cfg, s_fs, 1);
+    double t_att = comp_step_time(&c, -40.0, -6.0);
+    audio_dsp_comp_init(&c, &cfg, s_fs, 1);
+    double t_rel = comp_step_time(&c, -6.0, -40.0);
+    check(fabs(t_att - cfg.attack_ms) < 0.25 * cfg.attack_ms, "attack %.2f ms", t_att);
+    check(fabs(t_rel - cfg.release_ms) < 0.1 * cfg.release_ms, "release %.1f ms", t_rel);
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void bench(float fc)
+{
+    static int32_t buf[BLOCK];
+    const int rounds = 20000;
+    audio_dsp_biquad_cascade_t f;
+    audio_dsp_dc_block_t d;
+    audio_dsp_dc_block_init(&d, 10.0f, s_fs);
+
+    printf("benchmark: %d samples/block\n", BLOCK);
+    for (int stages = 1; stages <= AUDIO_DSP_BIQUAD_MAX_STAGES; stages *= 2) {
+        audio_dsp_cascade_init(&f, stages);
+        for (int k = 0; k < stages; k++) {
+            audio_dsp_design_highpass(&f.coef[k], fc, 0.7071f, s_fs);
+        }
+        for (size_t i = 0; i < BLOCK; i++) {
+            buf[i] = (int32_t)(i * 0x9E3779B1u) >> 2;
+        }
+        double t0 = now_ns();
+        for (int r = 0; r < rounds; r++) {
+            audio_dsp_cascade_process(&f, buf, BLOCK);
+        }
+        printf("  biquad x%d        %8.1f ns/block\n", stages, (now_ns() - t0) / rounds);
+    }
+    double t0 = now_ns();
+    for (int r = 0; r < rounds; r++) {
+        audio_dsp_dc_block_process(&d, buf, BLOCK);
+    }
+    printf("  dc blocker       %8.1f ns/block\n", (now_ns() - t0) / rounds);
+
+    audio_dsp_comp_t c;
+    for (int detect = AUDIO_DSP_DETECT_PEAK; detect <= AUDIO_DSP_DETECT_RMS; detect++) {
+        audio_dsp_comp_config_t cfg = AUDIO_DSP_COMP_CONFIG_DEFAULT();
+        cfg.detect = (audio_dsp_detect_t)detect;
+        audio_dsp_comp_init(&c, &cfg, s_fs, 1);
+        t0 = now_ns();
+        for (int r = 0; r < rounds; r++) {
+            audio_dsp_comp_process_s32(&c, buf, BLOCK);
+        }
+        printf("  compressor %-4s  %8.1f ns/block\n", detect ? "rms" : "peak", (now_ns() - t0) / rounds);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    s_fs = argc > 1 ? (uint32_t)atoi(argv[1]) : 44100;
+    float fc = argc > 2 ? (float)atof(argv[2]) : 80.0f;
+
+    test_response(fc);
+    test_eq();
+    test_dc(fc);
+    test_stability(fc);
+    test_comp();
+    bench(fc);
+
+    printf("%s\n", s_failed ? "FAILED" : "all passed");
+    return s_failed;
+}
@@ -0,0 +1,205 @@
+/**
+ * audio_pack 主机测试与性能测试
+ * 验证24位/16位打包的往返精度，并测量每个DMA块的打包/解包耗时
+ *
+ * 编译运行（在仓库根目录）：
+ *   gcc -O2 -Icomponents/audio_pack tools/audio_pack_test.c components/audio_pack/audio_pack.c -lm -o audio_pack_test
+ *   ./audio_pack_test [块样本数=256]
+ *
+ * 全部通过时返回0；设备上的每块CPU周期数见 inmp441_pack_benchmark()
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "audio_pack.h"
+
+#define MAX_SAMPLES     4096
+#define BENCH_ROUNDS    20000
+
+static int32_t s_src[MAX_SAMPLES];
+static int32_t s_dst[MAX_SAMPLES];
+static uint32_t s_packed[MAX_SAMPLES];     //? 按字对齐
+static int s_failed = 0;
+
+static uint32_t s_rng = 0x12345678;
+
+static uint32_t rand32(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+static void check(int ok, const char *name)
+{
+    printf("  %-44s %s\n", name, ok ? "ok" : "FAIL");
+    s_failed |= !ok;
+}
+
+//? 生成INMP441格式的样本：随机高24位，低8位为0，并包含满幅边界值
+static void fill_s24(size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        s_src[i] = (int32_t)(rand32() & 0xFFFFFF00u);
+    }
+    if (n >= 4) {
+        s_src[0] = INT32_MIN;
+        s_src[1] = (int32_t)0x7FFFFF00;
+        s_src[2] = -256;
+        s_src[3] = 0;
+    }
+}
+
+//? 24位往返必须逐位相等（覆盖所有尾部长度）
+static void test_s24_roundtrip(void)
+{
+    int ok = 1;
+    for (size_t n = 0; n <= 67 && ok; n++) {
+        fill_s24(n);
+        memset(s_packed, 0xA5, sizeof(s_packed));
+        size_t bytes = audio_pack_s32_to_s24(s_src, (uint8_t *)s_packed, n);
+        ok &= bytes == n * 3;
+        //? 不得写出 3n 字节之外
+        ok &= ((uint8_t *)s_packed)[bytes] == 0xA5;
+        audio_unpack_s24_to_s32((const uint8_t *)s_packed, s_dst, n);
+        ok &= memcmp(s_src, s_dst, n * sizeof(int32_t)) == 0;
+    }
+    check(ok, "s24 round trip exact (n = 0..67)");
+
+    //? 字节序：与逐字节小端打包一致
+    fill_s24(8);
+    audio_pack_s32_to_s24(s_src, (uint8_t *)s_packed, 8);
+    const uint8_t *p = (const uint8_t *)s_packed;
+    ok = 1;
+    for (size_t i = 0; i < 8; i++) {
+        uint32_t v = (uint32_t)s_src[i] >> 8;
+        ok &= p[3 * i] == (uint8_t)v && p[3 * i + 1] == (uint8_t)(v >> 8) && p[3 * i + 2] == (uint8_t)(v >> 16);
+    }
+    check(ok, "s24 little-endian byte layout");
+
+    //? 缓冲区不按字对齐（如帧头之后）：结果与对齐时一致
+    ok = 1;
+    for (size_t off = 1; off < 4; off++) {
+        uint8_t *u = (uint8_t *)s_packed + off;
+        fill_s24(61);
+        audio_pack_s32_to_s24(s_src, u, 61);
+        audio_unpack_s24_to_s32(u, s_dst, 61);
+        ok &= memcmp(s_src, s_dst, 61 * sizeof(int32_t)) == 0;
+    }
+    check(ok, "s24 round trip at unaligned offsets 1..3");
+}
+
+//? 16位：高16位数据往返相等；一般数据误差不超过半个LSB
+static void test_s16(void)
+{
+    int16_t *p16 = (int16_t *)s_packed;
+    int ok = 1;
+    for (size_t i = 0; i < MAX_SAMPLES; i++) {
+        s_src[i] = (int32_t)(rand32() & 0xFFFF0000u);
+    }
+    audio_pack_s32_to_s16(s_src, p16, MAX_SAMPLES, NULL);
+    audio_unpack_s16_to_s32(p16, s_dst, MAX_SAMPLES);
+    ok = memcmp(s_src, s_dst, sizeof(s_src)) == 0;
+    check(ok, "s16 round trip exact for 16-bit data");
+
+    ok = 1;
+    for (size_t i = 0; i < MAX_SAMPLES; i++) {
+        s_src[i] = (int32_t)rand32();
+    }
+    s_src[0] = INT32_MAX;
+    s_src[1] = INT32_MIN;
+    audio_pack_s32_to_s16(s_src, p16, MAX_SAMPLES, NULL);
+    for (size_t i = 0; i < MAX_SAMPLES; i++) {
+        double err = (double)p16[i] * 65536.0 - s_src[i];
+        ok &= fabs(err) <= 32768.0 || (i == 0 && p16[0] == INT16_MAX);
+    }
+    ok &= p16[0] == INT16_MAX && p16[1] == INT16_MIN;
+    check(ok, "s16 rounding error <= 0.5 LSB, saturates");
+
+    //? 抖动：误差不超过1.5个LSB，满幅不回绕，均值无偏
+    audio_pack_dither_t d;
+    audio_pack_dither_init(&d, 1);
+    for (size_t i = 0; i < MAX_SAMPLES; i++) {
+        s_src[i] = (int32_t)(rand32() & 0xFFFFFF00u);
+    }
+    s_src[0] = INT32_MAX;
+    s_src[1] = INT32_MIN;
+    audio_pack_s32_to_s16(s_src, p16, MAX_SAMPLES, &d);
+    ok = p16[0] >= INT16_MAX - 1 && p16[1] <= INT16_MIN + 1;
+    double sum = 0.0;
+    for (size_t i = 2; i < MAX_SAMPLES; i++) {
+        double err = (double)p16[i] * 65536.0 - s_src[i];
+        ok &= fabs(err) <= 1.5 * 65536.0;
+        sum += err;
+    }
+    ok &= fabs(sum / (MAX_SAMPLES - 2)) < 0.1 * 65536.0;
+    check(ok, "s16 TPDF dither bounded and unbiased");
+}
+
+static void test_dispatch(void)
+{
+    int ok = 1;
+    const audio_pack_format_t fmts[] = {AUDIO_PACK_S32, AUDIO_PACK_S24, AUDIO_PACK_S16};
+    fill_s24(256);
+    for (size_t f = 0; f < 3; f++) {
+        size_t bytes = audio_pack(fmts[f], s_src, s_packed, 256, NULL);
+        ok &= bytes == audio_pack_bytes(fmts[f], 256);
+        ok &= audio_unpack(fmts[f], s_packed, bytes, s_dst) == 256;
+        if (fmts[f] != AUDIO_PACK_S16) {
+            ok &= memcmp(s_src, s_dst, 256 * sizeof(int32_t)) == 0;
+        }
+    }
+    check(ok, "audio_pack / audio_unpack dispatch");
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+#define BENCH(name, stmt) do {                                              \
+    double t0 = now_ns();                                                   \
+    for (int r = 0; r < BENCH_ROUNDS; r++) {                                \
+        stmt;                                                               \
+        __asm__ volatile("" ::: "memory");                                  \
+    }                                                                       \
+    printf("  %-22s %8.1f ns/block  %7.1f Msamples/s\n", name,              \
+           (now_ns() - t0) / BENCH_ROUNDS, (double)n * BENCH_ROUNDS * 1e3 / (now_ns() - t0)); \
+} while (0)
+
+static void bench(size_t n)
+{
+    audio_pack_dither_t d;
+    audio_pack_dither_init(&d, 1);
+    fill_s24(n);
+    printf("benchmark: %zu samples/block, %d rounds\n", n, BENCH_ROUNDS);
+    BENCH("pack s24", audio_pack_s32_to_s24(s_src, (uint8_t *)s_packed, n));
+    BENCH("unpack s24", audio_unpack_s24_to_s32((const uint8_t *)s_packed, s_dst, n));
+    BENCH("pack s16", audio_pack_s32_to_s16(s_src, (int16_t *)s_packed, n, NULL));
+    BENCH("pack s16 + dither", audio_pack_s32_to_s16(s_src, (int16_t *)s_packed, n, &d));
+    BENCH("unpack s16", audio_unpack_s16_to_s32((const int16_t *)s_packed, s_dst, n));
+    BENCH("copy s32", memcpy(s_dst, s_src, n * sizeof(int32_t)));
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? (size_t)atoi(argv[1]) : 256;
+    if (n == 0 || n > MAX_SAMPLES) {
+        n = 256;
+    }
+
+    printf("round trip:\n");
+    test_s24_roundtrip();
+    test_s16();
+    test_dispatch();
+    bench(n);
+
+    printf("%s\n", s_failed ? "FAILED" : "all passed");
+    return s_failed;
+}
@@ -0,0 +1,230 @@
+/**
+ * audio_player 主机测试
+ * 用替身输出级（与 max98367a 的 process_block 一样：未标记 MAX98367A_CLIP_PRESCALED 的块乘以音量并饱和）
+ * 驱动调度器的拉模式音源，检查预缩放片段在各种音量下不削波、普通声音按音量缩放，以及两者在同一块中衔接
+ *
+ * 编译运行（在仓库根目录）：
+ *   gcc -O2 -Itools/host_stubs -Icomponents/audio_dsp -Icomponents/MAX98367A -Icomponents/audio_player tools/audio_player_test.c -lm -o audio_player_test
+ *   ./audio_player_test
+ *
+ * 全部通过时返回0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+//? 不引入 I2S 驱动头文件，以下是调度器用到的 MAX98367A 接口子集（32位单声道输出）
+#define _MAX98367A_H_
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+#include "audio_dsp.h"
+
+#define MAX98367A_CHANNEL_NUM       1
+#define MAX98367A_BIT_WIDTH         32
+#define MAX98367A_BLOCK_SAMPLES_MAX 512
+#define MAX98367A_MIN_SAMPLE_RATE   8000
+#define MAX98367A_MAX_SAMPLE_RATE   48000
+#define MAX98367A_CLIP_PRESCALED    (1u << 0)
+
+typedef int32_t max98367a_sample_t;
+
+typedef struct {
+    const void *data;
+    size_t len;
+    uint32_t flags;
+    uint8_t channels;
+    uint8_t bits;
+    uint32_t sample_rate;
+} max98367a_clip_t;
+
+typedef struct {
+    uint32_t dma_desc_num;
+    uint32_t dma_frame_num;
+    uint32_t headroom_blocks;
+} max98367a_dma_stats_t;
+
+typedef size_t (*max98367a_source_fn_t)(max98367a_sample_t *buf, size_t frames, void *arg);
+
+static float s_volume = 1.0f;
+static uint32_t s_flags = 0;
+
+float max98367a_get_gain(void)
+{
+    return s_volume;
+}
+
+uint32_t max98367a_get_sample_rate(void)
+{
+    return 44100;
+}
+
+esp_err_t max98367a_set_sample_rate(uint32_t sample_rate)
+{
+    (void)sample_rate;
+    return ESP_OK;
+}
+
+void max98367a_get_dma_stats(max98367a_dma_stats_t *stats)
+{
+    stats->dma_desc_num = 6;
+    stats->dma_frame_num = 256;
+    stats->headroom_blocks = 0;
+}
+
+void max98367a_source_set_flags(uint32_t flags)
+{
+    s_flags = flags;
+}
+
+size_t max98367a_clip_read(const max98367a_clip_t *clip, size_t frame, max98367a_sample_t *dst, size_t frames)
+{
+    size_t total = clip->len / sizeof(int32_t);
+    if (frame >= total) {
+        return 0;
+    }
+    frames = frames < total - frame ? frames : total - frame;
+    memcpy(dst, (const int32_t *)clip->data + frame, frames * sizeof(int32_t));
+    return frames;
+}
+
+void max98367a_mix_s32(int32_t *dst, const int32_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        int64_t v = (int64_t)dst[i] + src[i];
+        dst[i] = (int32_t)(v > INT32_MAX ? INT32_MAX : (v < INT32_MIN ? INT32_MIN : v));
+    }
+}
+
+void max98367a_mix_s16(int16_t *dst, const int16_t *src, size_t n)
+{
+    (void)dst; (void)src; (void)n;
+}
+
+esp_err_t max98367a_play_source(max98367a_source_fn_t fn, void *arg, TickType_t timeout)
+{
+    (void)fn; (void)arg; (void)timeout;
+    return ESP_OK;
+}
+
+#include "../components/audio_player/audio_player.c"
+
+#define BLOCK       256
+#define CLIP_FRAMES 600
+#define LEVEL       0x70000000      //? 约 -1.2 dBFS
+
+static int s_failed = 0;
+static int32_t s_loud[CLIP_FRAMES];
+
+static void check(int ok, const char *name)
+{
+    printf("  %-56s %s\n", name, ok ? "ok" : "FAIL");
+    s_failed |= !ok;
+}
+
+//? 输出级替身：调度器生成一块，未标记预缩放时乘以音量（Q16，饱和）
+static size_t render_block(int32_t *out)
+{
+    s_flags = 0;
+    size_t n = player_source(out, BLOCK, NULL);
+    if (!(s_flags & MAX98367A_CLIP_PRESCALED)) {
+        int64_t k = lrintf(s_volume * 65536.0f);
+        for (size_t i = 0; i < n; i++) {
+            int64_t v = ((int64_t)out[i] * k) >> 16;
+            out[i] = (int32_t)(v > INT32_MAX ? INT32_MAX : (v < INT32_MIN ? INT32_MIN : v));
+        }
+    }
+    return n;
+}
+
+//? 播放一个声音直到结束，比较每帧输出与 expect(原样本)，返回最大偏差
+static int64_t play_and_compare(uint16_t id, float volume, int64_t (*expect)(int32_t x, float volume))
+{
+    static int32_t out[BLOCK];
+    int64_t worst = 0;
+    size_t pos = 0;
+    s_volume = volume;
+    audio_player_play(id, 1, AUDIO_PLAYER_ENQUEUE, NULL);
+    size_t n;
+    while ((n = render_block(out)) > 0) {
+        for (size_t i = 0; i < n; i++, pos++) {
+            int64_t d = llabs(out[i] - expect(s_loud[pos], volume));
+            worst = d > worst ? d : worst;
+        }
+    }
+    return pos == CLIP_FRAMES ? worst : INT64_MAX;
+}
+
+static int64_t expect_unchanged(int32_t x, float volume)
+{
+    (void)volume;
+    return x;
+}
+
+//? 音量按Q16量化，与输出级一致
+static int64_t expect_scaled(int32_t x, float volume)
+{
+    return ((int64_t)x * lrintf(volume * 65536.0f)) >> 16;
+}
+
+//? 预缩放片段：数据已含音量，任何音量下都原样输出（修复前音量<1时先被放大到饱和再缩小）
+static void test_prescaled(void)
+{
+    static const float volumes[] = {0.2f, 0.5f, 1.0f, 2.0f};
+    printf("prescaled clip:\n");
+    for (size_t i = 0; i < sizeof(volumes) / sizeof(volumes[0]); i++) {
+        char name[64];
+        snprintf(name, sizeof(name), "output unchanged at volume %.1f", volumes[i]);
+        check(play_and_compare(0, volumes[i], expect_unchanged) == 0, name);
+    }
+}
+
+//? 普通片段：由输出级乘以音量
+static void test_plain(void)
+{
+    printf("plain clip:\n");
+    check(play_and_compare(1, 0.2f, expect_scaled) <= 1, "scaled by volume 0.2");
+}
+
+//? 普通片段后紧接预缩放片段：同一块内前段补乘音量，后段原样
+static void test_chain(void)
+{
+    static int32_t out[BLOCK];
+    printf("plain then prescaled in one block:\n");
+    s_volume = 0.2f;
+    audio_player_play(2, 1, AUDIO_PLAYER_ENQUEUE, NULL);
+    audio_player_play(0, 1, AUDIO_PLAYER_ENQUEUE, NULL);
+    size_t n = render_block(out);
+    int ok = n == BLOCK && (s_flags & MAX98367A_CLIP_PRESCALED);
+    for (size_t i = 0; i < 100; i++) {
+        ok &= llabs(out[i] - expect_scaled(s_loud[i], s_volume)) <= 1;
+    }
+    for (size_t i = 100; i < BLOCK; i++) {
+        ok &= out[i] == s_loud[i - 100];
+    }
+    check(ok, "100 plain frames at 0.2, then prescaled unchanged");
+    while (render_block(out) > 0) {
+    }
+}
+
+int main(void)
+{
+    for (size_t i = 0; i < CLIP_FRAMES; i++) {
+        s_loud[i] = (int32_t)(LEVEL * sin(2.0 * M_PI * 1000.0 * i / 44100.0));
+    }
+    const max98367a_clip_t prescaled = {.data = s_loud, .len = sizeof(s_loud), .flags = MAX98367A_CLIP_PRESCALED};
+    const max98367a_clip_t plain = {.data = s_loud, .len = sizeof(s_loud)};
+    const max98367a_clip_t short_plain = {.data = s_loud, .len = 100 * sizeof(int32_t)};
+
+    audio_player_init(NULL, NULL);
+    audio_player_register(0, &(audio_player_sound_t){.clip = &prescaled});
+    audio_player_register(1, &(audio_player_sound_t){.clip = &plain});
+    audio_player_register(2, &(audio_player_sound_t){.clip = &short_plain});
+
+    test_prescaled();
+    test_plain();
+    test_chain();
+    printf("%s\n", s_failed ? "FAILED" : "all passed");
+    return s_failed;
+}
@@ -0,0 +1,158 @@
+/**
+ * audio_sync 漂移补偿主机仿真
+ * 模拟服务器按带漂移的时钟产生音频块，经网络抖动送入播放队列，
+ * 本地按I2S时钟逐DMA块消费，统计长时间运行中队列水位、溢出和欠载
+ *
+ * 编译运行（在仓库根目录）：
+ *   gcc -O2 -Icomponents/audio_sync tools/audio_sync_sim.c components/audio_sync/audio_sync.c -lm -o audio_sync_sim
+ *   ./audio_sync_sim [漂移ppm=300] [小时=24] [抖动均值ms=10] [温漂幅度ppm=30] [nocomp]
+ *
+ * 加 nocomp 参数（任意位置，如 ./audio_sync_sim 300 24 nocomp）关闭补偿作对比
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "audio_sync.h"
+
+#define FS              44100       //? 本地I2S采样率
+#define NET_BLOCK       512         //? 网络音频块样本数（WSS_AUDIO_BLOCK_SIZE / 4）
+#define DMA_BLOCK       256         //? 每次写入I2S的样本数
+#define QUEUE_BLOCKS    16          //? 播放队列容量（块）
+#define TARGET_BLOCKS   8           //? 目标水位（块）
+#define JITTER_CAP      4.0         //? 抖动上限（均值的倍数），超出部分视为丢包重传，由 STALL 模拟
+#define STALL_PROB      0.0001      //? 每块发生网络卡顿的概率
+#define STALL_MS        50.0        //? 卡顿时长
+#define TEMP_PERIOD_S   5400.0      //? 温漂周期
+
+static uint64_t s_rng = 0x9E3779B97F4A7C15ULL;
+
+static double rand_uniform(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 7;
+    s_rng ^= s_rng << 17;
+    return ((s_rng >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+int main(int argc, char **argv)
+{
+    //? nocomp 可出现在任意位置，其余参数按顺序为数值
+    double params[4] = {300.0, 24.0, 10.0, 30.0};
+    int nparams = 0;
+    int comp = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "nocomp") == 0) {
+            comp = 0;
+        } else if (nparams < 4) {
+            params[nparams++] = atof(argv[i]);
+        }
+    }
+    double drift_ppm = params[0];
+    double hours = params[1];
+    double jitter_ms = params[2];
+    double temp_ppm = params[3];
+
+    audio_sync_config_t cfg = AUDIO_SYNC_CONFIG_DEFAULT(FS, TARGET_BLOCKS * NET_BLOCK);
+    audio_sync_t sync;
+    audio_sync_init(&sync, &cfg);
+
+    //? 网络块内容：1kHz正弦，让插值真实运行
+    static int32_t in[NET_BLOCK];
+    static int32_t out[NET_BLOCK * 2];
+    double phase = 0.0;
+
+    //? 时间单位：本地输出样本
+    const double end = hours * 3600.0 * FS;
+    double gen_t = 0.0;             //? 下一块在服务器端产生的时刻
+    double last_deliver = 0.0;      //? 保序：送达时刻不早于上一块
+    double deliver_t;
+    int queue = 0;                  //? 队列中的块数
+    double out_fifo = 0.0;          //? 已重采样、待写入I2S的样本数
+    double t = TARGET_BLOCKS * NET_BLOCK;   //? 预缓冲后开始播放
+    uint32_t since_update = 0;
+
+    uint64_t overflows = 0, underruns = 0, total_over = 0, total_under = 0;
+    int fill_min = QUEUE_BLOCKS, fill_max = 0;
+    double next_report = 3600.0 * FS;
+
+    printf("drift %.1f ppm + %.1f ppm/%.0fs temp, jitter %.1f ms, compensation %s\n",
+           drift_ppm, temp_ppm, TEMP_PERIOD_S, jitter_ms, comp ? "on" : "off");
+    printf(" hour | true ppm | est ppm | corr ppm | fill avg | fill min/max | overflow | underrun\n");
+
+    //? 第一块在0时刻送达
+    deliver_t = 0.0;
+
+    while (t < end) {
+        //? 投递所有在本DMA块之前到达的网络块
+        while (deliver_t <= t) {
+            if (queue < QUEUE_BLOCKS) {
+                queue++;
+            } else {
+                overflows++;
+            }
+            double d = drift_ppm + temp_ppm * sin(2.0 * M_PI * gen_t / (TEMP_PERIOD_S * FS));
+            gen_t += NET_BLOCK / (1.0 + d * 1e-6);
+            double delay = fmin(-log(rand_uniform()), JITTER_CAP) * jitter_ms * FS / 1000.0;
+            if (rand_uniform() < STALL_PROB) {
+                delay += STALL_MS * FS / 1000.0;
+            }
+            deliver_t = gen_t + delay;
+            if (deliver_t < last_deliver) {
+                deliver_t = last_deliver;
+            }
+            last_deliver = deliver_t;
+        }
+
+        //? 消费一个DMA块：不够时从队列取网络块重采样
+        while (out_fifo < DMA_BLOCK) {
+            if (queue == 0) {
+                underruns++;
+                out_fifo = DMA_BLOCK;   //? 输出静音
+                break;
+            }
+            queue--;
+            for (int i = 0; i < NET_BLOCK; i++) {
+                in[i] = (int32_t)(1e9 * sin(phase));
+                phase += 2.0 * M_PI * 1000.0 / FS;
+            }
+            phase = fmod(phase, 2.0 * M_PI);
+            size_t n = audio_sync_process(&sync, in, NET_BLOCK, out, sizeof(out) / sizeof(out[0]));
+            out_fifo += n;
+            if (comp) {
+                audio_sync_update(&sync, queue * NET_BLOCK + (uint32_t)out_fifo, since_update);
+                since_update = 0;
+            }
+        }
+        out_fifo -= DMA_BLOCK;
+        since_update += DMA_BLOCK;
+        t += DMA_BLOCK;
+
+        if (queue < fill_min) {
+            fill_min = queue;
+        }
+        if (queue > fill_max) {
+            fill_max = queue;
+        }
+
+        if (t >= next_report) {
+            double d = drift_ppm + temp_ppm * sin(2.0 * M_PI * gen_t / (TEMP_PERIOD_S * FS));
+            printf("%5.0f | %8.1f | %7.1f | %8.1f | %8.2f | %5d / %-5d | %8llu | %8llu\n",
+                   t / (3600.0 * FS), d, audio_sync_get_drift_ppm(&sync), audio_sync_get_ppm(&sync),
+                   sync.fill_avg / NET_BLOCK, fill_min, fill_max,
+                   (unsigned long long)overflows, (unsigned long long)underruns);
+            total_over += overflows;
+            total_under += underruns;
+            overflows = underruns = 0;
+            fill_min = QUEUE_BLOCKS;
+            fill_max = 0;
+            next_report += 3600.0 * FS;
+        }
+    }
+
+    printf("total: %llu overflow, %llu underrun, in %llu / out %llu samples\n",
+           (unsigned long long)total_over, (unsigned long long)total_under,
+           (unsigned long long)sync.in_total, (unsigned long long)sync.out_total);
+    return (total_over + total_under) ? 1 : 0;
+}
@@ -0,0 +1,237 @@
+/**
+ * audio_synth 主机测试与性能测试
+ * 检查振荡器频率精度与失真、DTMF双音频率、序列时长、起止无爆音，并测量每块生成耗时
+ *
+ * 编译运行（在仓库根目录）：
+ *   gcc -O2 -Icomponents/audio_synth tools/audio_synth_test.c components/audio_synth/audio_synth.c -lm -o audio_synth_test
+ *   ./audio_synth_test [采样率=44100]
+ *
+ * 全部通过时返回0
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "audio_synth.h"
+
+#define BLOCK           256
+#define MAX_SECONDS     4
+
+static uint32_t s_fs = 44100;
+static int s_failed = 0;
+static int16_t *s_buf;          //? MAX_SECONDS 秒单声道输出
+
+static void check(int ok, const char *fmt, double v)
+{
+    printf("  ");
+    printf(fmt, v);
+    printf("%s\n", ok ? "  ok" : "  FAIL");
+    s_failed |= !ok;
+}
+
+//? 按块生成，直到合成器空闲或达到上限，返回样本数
+static size_t render_until_idle(audio_synth_t *s, size_t max)
+{
+    size_t n = 0;
+    while (n + BLOCK <= max && audio_synth_busy(s)) {
+        audio_synth_render_s16(s, s_buf + n, BLOCK, 1);
+        n += BLOCK;
+    }
+    return n;
+}
+
+//? 加Hann窗的Goertzel：x 中频率 f 的幅度（相对满幅，正弦峰值），窗口不必是整数周期
+static double goertzel(const int16_t *x, size_t n, double f)
+{
+    double w = 2.0 * M_PI * f / s_fs;
+    double c = 2.0 * cos(w), s1 = 0.0, s2 = 0.0, wsum = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        double h = 0.5 - 0.5 * cos(2.0 * M_PI * i / n);
+        double s0 = h * x[i] + c * s1 - s2;
+        s2 = s1;
+        s1 = s0;
+        wsum += h;
+    }
+    double p = s1 * s1 + s2 * s2 - c * s1 * s2;
+    return 2.0 * sqrt(fmax(p, 0.0)) / wsum / 32768.0;
+}
+
+//? 频率精度与失真：上升沿过零点线性插值测周期
+static void test_oscillator(void)
+{
+    static const double freqs[] = {100.0, 440.0, 1000.0, 3150.5};
+    audio_synth_t s;
+    audio_synth_init(&s, s_fs);
+
+    printf("oscillator @ %lu Hz:\n", (unsigned long)s_fs);
+    for (size_t k = 0; k < sizeof(freqs) / sizeof(freqs[0]); k++) {
+        audio_synth_init(&s, s_fs);
+        audio_synth_note_on(&s, freqs[k], AUDIO_SYNTH_SINE, NULL, 32000);
+        size_t n = s_fs * 2;
+        audio_synth_render_s16(&s, s_buf, n, 1);
+
+        //? 跳过起音，统计其后的过零
+        double first = -1.0, last = 0.0;
+        int cycles = -1;
+        for (size_t i = s_fs / 10; i + 1 < n; i++) {
+            if (s_buf[i] < 0 && s_buf[i + 1] >= 0) {
+                double t = i + (double)-s_buf[i] / (s_buf[i + 1] - s_buf[i]);
+                first = first < 0.0 ? t : first;
+                last = t;
+                cycles++;
+            }
+        }
+        double f = cycles * (double)s_fs / (last - first);
+        check(fabs(f - freqs[k]) < 0.01, "sine %.2f Hz", f);
+
+        //? 谐波失真（后一半数据，只统计低于奈奎斯特频率的谐波）
+        double fund = goertzel(s_buf + n / 2, n / 2, freqs[k]);
+        double harm = 1e-9;
+        for (int h = 2; h <= 5 && h * freqs[k] < 0.5 * s_fs; h++) {
+            harm = fmax(harm, goertzel(s_buf + n / 2, n / 2, h * freqs[k]));
+        }
+        check(20.0 * log10(harm / fund + 1e-12) < -70.0, "  harmonics %.1f dBc", 20.0 * log10(harm / fund + 1e-12));
+    }
+}
+
+//? DTMF：每个按键窗口内最强的两个频率须为该键的行/列频率，间隔内静音
+static void test_dtmf(void)
+{
+    static const uint16_t freqs[8] = {697, 770, 852, 941, 1209, 1336, 1477, 1633};
+    const char *digits = "159#0*AD";
+    const uint16_t on_ms = 80, off_ms = 60;
+    audio_synth_t s;
+    audio_synth_init(&s, s_fs);
+
+    printf("DTMF \"%s\" (%u/%u ms):\n", digits, on_ms, off_ms);
+    size_t keys = audio_synth_play_dtmf(&s, digits, on_ms, off_ms);
+    check(keys == strlen(digits), "%.0f keys accepted", (double)keys);
+    size_t n = render_until_idle(&s, s_fs * MAX_SECONDS);
+
+    size_t on = on_ms * s_fs / 1000, period = (on_ms + off_ms) * s_fs / 1000;
+    int ok = 1;
+    double leak = 0.0;
+    for (size_t k = 0; k < keys; k++) {
+        uint16_t row, col;
+        audio_synth_dtmf_freq(digits[k], &row, &col);
+        //? 去掉起音/释音，只分析中间部分
+        const int16_t *x = s_buf + k * period + on / 8;
+        size_t len = on * 3 / 4;
+        double mag[8];
+        int best = 0, second = -1;
+        for (int i = 0; i < 8; i++) {
+            mag[i] = goertzel(x, len, freqs[i]);
+            if (mag[i] > mag[best]) {
+                best = i;
+            }
+        }
+        for (int i = 0; i < 8; i++) {
+            if (i != best && (second < 0 || mag[i] > mag[second])) {
+                second = i;
+            }
+        }
+        uint16_t a = freqs[best < second ? best : second], b = freqs[best < second ? second : best];
+        ok &= (a == row && b == col);
+        //? 间隔后段（释音结束后）应为静音
+        const int16_t *gap = s_buf + k * period + on + (period - on) / 2;
+        for (size_t i = 0; i < (period - on) / 2; i++) {
+            leak = fmax(leak, fabs((double)gap[i]));
+        }
+    }
+    check(ok, "row/col tones detected for all %.0f keys", (double)keys);
+    check(leak < 4.0, "gaps silent (peak %.0f LSB)", leak);
+    check(n >= keys * period - period && n <= keys * period + BLOCK, "sequence length %.0f ms", n * 1000.0 / s_fs);
+}
+
+//? 内置序列：时长不短于标称值，首样本和结尾接近0，不削波
+static void test_clicks(void)
+{
+    static const struct { const audio_synth_seq_t *seq; const char *name; } seqs[] = {
+        {&audio_synth_seq_chime, "chime"},
+        {&audio_synth_seq_alert, "alert"},
+        {&audio_synth_seq_success, "success"},
+        {&audio_synth_seq_error, "error"},
+    };
+    audio_synth_t s;
+    int ok = 1;
+
+    printf("built-in sequences:\n");
+    for (size_t k = 0; k < sizeof(seqs) / sizeof(seqs[0]); k++) {
+        const audio_synth_seq_t *q = seqs[k].seq;
+        audio_synth_init(&s, s_fs);
+        audio_synth_play(&s, q);
+        size_t n = render_until_idle(&s, s_fs * MAX_SECONDS);
+
+        //? 序列标称时长（不含最后的释音尾巴）
+        uint32_t ms = 0;
+        for (uint16_t i = 0; i < q->count; i++) {
+            ms += q->steps[i].on_ms + q->steps[i].off_ms;
+        }
+        ms *= (q->repeat + 1u);
+
+        int peak = 0;
+        for (size_t i = 0; i < n; i++) {
+            peak = abs(s_buf[i]) > peak ? abs(s_buf[i]) : peak;
+        }
+        //? 最后一个非零样本之前0.5ms内的电平
+        size_t end = n;
+        while (end > 0 && s_buf[end - 1] == 0) {
+            end--;
+        }
+        int tail = 0;
+        for (size_t i = end > s_fs / 2000 ? end - s_fs / 2000 : 0; i < end; i++) {
+            tail = abs(s_buf[i]) > tail ? abs(s_buf[i]) : tail;
+        }
+        int pass = n * 1000.0 / s_fs >= ms && abs(s_buf[0]) < 2000 && tail < 16 && peak < 32767;
+        printf("  %-8s %5.0f ms (nominal %u ms), peak %5.1f dBFS, first %d, tail %d LSB%s\n",
+               seqs[k].name, n * 1000.0 / s_fs, (unsigned)ms, 20.0 * log10(peak / 32768.0), s_buf[0], tail,
+               pass ? "" : "  <-");
+        ok &= pass;
+    }
+    check(ok, "no clicks at start/end, no clipping, full length (%.0f sequences)", (double)(sizeof(seqs) / sizeof(seqs[0])));
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void bench(void)
+{
+    static int32_t out32[BLOCK * 2];
+    const int rounds = 20000;
+    audio_synth_t s;
+
+    printf("benchmark: %d frames/block\n", BLOCK);
+    for (int voices = 0; voices <= AUDIO_SYNTH_MAX_VOICES; voices++) {
+        audio_synth_init(&s, s_fs);
+        audio_synth_adsr_t hold = {1, 0, 32767, 1};
+        for (int v = 0; v < voices; v++) {
+            audio_synth_note_on(&s, 440.0f * (v + 1), AUDIO_SYNTH_TRIANGLE, &hold, 6000);
+        }
+        double t0 = now_ns();
+        for (int r = 0; r < rounds; r++) {
+            audio_synth_render_s32(&s, out32, BLOCK, 2);
+        }
+        printf("  %d voice(s) s32 stereo %8.1f ns/block\n", voices, (now_ns() - t0) / rounds);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    s_fs = argc > 1 ? (uint32_t)atoi(argv[1]) : 44100;
+    s_buf = calloc((size_t)s_fs * MAX_SECONDS, sizeof(int16_t));
+
+    test_oscillator();
+    test_dtmf();
+    test_clicks();
+    bench();
+
+    printf("%s\n", s_failed ? "FAILED" : "all passed");
+    free(s_buf);
+    return s_failed;
+}
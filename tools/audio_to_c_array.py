@@ -1,38 +1,58 @@
 #!/usr/bin/env python3
 # -*- coding: utf-8 -*-
 """
-音频文件转ESP32数组工具
-将音频文件转换为C语言数组格式，用于MAX98367A播放
+音频文件转ESP32二进制资源工具
+将音频文件转换为小端序二进制资源（.bin），通过汇编 .incbin 直接链接进固件，用于MAX98367A播放
 
 使用方法：
-1. 确保已安装FFmpeg
+1. 确保已安装FFmpeg和numpy（pip install numpy）
 2. 运行: python audio_to_c_array.py input_audio.mp3
-3. 生成的audio_data.h文件可直接包含到ESP32项目中
+3. 生成三个文件，复制到ESP32项目的main目录：
+   - audio_data.bin : 原始PCM数据（int32小端）
+   - audio_data.S   : 用 .incbin 引入 .bin，导出 audio_data / audio_data_len 符号
+   - audio_data.h   : extern声明与格式宏，可被多个源文件重复包含
+4. 在 main/CMakeLists.txt 的 SRCS 中加入 "audio_data.S"
+
+增益烘焙（可选）：
+  python audio_to_c_array.py voice.mp3 --normalize-peak -1 --gain 0.9
+  构建时完成峰值归一化和增益（饱和处理），头文件中 AUDIO_DATA_PRESCALED 为 1，
+  播放时以 MAX98367A_CLIP_PRESCALED 标志调用 max98367a_play_clip()，跳过运行时增益
+
+相比逐样本生成十六进制C数组，.bin 由numpy一次性写出，汇编器直接拷贝字节，
+生成时间和全量编译时间都降低几个数量级
 
 支持的输入格式：MP3, WAV, M4A等（任何FFmpeg支持的格式）
 """
 
-import sys
+import argparse
 import os
+import re
 import subprocess
-import struct
+import sys
+
+import numpy as np
+
+SAMPLE_RATE = 44100
+CHANNELS = 1
+BITS = 32
+
 
-def convert_audio_to_raw(input_file, output_file="temp_audio.raw"):
+def convert_audio_to_raw(input_file, output_file="temp_audio.raw", sample_rate=SAMPLE_RATE, channels=CHANNELS, bits=BITS):
     """
-    使用FFmpeg将音频转换为32bit 44100Hz立体声RAW格式
+    使用FFmpeg将音频转换为16/32bit小端RAW格式
     """
     print(f"正在转换音频文件: {input_file}")
-    
+
     cmd = [
         'ffmpeg',
         '-i', input_file,
-        '-ar', '44100',      # 采样率
-        '-ac', '2',          # 立体声
-        '-f', 's32le',       # 32位有符号小端
-        '-y',                # 覆盖已存在的文件
+        '-ar', str(sample_rate),    # 采样率
+        '-ac', str(channels),       # 声道数
+        '-f', f's{bits}le',         # 16/32位有符号小端
+        '-y',                       # 覆盖已存在的文件
         output_file
     ]
-    
+
     try:
         result = subprocess.run(cmd, capture_output=True, text=True)
         if result.returncode != 0:
@@ -44,131 +64,198 @@ def convert_audio_to_raw(input_file, output_file="temp_audio.raw"):
         print("错误: 未找到FFmpeg，请确保已安装FFmpeg并添加到系统PATH")
         return False
 
-def raw_to_c_array(raw_file, header_file="audio_data.h", array_name="audio_data"):
+
+def probe_sample_rate(input_file):
     """
-    将RAW音频数据转换为C数组
+    读取输入文件的原生采样率（解析 ffmpeg -i 输出），失败返回None
     """
-    print(f"正在生成C头文件: {header_file}")
-    
-    # 读取RAW数据
-    with open(raw_file, 'rb') as f:
-        audio_data = f.read()
-    
-    data_len = len(audio_data)
+    try:
+        result = subprocess.run(['ffmpeg', '-hide_banner', '-i', input_file], capture_output=True, text=True)
+    except FileNotFoundError:
+        return None
+    m = re.search(r'Audio:.*?(\d+) Hz', result.stderr)
+    return int(m.group(1)) if m else None
+
+
+def load_raw(raw_file, bits=BITS):
+    """
+    读取RAW音频数据为int32/int16数组（小端）
+    """
+    return np.fromfile(raw_file, dtype='<i4' if bits == 32 else '<i2')
+
+
+def bake_gain(samples, gain=None, normalize_peak_db=None, bits=BITS):
+    """
+    构建时烘焙增益：先按峰值归一化到 normalize_peak_db（dBFS），再乘以 gain，饱和到目标位宽
+    返回 (处理后样本, 实际总增益)
+    """
+    full_scale = float(2 ** (bits - 1) - 1)
+    x = samples.astype(np.float64)
+    total_gain = 1.0
+    if normalize_peak_db is not None:
+        peak = float(np.max(np.abs(x))) if x.size else 0.0
+        if peak > 0:
+            total_gain *= full_scale * 10 ** (normalize_peak_db / 20.0) / peak
+    if gain is not None:
+        total_gain *= gain
+    x *= total_gain
+    clipped = int(np.count_nonzero(np.abs(x) > full_scale))
+    if clipped:
+        print(f"警告: {clipped} 个样本饱和削波")
+    np.clip(np.rint(x), -full_scale - 1, full_scale, out=x)
+    return x.astype(np.int32 if bits == 32 else np.int16), total_gain
+
+
+def write_binary_asset(samples, out_dir=".", name="audio_data",
+                       sample_rate=SAMPLE_RATE, channels=CHANNELS, bits=BITS,
+                       prescaled=False, gain=1.0):
+    """
+    将样本数组写成 .bin + .S + .h 三个文件，返回 .bin 路径
+    prescaled 为 True 时头文件标记数据已烘焙增益，运行时应跳过增益处理
+    """
+    dtype = '<i4' if bits == 32 else '<i2'
+    data = np.ascontiguousarray(samples, dtype=dtype)
+    data_len = data.nbytes
+    duration_sec = data_len / (sample_rate * channels * bits // 8)
+    macro = name.upper()
+    ctype = 'int32_t' if bits == 32 else 'int16_t'
+
     print(f"音频数据大小: {data_len} 字节 ({data_len / 1024:.2f} KB)")
-    
-    # 估算播放时长
-    # 44100Hz * 2声道 * 4字节 = 352800字节/秒
-    duration_sec = data_len / (44100 * 2 * 4)
     print(f"预计播放时长: {duration_sec:.2f} 秒")
-    
-    # 生成C头文件
-    with open(header_file, 'w', encoding='utf-8') as f:
-        f.write('/**\n')
-        f.write(' * 自动生成的音频数据文件\n')
-        f.write(f' * 数据大小: {data_len} 字节\n')
-        f.write(f' * 播放时长: {duration_sec:.2f} 秒\n')
-        f.write(' * 采样率: 44100 Hz\n')
-        f.write(' * 位深度: 32 bit\n')
-        f.write(' * 声道数: 2 (立体声)\n')
-        f.write(' */\n\n')
-        f.write('#ifndef AUDIO_DATA_H\n')
-        f.write('#define AUDIO_DATA_H\n\n')
+
+    os.makedirs(out_dir, exist_ok=True)
+    bin_file = os.path.join(out_dir, f"{name}.bin")
+    asm_file = os.path.join(out_dir, f"{name}.S")
+    header_file = os.path.join(out_dir, f"{name}.h")
+
+    # 二进制数据：numpy整块写出
+    data.tofile(bin_file)
+
+    comment = (
+        '/**\n'
+        ' * 自动生成的音频数据文件\n'
+        f' * 数据大小: {data_len} 字节\n'
+        f' * 播放时长: {duration_sec:.2f} 秒\n'
+        f' * 采样率: {sample_rate} Hz\n'
+        f' * 位深度: {bits} bit\n'
+        f' * 声道数: {channels} ({"立体声" if channels == 2 else "单声道"})\n'
+        ' */\n\n'
+    )
+
+    # 汇编文件：4字节对齐后 .incbin 引入二进制数据
+    with open(asm_file, 'w', encoding='utf-8', newline='\n') as f:
+        f.write(comment)
+        f.write(f'    .section .rodata.{name}, "a"\n')
+        f.write('    .balign 4\n')
+        f.write(f'    .global {name}\n')
+        f.write(f'    .type {name}, @object\n')
+        f.write(f'{name}:\n')
+        f.write(f'    .incbin "{name}.bin"\n')
+        f.write(f'    .size {name}, . - {name}\n\n')
+        f.write('    .balign 4\n')
+        f.write(f'    .global {name}_len\n')
+        f.write(f'    .type {name}_len, @object\n')
+        f.write(f'{name}_len:\n')
+        f.write(f'    .long {data_len}\n')
+        f.write(f'    .size {name}_len, 4\n')
+
+    # 头文件：只有extern声明和格式宏，可重复包含
+    with open(header_file, 'w', encoding='utf-8', newline='\n') as f:
+        f.write(comment)
+        f.write(f'#ifndef {macro}_H\n')
+        f.write(f'#define {macro}_H\n\n')
         f.write('#include <stdint.h>\n\n')
-        
-        # 数据长度
-        f.write(f'const uint32_t {array_name}_len = {data_len};\n\n')
-        
-        # 音频数据数组
-        f.write(f'const int32_t {array_name}[] = {{\n')
-        
-        # 每行8个数据，便于阅读
-        values_per_line = 8
-        sample_count = data_len // 4
-        
-        for i in range(sample_count):
-            offset = i * 4
-            # 读取4字节作为int32
-            value = struct.unpack('<i', audio_data[offset:offset+4])[0]
-            
-            if i % values_per_line == 0:
-                f.write('    ')
-            
-            f.write(f'0x{value & 0xFFFFFFFF:08X}')
-            
-            if i < sample_count - 1:
-                f.write(', ')
-            
-            if (i + 1) % values_per_line == 0:
-                f.write('\n')
-        
-        f.write('\n};\n\n')
-        f.write('#endif // AUDIO_DATA_H\n')
-    
-    print(f"C头文件生成完成: {header_file}")
-    
-    # 输出使用示例
+        f.write(f'#define {macro}_SAMPLE_RATE   {sample_rate}\n')
+        f.write(f'#define {macro}_BITS          {bits}\n')
+        f.write(f'#define {macro}_CHANNELS      {channels}\n')
+        f.write(f'#define {macro}_PRESCALED     {1 if prescaled else 0}    //? 1=增益已烘焙，播放时跳过运行时增益\n')
+        f.write(f'#define {macro}_GAIN          {gain:.4f}f\n\n')
+        f.write('//? 数据由 ' + f'{name}.S 通过 .incbin 链接，4字节对齐\n')
+        f.write(f'extern const uint32_t {name}_len;\n')
+        f.write(f'extern const {ctype} {name}[];\n\n')
+        f.write(f'#endif // {macro}_H\n')
+
+    print(f"生成完成: {bin_file}, {asm_file}, {header_file}")
+    return bin_file
+
+
+def print_usage_hint(name):
+    macro = name.upper()
     print("\n" + "="*60)
     print("使用方法：")
     print("="*60)
-    print("1. 将生成的 audio_data.h 复制到ESP32项目的main目录")
-    print("2. 在代码中包含头文件:")
-    print('   #include "audio_data.h"')
-    print("\n3. 播放音频:")
+    print(f"1. 将 {name}.bin / {name}.S / {name}.h 复制到ESP32项目的main目录")
+    print(f'2. 在 main/CMakeLists.txt 的 SRCS 中加入 "{name}.S"')
+    print("3. 在代码中包含头文件，用片段描述携带格式和预缩放标志后播放")
+    print("   （不要把数据直接交给 i2s_channel_write()：单声道/16位/预缩放数据会绕过格式转换和增益处理）:")
     print(f'''
-   void play_audio_task(void *pvParameters)
-   {{
-       i2s_tx_init();
-       max98367a_set_gain(2.0f);
-       
-       size_t bytes_written;
-       esp_err_t ret = i2s_channel_write(tx_handle, 
-                                         (void*){array_name}, 
-                                         {array_name}_len, 
-                                         &bytes_written, 
-                                         portMAX_DELAY);
-       
-       if (ret == ESP_OK) {{
-           ESP_LOGI("AUDIO", "播放完成: %d 字节", bytes_written);
-       }}
-       
-       vTaskDelete(NULL);
-   }}
+   #include "{name}.h"
+
+   //? 调度器保存片段指针，描述须在整个运行期间有效
+   static max98367a_clip_t clip = {{
+       .data = {name},
+       .flags = {macro}_PRESCALED ? MAX98367A_CLIP_PRESCALED : 0,
+       .channels = {macro}_CHANNELS,
+       .bits = {macro}_BITS,
+       .sample_rate = {macro}_SAMPLE_RATE,
+   }};
+   clip.len = {name}_len;
+
+   //? 直接播放（阻塞到播完）；已使用 audio_player 时由调度器独占输出，二者选其一
+   max98367a_play_clip(&clip, portMAX_DELAY);
+
+   //? 或登记到播放调度器，按ID和优先级播放（与其他声音混音、抢占）
+   audio_player_register(ID, &(audio_player_sound_t){{ .clip = &clip }});
+   audio_player_play(ID, 1, AUDIO_PLAYER_ENQUEUE, NULL);
 ''')
     print("="*60)
 
+
 def main():
-    if len(sys.argv) < 2:
-        print("用法: python audio_to_c_array.py <音频文件> [输出头文件名] [数组名]")
-        print("\n示例:")
-        print("  python audio_to_c_array.py voice.mp3")
-        print("  python audio_to_c_array.py voice.mp3 my_audio.h")
-        print("  python audio_to_c_array.py voice.mp3 my_audio.h my_voice_data")
-        sys.exit(1)
-    
-    input_file = sys.argv[1]
-    header_file = sys.argv[2] if len(sys.argv) > 2 else "audio_data.h"
-    array_name = sys.argv[3] if len(sys.argv) > 3 else "audio_data"
-    
-    if not os.path.exists(input_file):
-        print(f"错误: 文件不存在: {input_file}")
+    parser = argparse.ArgumentParser(description="音频文件转ESP32二进制资源（.bin + .S + .h）")
+    parser.add_argument("input", help="输入音频文件")
+    parser.add_argument("-n", "--name", default="audio_data", help="符号名/文件名前缀（默认 audio_data）")
+    parser.add_argument("-o", "--out-dir", default=".", help="输出目录（默认当前目录）")
+    parser.add_argument("-y", "--yes", action="store_true", help="数据超过1MB时不再询问")
+    parser.add_argument("--rate", type=int, default=SAMPLE_RATE,
+                        help="采样率，0表示保持源文件原生采样率（播放时切换I2S时钟，免去重采样），默认44100")
+    parser.add_argument("--bits", type=int, default=BITS, choices=(16, 32),
+                        help="位深度，需与 MAX98367A_BIT_WIDTH 一致才能直接交给DMA（默认32）")
+    parser.add_argument("--gain", type=float, default=None, help="构建时烘焙的线性增益（如 2.0）")
+    parser.add_argument("--normalize-peak", type=float, default=None, metavar="DBFS",
+                        help="构建时把峰值归一化到指定dBFS（如 -1.0）")
+    parser.add_argument("--prescaled", action="store_true",
+                        help="即使未指定增益也标记为预缩放（按原始电平播放）")
+    args = parser.parse_args()
+
+    if not os.path.exists(args.input):
+        print(f"错误: 文件不存在: {args.input}")
         sys.exit(1)
-    
+
     # 检查文件大小
-    file_size = os.path.getsize(input_file)
+    file_size = os.path.getsize(args.input)
     print(f"输入文件大小: {file_size / 1024:.2f} KB")
-    
+
     # 临时RAW文件
-    temp_raw = "temp_audio.raw"
-    
+    temp_raw = os.path.join(args.out_dir, f"{args.name}.raw.tmp")
+    os.makedirs(args.out_dir, exist_ok=True)
+
+    sample_rate = args.rate
+    if sample_rate == 0:
+        sample_rate = probe_sample_rate(args.input)
+        if sample_rate is None:
+            print("错误: 无法识别源文件采样率，请用 --rate 指定")
+            sys.exit(1)
+        print(f"使用原生采样率: {sample_rate} Hz")
+
     try:
         # 步骤1: 转换音频格式
-        if not convert_audio_to_raw(input_file, temp_raw):
+        if not convert_audio_to_raw(args.input, temp_raw, sample_rate=sample_rate, bits=args.bits):
             sys.exit(1)
-        
+
         # 检查转换后的大小
         raw_size = os.path.getsize(temp_raw)
-        if raw_size > 1024 * 1024:  # 大于1MB
+        if raw_size > 1024 * 1024 and not args.yes:  # 大于1MB
             print(f"\n警告: 音频数据较大 ({raw_size / 1024:.2f} KB)")
             print("建议:")
             print("  1. 使用更短的音频片段")
@@ -176,19 +263,27 @@ def main():
             response = input("是否继续? (y/n): ")
             if response.lower() != 'y':
                 print("操作已取消")
-                os.remove(temp_raw)
                 sys.exit(0)
-        
-        # 步骤2: 转换为C数组
-        raw_to_c_array(temp_raw, header_file, array_name)
-        
+
+        # 步骤2: 生成二进制资源
+        samples = load_raw(temp_raw, args.bits)
+        total_gain = 1.0
+        if args.gain is not None or args.normalize_peak is not None:
+            samples, total_gain = bake_gain(samples, args.gain, args.normalize_peak, args.bits)
+            print(f"已烘焙增益: {total_gain:.4f}")
+        prescaled = args.prescaled or args.gain is not None or args.normalize_peak is not None
+        write_binary_asset(samples, args.out_dir, args.name, sample_rate=sample_rate, bits=args.bits,
+                           prescaled=prescaled, gain=total_gain)
+        print_usage_hint(args.name)
+
         print("\n✓ 转换成功!")
-        
+
     finally:
         # 清理临时文件
         if os.path.exists(temp_raw):
             os.remove(temp_raw)
             print(f"已清理临时文件: {temp_raw}")
 
+
 if __name__ == '__main__':
     main()
@@ -0,0 +1,199 @@
+/**
+ * ctrl_proto 主机测试与性能测试
+ * 检查命令拆分、标签、参数解析和JSON回复（含转义与缓冲区不足），并测量每条命令的解析耗时
+ *
+ * 编译运行（在仓库根目录）：
+ *   gcc -O2 -Icomponents/ctrl_proto tools/ctrl_proto_test.c components/ctrl_proto/ctrl_proto.c -o ctrl_proto_test
+ *   ./ctrl_proto_test
+ *
+ * 全部通过时返回0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ctrl_proto.h"
+
+static int s_failed = 0;
+
+static void check(int ok, const char *name)
+{
+    printf("  %-52s %s\n", name, ok ? "ok" : "FAIL");
+    s_failed |= !ok;
+}
+
+static int tok_is(const ctrl_token_t *t, const char *s)
+{
+    return ctrl_token_eq(t, s);
+}
+
+//? 多条命令、分隔符、空命令和标签
+static void test_split(void)
+{
+    const char msg[] = "  gain 2.5; #7 play 3 10 duck\n\n ;stats\r\nfoo bar;gate";
+    char copy[sizeof(msg)];
+    memcpy(copy, msg, sizeof(msg));
+
+    ctrl_parser_t ps;
+    ctrl_cmd_t c[8];
+    int n = 0;
+    printf("split:\n");
+    ctrl_parser_init(&ps, copy, strlen(copy));
+    while (n < 8 && ctrl_parser_next(&ps, &c[n])) {
+        n++;
+    }
+    check(n == 5, "5 commands, empty ones skipped");
+    check(c[0].verb == CTRL_VERB_GAIN && c[0].argc == 1 && tok_is(&c[0].argv[0], "2.5"), "gain 2.5");
+    check(c[1].verb == CTRL_VERB_PLAY && c[1].argc == 3 && tok_is(&c[1].tag, "7")
+          && tok_is(&c[1].argv[0], "3") && tok_is(&c[1].argv[2], "duck"), "#7 play 3 10 duck");
+    check(c[2].verb == CTRL_VERB_STATS && c[2].argc == 0, "stats with CRLF");
+    check(c[3].verb == CTRL_VERB_UNKNOWN && tok_is(&c[3].name, "foo") && c[3].argc == 1, "unknown verb keeps its name");
+    check(c[4].verb == CTRL_VERB_GATE && c[4].argc == 0, "last command without separator");
+    check(memcmp(copy, msg, sizeof(msg)) == 0, "receive buffer not modified");
+    check(c[0].argv[0].p >= copy && c[0].argv[0].p < copy + sizeof(copy), "tokens point into receive buffer");
+
+    ctrl_parser_init(&ps, "play 1 2 3 4 5", 14);
+    ctrl_parser_next(&ps, &c[0]);
+    check(c[0].too_many && c[0].argc == CTRL_PROTO_MAX_ARGS, "too many arguments flagged");
+
+    ctrl_parser_init(&ps, "config wss_uri ws://10.0.0.2:8080/ws", 37);
+    ctrl_parser_next(&ps, &c[0]);
+    check(c[0].verb == CTRL_VERB_CONFIG && c[0].argc == 2 && tok_is(&c[0].argv[1], "ws://10.0.0.2:8080/ws"),
+          "config key value");
+
+    //? 长度之外的内容不解析
+    ctrl_parser_init(&ps, "stop;gain 1", 4);
+    n = 0;
+    while (ctrl_parser_next(&ps, &c[0])) {
+        n++;
+    }
+    check(n == 1 && c[0].verb == CTRL_VERB_STOP, "stops at length");
+}
+
+static void test_numbers(void)
+{
+    static const struct { const char *s; int ok; int32_t v; } ints[] = {
+        {"0", 1, 0}, {"-42", 1, -42}, {"+7", 1, 7}, {"2147483647", 1, 2147483647},
+        {"-2147483648", 1, INT32_MIN}, {"2147483648", 0, 0}, {"12a", 0, 0}, {"-", 0, 0}, {"", 0, 0},
+    };
+    static const struct { const char *s; int ok; float v; } floats[] = {
+        {"2.5", 1, 2.5f}, {"-0.125", 1, -0.125f}, {"3", 1, 3.0f}, {".5", 1, 0.5f}, {"5.", 1, 5.0f},
+        {"1.2.3", 0, 0}, {".", 0, 0}, {"1e3", 0, 0},
+    };
+    int ok = 1;
+    printf("numbers:\n");
+    for (size_t i = 0; i < sizeof(ints) / sizeof(ints[0]); i++) {
+        ctrl_token_t t = {ints[i].s, strlen(ints[i].s)};
+        int32_t v = 0;
+        int r = ctrl_token_int(&t, &v);
+        ok &= (r == ints[i].ok) && (!r || v == ints[i].v);
+    }
+    check(ok, "integers incl. range limits and garbage");
+    ok = 1;
+    for (size_t i = 0; i < sizeof(floats) / sizeof(floats[0]); i++) {
+        ctrl_token_t t = {floats[i].s, strlen(floats[i].s)};
+        float v = 0;
+        int r = ctrl_token_float(&t, &v);
+        ok &= (r == floats[i].ok) && (!r || v == floats[i].v);
+    }
+    check(ok, "decimals without exponent");
+
+    static const char *const modes[] = {"enqueue", "preempt", "duck"};
+    ctrl_token_t t = {"duck", 4}, u = {"du", 2};
+    check(ctrl_token_enum(&t, modes, 3) == 2 && ctrl_token_enum(&u, modes, 3) == -1, "enum lookup needs exact match");
+}
+
+static void test_reply(void)
+{
+    char buf[256];
+    ctrl_parser_t ps;
+    ctrl_cmd_t c;
+    ctrl_reply_t r;
+    printf("reply:\n");
+
+    ctrl_parser_init(&ps, "#a1 gain 2.5", 12);
+    ctrl_parser_next(&ps, &c);
+    ctrl_reply_begin(&r, buf, sizeof(buf), &c, NULL);
+    ctrl_reply_float(&r, "gain", 2.5f);
+    size_t n = ctrl_reply_end(&r);
+    check(n == strlen(buf) && strcmp(buf, "{\"cmd\":\"gain\",\"id\":\"a1\",\"ok\":true,\"gain\":2.5}") == 0, buf);
+
+    ctrl_parser_init(&ps, "x\"y\\ 1", 6);
+    ctrl_parser_next(&ps, &c);
+    ctrl_reply_begin(&r, buf, sizeof(buf), &c, "unknown command");
+    ctrl_reply_end(&r);
+    check(strcmp(buf, "{\"cmd\":\"x\\\"y\\\\\",\"ok\":false,\"error\":\"unknown command\"}") == 0, buf);
+
+    ctrl_parser_init(&ps, "stats", 5);
+    ctrl_parser_next(&ps, &c);
+    ctrl_reply_begin(&r, buf, sizeof(buf), &c, NULL);
+    ctrl_reply_int(&r, "underruns", 3);
+    ctrl_reply_int(&r, "big", -5000000000LL);
+    ctrl_reply_str(&r, "codec", "s16");
+    ctrl_reply_end(&r);
+    check(strcmp(buf, "{\"cmd\":\"stats\",\"ok\":true,\"underruns\":3,\"big\":-5000000000,\"codec\":\"s16\"}") == 0, buf);
+
+    //? 缓冲区不足：改写为错误回复，且始终以0结尾
+    char small[64];
+    ctrl_reply_begin(&r, small, sizeof(small), &c, NULL);
+    for (int i = 0; i < 10; i++) {
+        ctrl_reply_int(&r, "counter", i);
+    }
+    n = ctrl_reply_end(&r);
+    check(n == strlen(small) && strcmp(small, "{\"cmd\":\"stats\",\"ok\":false,\"error\":\"reply too long\"}") == 0, small);
+    char tiny[8];
+    ctrl_reply_begin(&r, tiny, sizeof(tiny), &c, NULL);
+    n = ctrl_reply_end(&r);
+    check(n == 0 && tiny[0] == '\0', "buffer too small even for the error: empty reply");
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void bench(void)
+{
+    const char msg[] = "#1 gain 2.5;#2 gate 800;#3 play 3 10 duck;#4 rate 16000;#5 codec s16;#6 stats";
+    const int rounds = 200000;
+    volatile int sink = 0;
+    char buf[256];
+
+    double t0 = now_ns();
+    for (int i = 0; i < rounds; i++) {
+        ctrl_parser_t ps;
+        ctrl_cmd_t c;
+        ctrl_parser_init(&ps, msg, sizeof(msg) - 1);
+        while (ctrl_parser_next(&ps, &c)) {
+            float f;
+            sink += c.verb + (c.argc && ctrl_token_float(&c.argv[0], &f));
+        }
+    }
+    double parse = (now_ns() - t0) / rounds / 6;
+
+    ctrl_cmd_t c = {.verb = CTRL_VERB_STATS, .name = {"stats", 5}};
+    t0 = now_ns();
+    for (int i = 0; i < rounds; i++) {
+        ctrl_reply_t r;
+        ctrl_reply_begin(&r, buf, sizeof(buf), &c, NULL);
+        ctrl_reply_float(&r, "gain", 2.5f);
+        ctrl_reply_int(&r, "underruns", i);
+        ctrl_reply_int(&r, "latency_max_us", 41000);
+        sink += (int)ctrl_reply_end(&r);
+    }
+    double reply = (now_ns() - t0) / rounds;
+    printf("benchmark: parse %.1f ns/command, stats reply (3 fields) %.1f ns\n", parse, reply);
+}
+
+int main(void)
+{
+    test_split();
+    test_numbers();
+    test_reply();
+    bench();
+    printf("%s\n", s_failed ? "FAILED" : "all passed");
+    return s_failed;
+}
@@ -0,0 +1,58 @@
+//? 主机测试用替身：不阻塞的环形队列（超时参数被忽略）
+#pragma once
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+
+typedef struct {
+    size_t item_size;
+    size_t length;
+    size_t head;
+    size_t count;
+    uint8_t data[];
+} host_queue_t;
+
+typedef host_queue_t *QueueHandle_t;
+
+static inline QueueHandle_t xQueueCreate(size_t length, size_t item_size)
+{
+    QueueHandle_t q = calloc(1, sizeof(host_queue_t) + length * item_size);
+    if (q != NULL) {
+        q->item_size = item_size;
+        q->length = length;
+    }
+    return q;
+}
+
+static inline void vQueueDelete(QueueHandle_t q)
+{
+    free(q);
+}
+
+static inline BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t timeout)
+{
+    (void)timeout;
+    if (q->count == q->length) {
+        return pdFALSE;
+    }
+    memcpy(q->data + ((q->head + q->count) % q->length) * q->item_size, item, q->item_size);
+    q->count++;
+    return pdTRUE;
+}
+
+static inline BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t timeout)
+{
+    (void)timeout;
+    if (q->count == 0) {
+        return pdFALSE;
+    }
+    memcpy(item, q->data + q->head * q->item_size, q->item_size);
+    q->head = (q->head + 1) % q->length;
+    q->count--;
+    return pdTRUE;
+}
+
+static inline UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q)
+{
+    return q->count;
+}
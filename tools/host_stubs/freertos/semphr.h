@@ -0,0 +1,28 @@
+//? 主机测试用替身：单线程测试，互斥锁只做计数
+#pragma once
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+
+typedef struct {
+    int taken;
+} host_mutex_t;
+
+typedef host_mutex_t *SemaphoreHandle_t;
+
+static inline SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return calloc(1, sizeof(host_mutex_t));
+}
+
+static inline BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t timeout)
+{
+    (void)timeout;
+    sem->taken++;
+    return pdTRUE;
+}
+
+static inline BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    sem->taken--;
+    return pdTRUE;
+}
@@ -0,0 +1,13 @@
+//? 主机测试用替身：不创建任务，测试直接调用组件的内部函数
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void *arg);
+typedef void *TaskHandle_t;
+
+static inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack, void *arg,
+                                                 UBaseType_t priority, TaskHandle_t *handle, BaseType_t core)
+{
+    (void)fn; (void)name; (void)stack; (void)arg; (void)priority; (void)handle; (void)core;
+    return pdPASS;
+}
@@ -0,0 +1,73 @@
+//? 主机测试用替身：命名空间不存在（加载时全部使用默认值），写入成功但不保存
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "nvs_flash.h"
+
+typedef uint32_t nvs_handle_t;
+
+typedef enum {
+    NVS_READONLY,
+    NVS_READWRITE,
+} nvs_open_mode_t;
+
+static inline esp_err_t nvs_open(const char *name, nvs_open_mode_t mode, nvs_handle_t *handle)
+{
+    (void)name;
+    *handle = 1;
+    return mode == NVS_READONLY ? ESP_ERR_NVS_NOT_FOUND : ESP_OK;
+}
+
+static inline void nvs_close(nvs_handle_t handle)
+{
+    (void)handle;
+}
+
+static inline esp_err_t nvs_get_i32(nvs_handle_t h, const char *key, int32_t *v)
+{
+    (void)h; (void)key; (void)v;
+    return ESP_ERR_NVS_NOT_FOUND;
+}
+
+static inline esp_err_t nvs_get_u32(nvs_handle_t h, const char *key, uint32_t *v)
+{
+    (void)h; (void)key; (void)v;
+    return ESP_ERR_NVS_NOT_FOUND;
+}
+
+static inline esp_err_t nvs_get_str(nvs_handle_t h, const char *key, char *v, size_t *len)
+{
+    (void)h; (void)key; (void)v; (void)len;
+    return ESP_ERR_NVS_NOT_FOUND;
+}
+
+static inline esp_err_t nvs_set_i32(nvs_handle_t h, const char *key, int32_t v)
+{
+    (void)h; (void)key; (void)v;
+    return ESP_OK;
+}
+
+static inline esp_err_t nvs_set_u32(nvs_handle_t h, const char *key, uint32_t v)
+{
+    (void)h; (void)key; (void)v;
+    return ESP_OK;
+}
+
+static inline esp_err_t nvs_set_str(nvs_handle_t h, const char *key, const char *v)
+{
+    (void)h; (void)key; (void)v;
+    return ESP_OK;
+}
+
+static inline esp_err_t nvs_commit(nvs_handle_t h)
+{
+    (void)h;
+    return ESP_OK;
+}
+
+static inline esp_err_t nvs_erase_all(nvs_handle_t h)
+{
+    (void)h;
+    return ESP_OK;
+}
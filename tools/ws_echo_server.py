@@ -0,0 +1,207 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+本地WebSocket回显服务器（仅依赖Python标准库）
+用于测试 wss_client 组件，并统计音频帧到达间隔，观察TCP参数对延迟的影响
+
+使用方法：
+1. 运行: python ws_echo_server.py [--port 8080] [--no-nodelay]
+2. 将 WSS_URI 设置为 ws://<电脑IP>:8080/websocket/1 后烧录设备
+3. 每收到 --report 个二进制帧打印一次统计：
+   - 帧间隔 p50/p95/p99/max（毫秒）：Nagle开启时帧会成批到达，p99/max明显变大
+   - 吞吐量（KB/s）
+
+对比方法：
+  设备端分别以 WSS_TCP_NODELAY=0 和 WSS_TCP_NODELAY=1 编译，
+  服务器端可用 --no-nodelay 关闭回程方向的TCP_NODELAY，对比两组统计结果
+"""
+
+import argparse
+import base64
+import hashlib
+import socket
+import struct
+import threading
+import time
+
+WS_MAGIC = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+
+def recv_exact(conn, n):
+    """
+    从socket精确读取n字节，连接关闭返回None
+    """
+    buf = bytearray()
+    while len(buf) < n:
+        chunk = conn.recv(n - len(buf))
+        if not chunk:
+            return None
+        buf.extend(chunk)
+    return bytes(buf)
+
+
+def do_handshake(conn):
+    """
+    处理HTTP Upgrade握手，返回请求路径
+    """
+    request = b""
+    while b"\r\n\r\n" not in request:
+        chunk = conn.recv(1024)
+        if not chunk:
+            return None
+        request += chunk
+
+    lines = request.decode("latin-1").split("\r\n")
+    path = lines[0].split(" ")[1] if " " in lines[0] else "/"
+    key = ""
+    for line in lines[1:]:
+        if line.lower().startswith("sec-websocket-key:"):
+            key = line.split(":", 1)[1].strip()
+
+    accept = base64.b64encode(hashlib.sha1((key + WS_MAGIC).encode()).digest()).decode()
+    conn.sendall((
+        "HTTP/1.1 101 Switching Protocols\r\n"
+        "Upgrade: websocket\r\n"
+        "Connection: Upgrade\r\n"
+        f"Sec-WebSocket-Accept: {accept}\r\n"
+        "\r\n").encode())
+    return path
+
+
+def read_frame(conn):
+    """
+    读取一个WebSocket帧，返回 (opcode, payload)
+    对端在帧中途断开时返回 (None, None)，与帧之间断开一样按连接关闭处理
+    """
+    hdr = recv_exact(conn, 2)
+    if hdr is None:
+        return None, None
+    opcode = hdr[0] & 0x0F
+    masked = hdr[1] & 0x80
+    length = hdr[1] & 0x7F
+    if length in (126, 127):
+        ext = recv_exact(conn, 2 if length == 126 else 8)
+        if ext is None:
+            return None, None
+        length = struct.unpack(">H" if length == 126 else ">Q", ext)[0]
+    mask = None
+    if masked:
+        mask = recv_exact(conn, 4)
+        if mask is None:
+            return None, None
+    payload = recv_exact(conn, length) if length else b""
+    if payload is None:
+        return None, None
+    if mask:
+        # 按32位整数整体异或，比逐字节快得多
+        pad = (-length) % 4
+        words = len(payload) // 4 + (1 if pad else 0)
+        key = int.from_bytes(mask * words, "little")
+        data = int.from_bytes(payload + b"\0" * pad, "little") ^ key
+        payload = data.to_bytes(words * 4, "little")[:length]
+    return opcode, payload
+
+
+def build_frame(opcode, payload):
+    """
+    组包服务器端WebSocket帧（服务器发出的帧不加掩码）
+    """
+    length = len(payload)
+    if length <= 125:
+        header = struct.pack("BB", 0x80 | opcode, length)
+    elif length <= 65535:
+        header = struct.pack(">BBH", 0x80 | opcode, 126, length)
+    else:
+        header = struct.pack(">BBQ", 0x80 | opcode, 127, length)
+    return header + payload
+
+
+def percentile(sorted_values, p):
+    if not sorted_values:
+        return 0.0
+    idx = min(len(sorted_values) - 1, int(round(p / 100.0 * (len(sorted_values) - 1))))
+    return sorted_values[idx]
+
+
+def handle_client(conn, addr, args):
+    conn.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 0 if args.no_nodelay else 1)
+    path = do_handshake(conn)
+    if path is None:
+        conn.close()
+        return
+    print(f"[{addr[0]}:{addr[1]}] 已连接, path={path}")
+
+    gaps = []
+    total_bytes = 0
+    last_arrival = None
+    window_start = time.perf_counter()
+
+    try:
+        while True:
+            opcode, payload = read_frame(conn)
+            if opcode is None:
+                break
+            now = time.perf_counter()
+
+            if opcode == 0x8:
+                conn.sendall(build_frame(0x8, payload))
+                break
+            if opcode == 0x9:
+                conn.sendall(build_frame(0xA, payload))
+                continue
+            if opcode == 0x1:
+                print(f"[{addr[0]}] text: {payload.decode('utf-8', 'replace')}")
+
+            if not args.silent:
+                conn.sendall(build_frame(opcode, payload))
+
+            if opcode == 0x2:
+                if last_arrival is not None:
+                    gaps.append((now - last_arrival) * 1000.0)
+                last_arrival = now
+                total_bytes += len(payload)
+
+                if len(gaps) >= args.report:
+                    elapsed = now - window_start
+                    gaps.sort()
+                    print(f"[{addr[0]}] {len(gaps) + 1} frames, "
+                          f"gap p50={percentile(gaps, 50):.2f} p95={percentile(gaps, 95):.2f} "
+                          f"p99={percentile(gaps, 99):.2f} max={gaps[-1]:.2f} ms, "
+                          f"{total_bytes / 1024 / elapsed:.1f} KB/s")
+                    gaps = []
+                    total_bytes = 0
+                    window_start = now
+    except (ConnectionError, OSError) as e:
+        print(f"[{addr[0]}] 连接异常: {e}")
+    finally:
+        conn.close()
+        print(f"[{addr[0]}:{addr[1]}] 已断开")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="WebSocket回显服务器（音频延迟测试）")
+    parser.add_argument("--host", default="0.0.0.0")
+    parser.add_argument("--port", type=int, default=8080)
+    parser.add_argument("--report", type=int, default=200, help="每N个二进制帧打印一次统计")
+    parser.add_argument("--no-nodelay", action="store_true", help="服务器端不设置TCP_NODELAY")
+    parser.add_argument("--silent", action="store_true", help="只统计不回显")
+    args = parser.parse_args()
+
+    srv = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    srv.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    srv.bind((args.host, args.port))
+    srv.listen(4)
+    print(f"WebSocket回显服务器已启动: ws://{args.host}:{args.port}/")
+
+    try:
+        while True:
+            conn, addr = srv.accept()
+            threading.Thread(target=handle_client, args=(conn, addr, args), daemon=True).start()
+    except KeyboardInterrupt:
+        print("\n服务器已停止")
+    finally:
+        srv.close()
+
+
+if __name__ == '__main__':
+    main()